@@ -255,6 +255,7 @@
 #include "dialogs/GUIDialogSmartPlaylistEditor.h"
 #include "dialogs/GUIDialogSmartPlaylistRule.h"
 #include "pictures/GUIDialogPictureInfo.h"
+#include "pictures/PictureScaler.h"
 #include "addons/GUIDialogAddonSettings.h"
 #include "addons/GUIDialogAddonInfo.h"
 #ifdef HAS_LINUX_NETWORK
@@ -2018,6 +2019,7 @@ void CApplication::UnloadSkin(bool forReload /* = false */)
 
   g_TextureManager.Cleanup();
   g_largeTextureManager.CleanupUnusedImages(true);
+  CPictureScaler::FreeScalers();
 
   g_fontManager.Clear();
 
@@ -3681,6 +3683,9 @@ void CApplication::Stop(int exitCode)
   // so we may never get to Destroy() in CXBApplicationEx::Run(), we call it here.
   Destroy();
 
+  // write out anything still queued by the log writer
+  CLog::SetAsync(false);
+
   //
   Sleep(200);
 }
@@ -4205,6 +4210,8 @@ void CApplication::OnPlayBackEnded()
 
   if (CJobManager::GetInstance().IsPaused(kJobTypeMediaFlags))
     CJobManager::GetInstance().UnPause(kJobTypeMediaFlags);
+  if (CJobManager::GetInstance().IsPaused(kJobTypeCacheArtwork))
+    CJobManager::GetInstance().UnPause(kJobTypeCacheArtwork);
 
   // informs python script currently running playback has ended
   // (does nothing if python is not loaded)
@@ -4239,6 +4246,8 @@ void CApplication::OnPlayBackStarted()
 
   if (!CJobManager::GetInstance().IsPaused(kJobTypeMediaFlags))
     CJobManager::GetInstance().Pause(kJobTypeMediaFlags);
+  if (!CJobManager::GetInstance().IsPaused(kJobTypeCacheArtwork))
+    CJobManager::GetInstance().Pause(kJobTypeCacheArtwork);
 
 #ifdef HAS_PYTHON
   // informs python script currently running playback has started
@@ -4287,6 +4296,8 @@ void CApplication::OnPlayBackStopped()
 
   if (CJobManager::GetInstance().IsPaused(kJobTypeMediaFlags))
     CJobManager::GetInstance().UnPause(kJobTypeMediaFlags);
+  if (CJobManager::GetInstance().IsPaused(kJobTypeCacheArtwork))
+    CJobManager::GetInstance().UnPause(kJobTypeCacheArtwork);
 
   // informs python script currently running playback has ended
   // (does nothing if python is not loaded)
@@ -29,13 +29,17 @@
 #include "guilib/GraphicContext.h"
 #include "utils/log.h"
 #include "TextureCache.h"
+#include "utils/URIUtils.h"
+#include "settings/AdvancedSettings.h"
 
 using namespace std;
 
 
-CImageLoader::CImageLoader(const CStdString &path)
+CImageLoader::CImageLoader(const CStdString &path, unsigned int width, unsigned int height)
 {
   m_path = path;
+  m_width = width;
+  m_height = height;
   m_texture = NULL;
 }
 
@@ -49,7 +53,7 @@ bool CImageLoader::DoWork()
   bool needsChecking = false;
 
   CStdString texturePath = g_TextureManager.GetTexturePath(m_path);
-  CStdString loadPath = CTextureCache::Get().CheckCachedImage(texturePath, true, needsChecking); 
+  CStdString loadPath = CTextureCache::Get().CheckCachedImage(texturePath, true, needsChecking, m_width, m_height);
 
   if (loadPath.IsEmpty())
   {
@@ -62,7 +66,16 @@ bool CImageLoader::DoWork()
   {
     // direct route - load the image
     unsigned int start = XbmcThreads::SystemClockMillis();
-    m_texture = CBaseTexture::LoadFromFile(loadPath, g_graphicsContext.GetWidth(), g_graphicsContext.GetHeight(), g_guiSettings.GetBool("pictures.useexifrotation"));
+    // jpegs are decoded at the smallest scale still covering the control, other images are only
+    // resampled to fit within the given size after decoding so get the screen size to fit within
+    unsigned int width = g_graphicsContext.GetWidth();
+    unsigned int height = g_graphicsContext.GetHeight();
+    if (m_width && m_height && URIUtils::GetExtension(loadPath).Equals(".jpg"))
+    {
+      width = std::min(width, m_width);
+      height = std::min(height, m_height);
+    }
+    m_texture = CBaseTexture::LoadFromFile(loadPath, width, height, g_guiSettings.GetBool("pictures.useexifrotation"));
     if (!m_texture)
       return false;
     if (XbmcThreads::SystemClockMillis() - start > 100)
@@ -74,11 +87,14 @@ bool CImageLoader::DoWork()
   return true;
 }
 
-CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path)
+CGUILargeTextureManager::CLargeTexture::CLargeTexture(const CStdString &path, unsigned int width, unsigned int height)
 {
   m_path = path;
+  m_width = width;
+  m_height = height;
   m_refCount = 1;
   m_timeToDelete = 0;
+  m_lastRequested = 0;
 }
 
 CGUILargeTextureManager::CLargeTexture::~CLargeTexture()
@@ -124,8 +140,29 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
 }
 
+unsigned int CGUILargeTextureManager::CLargeTexture::GetUploadSize() const
+{
+  if (!m_texture.size() || !m_texture.m_textures[0]->GetPixels())
+    return 0;
+  return m_texture.m_textures[0]->GetPitch() * m_texture.m_textures[0]->GetRows();
+}
+
+unsigned int CGUILargeTextureManager::CLargeTexture::Upload()
+{
+  unsigned int bytes = GetUploadSize();
+  if (bytes)
+    m_texture.m_textures[0]->LoadToGPU();
+  return bytes;
+}
+
 CGUILargeTextureManager::CGUILargeTextureManager()
 {
+  m_uploadCount = 0;
+  m_uploadBytes = 0;
+  m_uploadMaxFrameTime = 0;
+  m_uploadDeferredFrames = 0;
+  m_uploading = NULL;
+  m_uploadingReleased = false;
 }
 
 CGUILargeTextureManager::~CGUILargeTextureManager()
@@ -145,17 +182,27 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
     else
       ++it;
   }
+  // and the same for loaded images still waiting for their upload
+  it = m_uploads.begin();
+  while (it != m_uploads.end())
+  {
+    CLargeTexture *image = *it;
+    if (image->DeleteIfRequired(immediately))
+      it = m_uploads.erase(it);
+    else
+      ++it;
+  }
 }
 
 // if available, increment reference count, and return the image.
 // else, add to the queue list if appropriate.
-bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest)
+bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest, unsigned int width, unsigned int height)
 {
   CSingleLock lock(m_listSection);
   for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
   {
     CLargeTexture *image = *it;
-    if (image->GetPath() == path)
+    if (image->Matches(path, width, height))
     {
       if (firstRequest)
         image->AddRef();
@@ -164,30 +211,68 @@ bool CGUILargeTextureManager::GetImage(const CStdString &path, CTextureArray &te
     }
   }
 
+  for (listIterator it = m_uploads.begin(); it != m_uploads.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->Matches(path, width, height))
+    { // loaded, but not yet on the GPU - a control asking for it is visible, so upload it first
+      if (firstRequest)
+        image->AddRef();
+      image->SetRequested(CTimeUtils::GetFrameTime());
+      return true;
+    }
+  }
+
+  if (m_uploading && m_uploading->Matches(path, width, height))
+  { // being uploaded right now
+    if (firstRequest)
+      m_uploading->AddRef();
+    return true;
+  }
+
   if (firstRequest)
-    QueueImage(path);
+    QueueImage(path, width, height);
 
   return true;
 }
 
-void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediately)
+void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediately, unsigned int width, unsigned int height)
 {
   CSingleLock lock(m_listSection);
   for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
   {
     CLargeTexture *image = *it;
-    if (image->GetPath() == path)
+    if (image->Matches(path, width, height))
     {
       if (image->DecrRef(immediately) && immediately)
         m_allocated.erase(it);
       return;
     }
   }
+  for (listIterator it = m_uploads.begin(); it != m_uploads.end(); ++it)
+  {
+    CLargeTexture *image = *it;
+    if (image->Matches(path, width, height))
+    {
+      // never uploaded, but it may well be asked for again shortly, so it gets the
+      // same grace period as the allocated images.  It stays on the upload list, so
+      // that if it is asked for again it is uploaded within the frame budget
+      if (image->DecrRef(immediately) && immediately)
+        m_uploads.erase(it);
+      return;
+    }
+  }
+  if (m_uploading && m_uploading->Matches(path, width, height))
+  { // UploadImages() is using it, so it is freed once the upload is done
+    if (m_uploading->DecrRef(false) && immediately)
+      m_uploadingReleased = true;
+    return;
+  }
   for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
   {
     unsigned int id = it->first;
     CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
+    if (image->Matches(path, width, height) && image->DecrRef(true))
     {
       // cancel this job
       CJobManager::GetInstance().CancelJob(id);
@@ -198,13 +283,13 @@ void CGUILargeTextureManager::ReleaseImage(const CStdString &path, bool immediat
 }
 
 // queue the image, and start the background loader if necessary
-void CGUILargeTextureManager::QueueImage(const CStdString &path)
+void CGUILargeTextureManager::QueueImage(const CStdString &path, unsigned int width, unsigned int height)
 {
   CSingleLock lock(m_listSection);
   for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
   {
     CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
+    if (image->Matches(path, width, height))
     {
       image->AddRef();
       return; // already queued
@@ -212,8 +297,8 @@ void CGUILargeTextureManager::QueueImage(const CStdString &path)
   }
 
   // queue the item
-  CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path), this, CJob::PRIORITY_NORMAL);
+  CLargeTexture *image = new CLargeTexture(path, width, height);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, width, height), this, CJob::PRIORITY_NORMAL);
   m_queued.push_back(make_pair(jobID, image));
 }
 
@@ -230,11 +315,85 @@ void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJ
       image->SetTexture(loader->m_texture);
       loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
       m_queued.erase(it);
-      m_allocated.push_back(image);
+      // the upload to the GPU is left to the render thread
+      image->SetRequested(CTimeUtils::GetFrameTime());
+      m_uploads.push_back(image);
       return;
     }
   }
 }
 
+void CGUILargeTextureManager::UploadImages()
+{
+  CSingleLock lock(m_listSection);
+  if (m_uploads.empty())
+    return;
+
+  unsigned int maxBytes = g_advancedSettings.m_guiTextureUploadBytes;
+  unsigned int maxTime = g_advancedSettings.m_guiTextureUploadTime;
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  unsigned int bytes = 0;
+  unsigned int uploaded = 0;
+  bool deferred = false;
+  while (true)
+  {
+    // most recently requested first, oldest load among those.  Released images are
+    // kept until they expire in case they are asked for again, but not uploaded
+    listIterator next = m_uploads.end();
+    for (listIterator it = m_uploads.begin(); it != m_uploads.end(); ++it)
+    {
+      if (!(*it)->IsReferenced())
+        continue;
+      if (next == m_uploads.end() || (*it)->GetLastRequested() > (*next)->GetLastRequested())
+        next = it;
+    }
+    if (next == m_uploads.end())
+      break;
+
+    CLargeTexture *image = *next;
+    unsigned int size = image->GetUploadSize();
+    if (uploaded && (bytes + size > maxBytes || XbmcThreads::SystemClockMillis() - start >= maxTime))
+    {
+      deferred = true;
+      break;
+    }
+
+    // upload without holding the lock, so loader jobs completing meanwhile aren't held up
+    m_uploads.erase(next);
+    m_uploading = image;
+    m_uploadingReleased = false;
+    lock.Leave();
+
+    unsigned int uploadStart = XbmcThreads::SystemClockMillis();
+    bytes += image->Upload();
+    unsigned int uploadTime = XbmcThreads::SystemClockMillis() - uploadStart;
+    if (uploadTime > maxTime)
+      CLog::Log(LOGDEBUG, "%s - took %u ms to upload %u bytes of %s", __FUNCTION__, uploadTime, size, image->GetPath().c_str());
+
+    lock.Enter();
+    m_uploading = NULL;
+    if (!m_uploadingReleased || !image->DeleteIfRequired(true))
+      m_allocated.push_back(image);
+    m_uploadCount++;
+    uploaded++;
+  }
+
+  unsigned int frameTime = XbmcThreads::SystemClockMillis() - start;
+  m_uploadBytes += bytes;
+  m_uploadMaxFrameTime = std::max(m_uploadMaxFrameTime, frameTime);
+  if (deferred)
+    m_uploadDeferredFrames++;
+}
+
+void CGUILargeTextureManager::GetUploadStats(unsigned int &uploads, uint64_t &bytes, unsigned int &maxFrameTime, unsigned int &deferredFrames, unsigned int &pending)
+{
+  CSingleLock lock(m_listSection);
+  uploads = m_uploadCount;
+  bytes = m_uploadBytes;
+  maxFrameTime = m_uploadMaxFrameTime;
+  deferredFrames = m_uploadDeferredFrames;
+  pending = m_uploads.size();
+}
+
 
 
@@ -36,7 +36,7 @@
 class CImageLoader : public CJob
 {
 public:
-  CImageLoader(const CStdString &path);
+  CImageLoader(const CStdString &path, unsigned int width = 0, unsigned int height = 0);
   virtual ~CImageLoader();
 
   /*!
@@ -45,6 +45,8 @@ public:
   virtual bool DoWork();
 
   CStdString    m_path; ///< path of image to load
+  unsigned int  m_width;  ///< width the image is displayed at, 0 for the full size image
+  unsigned int  m_height; ///< height the image is displayed at, 0 for the full size image
   CBaseTexture *m_texture; ///< Texture object to load the image into \sa CBaseTexture.
 };
 
@@ -55,6 +57,9 @@ public:
  Used to load textures for the user interface asynchronously, allowing fluid framerates
  while background loading textures.
 
+ Loaded textures are uploaded to the GPU from the render thread by UploadImages(), which
+ limits the amount of data and time spent uploading per frame.
+
  \sa IJobCallback, CGUITexture
  */
 class CGUILargeTextureManager : public IJobCallback
@@ -79,14 +84,19 @@ public:
    object filled if the texture has been previously loaded, else will return with an empty texture
    object if it is being loaded.
 
+   Images requested with a size are loaded from the smallest cached copy that covers that size, and
+   are kept separately from the same image requested at other sizes.
+
    \param path path of the image to load.
    \param texture texture object to hold the resulting texture
    \param orientation orientation of resulting texture
    \param firstRequest true if this is the first time we are requesting this texture
+   \param width width in pixels the image is displayed at, 0 for the full size image.
+   \param height height in pixels the image is displayed at, 0 for the full size image.
    \return true if the image exists, else false.
    \sa CGUITextureArray and CGUITexture
    */
-  bool GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest);
+  bool GetImage(const CStdString &path, CTextureArray &texture, bool firstRequest, unsigned int width = 0, unsigned int height = 0);
 
   /*!
    \brief Request a texture to be unloaded.
@@ -98,8 +108,10 @@ public:
    \param path path of the image to release.
    \param immediately if set true the image is immediately unloaded once its reference count reaches zero
                       rather than being unloaded after a delay.
+   \param width width the image was requested at.
+   \param height height the image was requested at.
    */
-  void ReleaseImage(const CStdString &path, bool immediately = false);
+  void ReleaseImage(const CStdString &path, bool immediately = false, unsigned int width = 0, unsigned int height = 0);
 
   /*!
    \brief Cleanup images that are no longer in use.
@@ -112,38 +124,86 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Upload loaded images to the GPU within the per frame budget.
+
+   Must be called from the render thread once per frame, before the controls are processed.
+   Images most recently requested by visible controls are uploaded first, released images waiting
+   to expire are not uploaded.  At least one image is uploaded per call, after that uploads stop
+   once the byte or time budget of the frame (advancedsettings gui/textureuploadbytes and
+   gui/textureuploadtime) is used up.
+   */
+  void UploadImages();
+
+  /*!
+   \brief Retrieve statistics of the GPU uploads
+   \param uploads [out] number of images uploaded
+   \param bytes [out] number of bytes uploaded
+   \param maxFrameTime [out] longest time in ms spent uploading in a single frame
+   \param deferredFrames [out] number of frames that left images queued due to the budget
+   \param pending [out] number of images currently waiting for upload
+   */
+  void GetUploadStats(unsigned int &uploads, uint64_t &bytes, unsigned int &maxFrameTime, unsigned int &deferredFrames, unsigned int &pending);
+
 private:
   class CLargeTexture
   {
   public:
-    CLargeTexture(const CStdString &path);
+    CLargeTexture(const CStdString &path, unsigned int width, unsigned int height);
     virtual ~CLargeTexture();
 
     void AddRef();
     bool DecrRef(bool deleteImmediately);
     bool DeleteIfRequired(bool deleteImmediately = false);
+    bool IsReferenced() const { return m_refCount > 0; };
     void SetTexture(CBaseTexture* texture);
 
+    /*! \brief Upload the texture to the GPU, must be called from the render thread
+     \return the number of bytes uploaded
+     */
+    unsigned int Upload();
+    /*! \brief Bytes that Upload() will transfer
+     */
+    unsigned int GetUploadSize() const;
+    void SetRequested(unsigned int time) { m_lastRequested = time; };
+    unsigned int GetLastRequested() const { return m_lastRequested; };
+
     const CStdString &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    bool Matches(const CStdString &path, unsigned int width, unsigned int height) const
+    {
+      return m_path == path && m_width == width && m_height == height;
+    };
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
 
     unsigned int m_refCount;
     CStdString m_path;
+    unsigned int m_width;
+    unsigned int m_height;
     CTextureArray m_texture;
     unsigned int m_timeToDelete;
+    unsigned int m_lastRequested; ///< frame time a control last asked for the image while it awaited upload
   };
 
-  void QueueImage(const CStdString &path);
+  void QueueImage(const CStdString &path, unsigned int width, unsigned int height);
 
   std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
+  std::vector<CLargeTexture *> m_uploads; ///< loaded images waiting for upload to the GPU
+  CLargeTexture *m_uploading;             ///< image UploadImages() is uploading without the lock held
+  bool m_uploadingReleased;                ///< m_uploading was released immediately while being uploaded
   std::vector<CLargeTexture *> m_allocated;
   typedef std::vector<CLargeTexture *>::iterator listIterator;
   typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
 
   CCriticalSection m_listSection;
+
+  // upload statistics
+  unsigned int m_uploadCount;
+  uint64_t     m_uploadBytes;
+  unsigned int m_uploadMaxFrameTime;
+  unsigned int m_uploadDeferredFrames;
 };
 
 extern CGUILargeTextureManager g_largeTextureManager;
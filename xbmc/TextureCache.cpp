@@ -23,6 +23,7 @@
 #include "TextureCacheJob.h"
 #include "filesystem/File.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/Crc32.h"
 #include "settings/Settings.h"
 #include "settings/AdvancedSettings.h"
@@ -32,6 +33,9 @@
 
 using namespace XFILE;
 
+// number of textures held in the in-memory index
+static const size_t index_size = 8192;
+
 CTextureCache &CTextureCache::Get()
 {
   static CTextureCache s_cache;
@@ -40,6 +44,12 @@ CTextureCache &CTextureCache::Get()
 
 CTextureCache::CTextureCache()
 {
+  m_useCountTime = 0;
+  m_pruneTime = 0;
+  m_indexChanges = 0;
+  m_indexHits = 0;
+  m_indexMisses = 0;
+  m_precacher = NULL;
 }
 
 CTextureCache::~CTextureCache()
@@ -51,11 +61,21 @@ void CTextureCache::Initialize()
   CSingleLock lock(m_databaseSection);
   if (!m_database.IsOpen())
     m_database.Open();
+  m_useCountTime = XbmcThreads::SystemClockMillis();
+  CheckDiskBudget(true);
 }
 
 void CTextureCache::Deinitialize()
 {
+  StopPrecaching();
   CancelJobs();
+  FlushUseCounts(false);
+  {
+    CSingleLock lock(m_indexSection);
+    m_index.clear();
+    m_indexUsed.clear();
+    m_indexChanges++;
+  }
   CSingleLock lock(m_databaseSection);
   m_database.Close();
 }
@@ -78,7 +98,7 @@ bool CTextureCache::HasCachedImage(const CStdString &url)
   return (!cachedImage.IsEmpty() && cachedImage != url);
 }
 
-CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &cachedHash, bool trackUsage)
+CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &cachedHash, bool trackUsage, unsigned int width, unsigned int height)
 {
   cachedHash.clear();
   CStdString url = UnwrapImageURL(image);
@@ -92,6 +112,15 @@ CStdString CTextureCache::GetCachedImage(const CStdString &image, CStdString &ca
   {
     if (trackUsage)
       IncrementUseCount(details);
+    // use the smallest copy that doesn't need scaling up
+    if (width || height)
+    {
+      for (unsigned int i = details.derivatives; i > 0; i--)
+      {
+        if ((details.width >> i) >= width && (details.height >> i) >= height)
+          return GetCachedPath(GetDerivativeFile(details.file, i));
+      }
+    }
     return GetCachedPath(details.file);
   }
   return "";
@@ -133,10 +162,10 @@ CStdString CTextureCache::UnwrapImageURL(const CStdString &image)
   return image;
 }
 
-CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS, bool &needsRecaching)
+CStdString CTextureCache::CheckCachedImage(const CStdString &url, bool returnDDS, bool &needsRecaching, unsigned int width, unsigned int height)
 {
   CStdString cachedHash;
-  CStdString path(GetCachedImage(url, cachedHash, true));
+  CStdString path(GetCachedImage(url, cachedHash, true, width, height));
   needsRecaching = !cachedHash.IsEmpty();
   if (!path.IsEmpty())
   {
@@ -200,7 +229,10 @@ void CTextureCache::ClearCachedImage(const CStdString &url, bool deleteSource /*
   CStdString path = deleteSource ? url : "";
   CStdString cachedFile;
   if (ClearCachedTexture(url, cachedFile))
-    path = GetCachedPath(cachedFile);
+  {
+    DeleteCachedFiles(cachedFile);
+    return;
+  }
   if (CFile::Exists(path))
     CFile::Delete(path);
   path = URIUtils::ReplaceExtension(path, ".dds");
@@ -208,41 +240,226 @@ void CTextureCache::ClearCachedImage(const CStdString &url, bool deleteSource /*
     CFile::Delete(path);
 }
 
+void CTextureCache::DeleteCachedFiles(const CStdString &file)
+{
+  for (unsigned int i = 0; i <= MAX_DERIVATIVES; i++)
+  {
+    CStdString path = GetCachedPath(i ? GetDerivativeFile(file, i) : file);
+    if (CFile::Exists(path))
+      CFile::Delete(path);
+    path = URIUtils::ReplaceExtension(path, ".dds");
+    if (CFile::Exists(path))
+      CFile::Delete(path);
+  }
+}
+
 bool CTextureCache::GetCachedTexture(const CStdString &url, CTextureDetails &details)
 {
-  CSingleLock lock(m_databaseSection);
-  return m_database.GetCachedTexture(url, details);
+  CIndexEntry entry;
+  unsigned int changes = 0;
+  bool found = false;
+  {
+    CSingleLock lock(m_indexSection);
+    TextureIndex::iterator i = m_index.find(url);
+    if (i != m_index.end())
+    {
+      m_indexHits++;
+      m_indexUsed.splice(m_indexUsed.begin(), m_indexUsed, i->second.used);
+      entry = i->second;
+      found = true;
+    }
+    else
+    {
+      m_indexMisses++;
+      changes = m_indexChanges;
+    }
+  }
+
+  if (!found)
+  {
+    {
+      CSingleLock lock(m_databaseSection);
+      entry.cached = m_database.GetCachedTexture(url, entry.details, entry.lastHashCheck);
+    }
+    // remember the result (even if it's not cached) unless the entry was changed meanwhile
+    CSingleLock lock(m_indexSection);
+    if (changes == m_indexChanges && m_index.find(url) == m_index.end())
+    {
+      m_indexUsed.push_front(url);
+      entry.used = m_indexUsed.begin();
+      m_index.insert(std::make_pair(url, entry));
+      if (m_index.size() > index_size)
+      {
+        m_index.erase(m_indexUsed.back());
+        m_indexUsed.pop_back();
+      }
+    }
+  }
+
+  if (!entry.cached)
+    return false;
+
+  details = entry.details;
+  // the hash is only returned once it's time to check the image for updates
+  if (!entry.lastHashCheck.IsValid() || entry.lastHashCheck + CDateTimeSpan(1,0,0,0) >= CDateTime::GetCurrentDateTime())
+    details.hash.clear();
+  return true;
+}
+
+void CTextureCache::RemoveFromIndex(const CStdString &url)
+{
+  CSingleLock lock(m_indexSection);
+  m_indexChanges++;
+  TextureIndex::iterator i = m_index.find(url);
+  if (i != m_index.end())
+  {
+    m_indexUsed.erase(i->second.used);
+    m_index.erase(i);
+  }
+}
+
+void CTextureCache::GetIndexStats(unsigned int &hits, unsigned int &misses, unsigned int &entries)
+{
+  CSingleLock lock(m_indexSection);
+  hits = m_indexHits;
+  misses = m_indexMisses;
+  entries = m_index.size();
+}
+
+void CTextureCache::PrecacheArtwork(const CStdString &path)
+{
+  CSingleLock lock(m_precacheSection);
+  if (m_precacher && m_precacher->IsRunning())
+  {
+    CLog::Log(LOGWARNING, "%s already caching artwork, ignoring %s", __FUNCTION__, path.c_str());
+    return;
+  }
+  delete m_precacher;
+  m_precacher = new CTexturePrecacher(path);
+  m_precacher->Create();
+}
+
+bool CTextureCache::IsPrecaching()
+{
+  CSingleLock lock(m_precacheSection);
+  return m_precacher && m_precacher->IsRunning();
+}
+
+void CTextureCache::StopPrecaching()
+{
+  CSingleLock lock(m_precacheSection);
+  delete m_precacher; // stops the thread
+  m_precacher = NULL;
 }
 
 bool CTextureCache::AddCachedTexture(const CStdString &url, const CTextureDetails &details)
 {
-  CSingleLock lock(m_databaseSection);
-  return m_database.AddCachedTexture(url, details);
+  bool result;
+  {
+    CSingleLock lock(m_databaseSection);
+    result = m_database.AddCachedTexture(url, details);
+  }
+  RemoveFromIndex(url);
+  return result;
 }
 
 void CTextureCache::IncrementUseCount(const CTextureDetails &details)
 {
   static const size_t count_before_update = 100;
+  static const unsigned int time_before_update = 10000;
   CSingleLock lock(m_useCountSection);
-  m_useCounts.reserve(count_before_update);
-  m_useCounts.push_back(details);
-  if (m_useCounts.size() >= count_before_update)
-  {
+  // uses of the same texture are combined into a single update
+  std::pair<TextureUseCounts::iterator, bool> i = m_useCounts.insert(std::make_pair(details.id, std::make_pair(details, 0u)));
+  i.first->second.second++;
+  if (m_useCounts.size() >= count_before_update ||
+      XbmcThreads::SystemClockMillis() - m_useCountTime >= time_before_update)
+    FlushUseCounts(true);
+}
+
+void CTextureCache::FlushUseCounts(bool background)
+{
+  CSingleLock lock(m_useCountSection);
+  m_useCountTime = XbmcThreads::SystemClockMillis();
+  if (m_useCounts.empty())
+    return;
+
+  if (background)
     AddJob(new CTextureUseCountJob(m_useCounts));
-    m_useCounts.clear();
+  else
+  {
+    CSingleLock dbLock(m_databaseSection);
+    m_database.BeginTransaction();
+    for (TextureUseCounts::const_iterator i = m_useCounts.begin(); i != m_useCounts.end(); ++i)
+      m_database.IncrementUseCount(i->second.first, i->second.second);
+    m_database.CommitTransaction();
   }
+  m_useCounts.clear();
 }
 
 bool CTextureCache::SetCachedTextureValid(const CStdString &url, bool updateable)
 {
-  CSingleLock lock(m_databaseSection);
-  return m_database.SetCachedTextureValid(url, updateable);
+  bool result;
+  {
+    CSingleLock lock(m_databaseSection);
+    result = m_database.SetCachedTextureValid(url, updateable);
+  }
+  RemoveFromIndex(url);
+  return result;
 }
 
 bool CTextureCache::ClearCachedTexture(const CStdString &url, CStdString &cachedURL)
 {
-  CSingleLock lock(m_databaseSection);
-  return m_database.ClearCachedTexture(url, cachedURL);
+  bool result;
+  {
+    CSingleLock lock(m_databaseSection);
+    result = m_database.ClearCachedTexture(url, cachedURL);
+  }
+  RemoveFromIndex(url);
+  return result;
+}
+
+bool CTextureCache::RemoveCachedTextures(const std::vector<CTextureUsage> &textures)
+{
+  std::vector<int> ids;
+  for (std::vector<CTextureUsage>::const_iterator i = textures.begin(); i != textures.end(); ++i)
+    ids.push_back(i->id);
+  bool result;
+  {
+    CSingleLock lock(m_databaseSection);
+    result = m_database.RemoveCachedTextures(ids);
+  }
+  for (std::vector<CTextureUsage>::const_iterator i = textures.begin(); i != textures.end(); ++i)
+    RemoveFromIndex(i->url);
+  return result;
+}
+
+void CTextureCache::CheckDiskBudget(bool force)
+{
+  static const unsigned int time_between_checks = 24 * 60 * 60 * 1000;
+  if (!g_advancedSettings.m_textureCacheMaxSize && !g_advancedSettings.m_textureCacheMaxFiles)
+    return;
+
+  {
+    CSingleLock lock(m_processingSection);
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    if (!force && now - m_pruneTime < time_between_checks)
+      return;
+    m_pruneTime = now;
+  }
+  // not queued with the caching jobs as sizing up the cache takes a while
+  CJobManager::GetInstance().AddJob(new CTexturePruneJob((uint64_t)g_advancedSettings.m_textureCacheMaxSize * 1024 * 1024,
+                                                         g_advancedSettings.m_textureCacheMaxFiles), NULL);
+}
+
+bool CTextureCache::InvalidateCachedTexture(const CStdString &url)
+{
+  bool result;
+  {
+    CSingleLock lock(m_databaseSection);
+    result = m_database.InvalidateCachedTexture(url);
+  }
+  RemoveFromIndex(url);
+  return result;
 }
 
 CStdString CTextureCache::GetCacheFile(const CStdString &url)
@@ -261,6 +478,13 @@ CStdString CTextureCache::GetCachedPath(const CStdString &file)
   return URIUtils::AddFileToFolder(g_settings.GetThumbnailsFolder(), file);
 }
 
+CStdString CTextureCache::GetDerivativeFile(const CStdString &file, unsigned int derivative)
+{
+  CStdString extension;
+  extension.Format("-%u%s", derivative, URIUtils::GetExtension(file).c_str());
+  return URIUtils::ReplaceExtension(file, extension);
+}
+
 void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
 {
   if (success)
@@ -280,9 +504,16 @@ void CTextureCache::OnCachingComplete(bool success, CTextureCacheJob *job)
 
   m_completeEvent.Set();
 
+  if (success)
+    CheckDiskBudget(false);
+
   // TODO: call back to the UI indicating that it can update it's image...
+  // images cached in bulk by the precacher favour compression speed over quality
   if (success && g_advancedSettings.m_useDDSFanart && !job->m_details.file.empty())
-    AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file)));
+  {
+    bool fast = CJobManager::GetInstance().IsProcessing(kJobTypeCacheArtwork) > 0;
+    AddJob(new CTextureDDSJob(GetCachedPath(job->m_details.file), fast));
+  }
 }
 
 void CTextureCache::OnJobComplete(unsigned int jobID, bool success, CJob *job)
@@ -22,10 +22,13 @@
 #pragma once
 
 #include <set>
+#include <map>
+#include <list>
 #include "utils/StdString.h"
 #include "utils/JobManager.h"
 #include "TextureDatabase.h"
 #include "threads/Event.h"
+#include "XBDateTime.h"
 
 class CBaseTexture;
 
@@ -38,10 +41,17 @@ class CBaseTexture;
  may be periodically checked for updates and may be purged from the cache if
  unused for a set period of time.
 
+ Lookups are answered from a bounded in-memory index of the most recently used
+ textures where possible, and use counts are written back to the database in batches.
+
  */
 class CTextureCache : public CJobQueue
 {
 public:
+  /*! \brief Maximal number of smaller copies cached for an image, each half the size of the previous one
+   */
+  static const unsigned int MAX_DERIVATIVES = 2;
+
   /*!
    \brief The only way through which the global instance of the CTextureCache should be accessed.
    \return the global instance.
@@ -65,10 +75,12 @@ public:
    \param image url of the image to check
    \param returnDDS if we're allowed to return a DDS version, defaults to true
    \param needsRecaching [out] whether the image needs recaching.
-   \return cached url of this image
+   \param width width the image will be displayed at, 0 for the full size image
+   \param height height the image will be displayed at, 0 for the full size image
+   \return cached url of this image, the smallest cached copy that covers width x height if given
    \sa GetCachedImage
    */ 
-  CStdString CheckCachedImage(const CStdString &image, bool returnDDS, bool &needsRecaching);
+  CStdString CheckCachedImage(const CStdString &image, bool returnDDS, bool &needsRecaching, unsigned int width = 0, unsigned int height = 0);
 
   /*! \brief Cache image (if required) using a background job
 
@@ -119,6 +131,18 @@ public:
    */
   static CStdString GetCachedPath(const CStdString &file);
 
+  /*! \brief retrieve the cache file of a smaller copy of a cached image
+   \param file cache file of the image, relative to the cache path
+   \param derivative which copy, 1 for half size, 2 for quarter size and so on up to MAX_DERIVATIVES
+   \return cache file of the copy, relative to the cache path
+   */
+  static CStdString GetDerivativeFile(const CStdString &file, unsigned int derivative);
+
+  /*! \brief delete a cached image along with its smaller copies and .dds versions
+   \param file cache file of the image, relative to the cache path
+   */
+  static void DeleteCachedFiles(const CStdString &file);
+
   /*! \brief retrieve a wrapped URL for a image file
    \param image name of the file
    \param type signifies a special type of image (eg embedded video thumb, picture folder thumb)
@@ -142,6 +166,45 @@ public:
    \return true if we successfully exported the file, false otherwise.
    */
   bool Export(const CStdString &image, const CStdString &destination);
+
+  /*! \brief Invalidate a cached image so that it's checked for updates the next time it's used
+   Thread-safe wrapper of CTextureDatabase::InvalidateCachedTexture
+   \param image url of the original image
+   \return true if successful, false otherwise.
+   */
+  bool InvalidateCachedTexture(const CStdString &image);
+
+  /*! \brief Remove images from the database
+   Thread-safe wrapper of CTextureDatabase::RemoveCachedTextures. The cached files are left to the caller.
+   \param textures the textures to remove
+   \return true if successful, false otherwise.
+   \sa CTexturePruneJob
+   */
+  bool RemoveCachedTextures(const std::vector<CTextureUsage> &textures);
+
+  /*! \brief Retrieve statistics of the in-memory texture index
+   \param hits [out] number of lookups answered from memory
+   \param misses [out] number of lookups that had to query the database
+   \param entries [out] number of textures currently held in memory
+   */
+  void GetIndexStats(unsigned int &hits, unsigned int &misses, unsigned int &entries);
+
+  /*! \brief Cache the artwork of a source or library path in the background
+   Does nothing if artwork is already being cached.
+   \param path the path to cache the artwork below
+   \sa CTexturePrecacher
+   */
+  void PrecacheArtwork(const CStdString &path);
+
+  /*! \brief Whether artwork is being cached in the background
+   \sa PrecacheArtwork
+   */
+  bool IsPrecaching();
+
+  /*! \brief Stop caching artwork in the background, waiting for the jobs in flight to finish
+   \sa PrecacheArtwork
+   */
+  void StopPrecaching();
 private:
   // private construction, and no assignements; use the provided singleton methods
   CTextureCache();
@@ -166,12 +229,14 @@ private:
    \param image url of the image
    \param cacheHash [out] set to the hash of the cached image if it needs checking
    \param trackUsage whether this call should track usage of the image (defaults to false)
+   \param width width the image will be displayed at, 0 for the full size image
+   \param height height the image will be displayed at, 0 for the full size image
    \return cached url of this image, empty if none exists
    \sa ClearCachedImage
    */
-  CStdString GetCachedImage(const CStdString &image, CStdString &cacheHash, bool trackUsage = false);
+  CStdString GetCachedImage(const CStdString &image, CStdString &cacheHash, bool trackUsage = false, unsigned int width = 0, unsigned int height = 0);
 
-  /*! \brief Get an image from the database
+  /*! \brief Get an image from the in-memory index, or the database if it's not held in memory
    Thread-safe wrapper of CTextureDatabase::GetCachedTexture
    \param image url of the original image
    \param details [out] texture details from the database (if available)
@@ -193,6 +258,21 @@ private:
    */
   void IncrementUseCount(const CTextureDetails &details);
 
+  /*! \brief Write the use counts stored by IncrementUseCount to the database
+   \param background whether to write them from a CUseCountJob or directly
+   */
+  void FlushUseCounts(bool background);
+
+  /*! \brief Drop an image from the in-memory index after its database entry changed
+   \param url url of the original image
+   */
+  void RemoveFromIndex(const CStdString &url);
+
+  /*! \brief Start a CTexturePruneJob if a disk budget is set and the last one was long enough ago
+   \param force start it regardless of the time of the last one
+   */
+  void CheckDiskBudget(bool force);
+
   /*! \brief Set a previously cached texture as valid in the database
    Thread-safe wrapper of CTextureDatabase::SetCachedTextureValid
    \param image url of the original image
@@ -217,7 +297,30 @@ private:
   std::set<CStdString> m_processing; ///< currently processing list to avoid 2 jobs being processed at once
   CCriticalSection     m_processingSection;
   CEvent               m_completeEvent; ///< Set whenever a job has finished
-  std::vector<CTextureDetails> m_useCounts; ///< Use count tracking
-  CCriticalSection             m_useCountSection;
+  unsigned int         m_pruneTime; ///< Time the cache was last checked against its disk budget
+  TextureUseCounts     m_useCounts; ///< Use count tracking
+  unsigned int         m_useCountTime; ///< Time the use counts were last written
+  CCriticalSection     m_useCountSection;
+  CTexturePrecacher   *m_precacher; ///< background caching of artwork, if any
+  CCriticalSection     m_precacheSection;
+
+  /*! \brief Database entry of a texture held in memory
+   */
+  class CIndexEntry
+  {
+  public:
+    CTextureDetails details;
+    CDateTime       lastHashCheck;
+    bool            cached; ///< whether the texture was in the database at all
+    std::list<CStdString>::iterator used; ///< position in m_indexUsed
+  };
+  typedef std::map<CStdString, CIndexEntry> TextureIndex;
+
+  TextureIndex          m_index;
+  std::list<CStdString> m_indexUsed;  ///< urls in m_index, most recently used first
+  unsigned int          m_indexChanges; ///< number of times an entry was removed, to detect lookups that raced with a change
+  unsigned int          m_indexHits;
+  unsigned int          m_indexMisses;
+  CCriticalSection      m_indexSection;
 };
 
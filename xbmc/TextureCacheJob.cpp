@@ -28,13 +28,21 @@
 #include "settings/GUISettings.h"
 #include "utils/log.h"
 #include "filesystem/File.h"
+#include "filesystem/Directory.h"
 #include "pictures/Picture.h"
 #include "utils/URIUtils.h"
 #include "utils/StringUtils.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "URL.h"
 #include "FileItem.h"
 #include "ThumbLoader.h"
 #include "music/tags/MusicInfoTag.h"
+#include "video/VideoDatabase.h"
+
+#include <algorithm>
 
 CTextureCacheJob::CTextureCacheJob(const CStdString &url, const CStdString &oldHash)
 {
@@ -103,6 +111,7 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
     {
       m_details.width = width;
       m_details.height = height;
+      CacheDerivatives(texture);
       if (out_texture) // caller wants the texture
         *out_texture = texture;
       else
@@ -114,6 +123,21 @@ bool CTextureCacheJob::CacheTexture(CBaseTexture **out_texture)
   return false;
 }
 
+void CTextureCacheJob::CacheDerivatives(CBaseTexture *texture)
+{
+  // smaller copies for views showing the image at a fraction of its size, scaled from the same decode
+  static const unsigned int min_size = 128;
+  unsigned int size = std::max(m_details.width, m_details.height);
+  m_details.derivatives = 0;
+  for (unsigned int i = 1; i <= CTextureCache::MAX_DERIVATIVES && (size >> i) >= min_size; i++)
+  {
+    uint32_t width = size >> i, height = size >> i;
+    if (!CPicture::CacheTexture(texture, width, height, CTextureCache::GetCachedPath(CTextureCache::GetDerivativeFile(m_details.file, i))))
+      break;
+    m_details.derivatives = i;
+  }
+}
+
 CStdString CTextureCacheJob::DecodeImageURL(const CStdString &url, unsigned int &width, unsigned int &height, std::string &additional_info)
 {
   // unwrap the URL as required
@@ -224,9 +248,10 @@ CStdString CTextureCacheJob::GetImageHash(const CStdString &url)
   return "";
 }
 
-CTextureDDSJob::CTextureDDSJob(const CStdString &original)
+CTextureDDSJob::CTextureDDSJob(const CStdString &original, bool fast)
 {
   m_original = original;
+  m_fast = fast;
 }
 
 bool CTextureDDSJob::operator==(const CJob* job) const
@@ -249,14 +274,14 @@ bool CTextureDDSJob::DoWork()
   { // convert to DDS
     CDDSImage dds;
     CLog::Log(LOGDEBUG, "Creating DDS version of: %s", m_original.c_str());
-    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40);
+    bool ret = dds.Create(URIUtils::ReplaceExtension(m_original, ".dds"), texture->GetWidth(), texture->GetHeight(), texture->GetPitch(), texture->GetPixels(), 40, m_fast);
     delete texture;
     return ret;
   }
   return false;
 }
 
-CTextureUseCountJob::CTextureUseCountJob(const std::vector<CTextureDetails> &textures) : m_textures(textures)
+CTextureUseCountJob::CTextureUseCountJob(const TextureUseCounts &textures) : m_textures(textures)
 {
 }
 
@@ -277,9 +302,276 @@ bool CTextureUseCountJob::DoWork()
   if (db.Open())
   {
     db.BeginTransaction();
-    for (std::vector<CTextureDetails>::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
-      db.IncrementUseCount(*i);
+    for (TextureUseCounts::const_iterator i = m_textures.begin(); i != m_textures.end(); ++i)
+      db.IncrementUseCount(i->second.first, i->second.second);
     db.CommitTransaction();
   }
   return true;
 }
+
+CTexturePruneJob::CTexturePruneJob(uint64_t maxBytes, unsigned int maxFiles) : m_maxBytes(maxBytes), m_maxFiles(maxFiles)
+{
+}
+
+bool CTexturePruneJob::operator==(const CJob* job) const
+{
+  return strcmp(job->GetType(), GetType()) == 0;
+}
+
+double CTexturePruneJob::GetScore(const CTextureUsage &texture, const CDateTime &now)
+{
+  double days = 365;
+  if (texture.lastused.IsValid())
+  {
+    CDateTimeSpan age = now - texture.lastused;
+    days = std::max(age.GetDays() + age.GetHours() / 24.0, 0.0);
+  }
+  return texture.usecount / (days + 1);
+}
+
+bool CTexturePruneJob::DoWork()
+{
+  std::vector<CTextureUsage> textures;
+  {
+    CTextureDatabase db;
+    if (!db.Open() || !db.GetTextureUsage(textures))
+      return false;
+  }
+
+  // size up the cache
+  CDateTime now = CDateTime::GetCurrentDateTime();
+  std::vector<uint64_t> sizes(textures.size());
+  std::vector< std::pair<double, size_t> > scores;
+  scores.reserve(textures.size());
+  uint64_t totalBytes = 0;
+  for (size_t i = 0; i < textures.size(); i++)
+  {
+    for (unsigned int j = 0; j <= CTextureCache::MAX_DERIVATIVES; j++)
+    {
+      CStdString path = CTextureCache::GetCachedPath(j ? CTextureCache::GetDerivativeFile(textures[i].file, j) : textures[i].file);
+      struct __stat64 st;
+      if (XFILE::CFile::Stat(path, &st) == 0)
+        sizes[i] += st.st_size;
+      if (XFILE::CFile::Stat(URIUtils::ReplaceExtension(path, ".dds"), &st) == 0)
+        sizes[i] += st.st_size;
+    }
+    totalBytes += sizes[i];
+    scores.push_back(std::make_pair(GetScore(textures[i], now), i));
+  }
+
+  if ((!m_maxBytes || totalBytes <= m_maxBytes) && (!m_maxFiles || textures.size() <= m_maxFiles))
+  {
+    CLog::Log(LOGDEBUG, "%s %u textures using %"PRIu64" KB, nothing to remove", __FUNCTION__, (unsigned int)textures.size(), totalBytes / 1024);
+    return true;
+  }
+
+  // remove the least valuable textures until we're comfortably below the budget
+  std::sort(scores.begin(), scores.end());
+  uint64_t targetBytes = m_maxBytes / 10 * 9;
+  size_t targetFiles = m_maxFiles / 10 * 9;
+  uint64_t bytes = totalBytes;
+  std::vector<CTextureUsage> removed;
+  for (size_t i = 0; i < scores.size(); i++)
+  {
+    if ((!m_maxBytes || bytes <= targetBytes) && (!m_maxFiles || textures.size() - removed.size() <= targetFiles))
+      break;
+    removed.push_back(textures[scores[i].second]);
+    bytes -= sizes[scores[i].second];
+  }
+
+  // the database entries go first, so a failure leaves at worst some unused files behind
+  if (!CTextureCache::Get().RemoveCachedTextures(removed))
+    return false;
+  for (std::vector<CTextureUsage>::const_iterator i = removed.begin(); i != removed.end(); ++i)
+    CTextureCache::DeleteCachedFiles(i->file);
+
+  CLog::Log(LOGNOTICE, "%s removed %u of %u textures, reclaimed %"PRIu64" KB", __FUNCTION__,
+            (unsigned int)removed.size(), (unsigned int)textures.size(), (totalBytes - bytes) / 1024);
+  return true;
+}
+
+CTexturePrecacheJob::CTexturePrecacheJob(const CStdString &url) : m_url(url)
+{
+}
+
+bool CTexturePrecacheJob::operator==(const CJob* job) const
+{
+  if (strcmp(job->GetType(),GetType()) == 0)
+  {
+    const CTexturePrecacheJob* precacheJob = dynamic_cast<const CTexturePrecacheJob*>(job);
+    if (precacheJob && precacheJob->m_url == m_url)
+      return true;
+  }
+  return false;
+}
+
+bool CTexturePrecacheJob::DoWork()
+{
+  if (m_url.compare(0, 14, "image://video@") == 0)
+  { // the texture cache can't decode these, grab a frame from the video instead
+    CStdString path = CURL(m_url).GetHostName();
+    CURL::Decode(path);
+    CThumbExtractor extract(CFileItem(path, false), path, true, m_url);
+    return extract.DoWork();
+  }
+  return !CTextureCache::Get().CacheImage(m_url).IsEmpty();
+}
+
+CTexturePrecacher::CTexturePrecacher(const CStdString &path) : CThread("CTexturePrecacher"), m_path(path)
+{
+  m_database = new CVideoDatabase;
+  m_skipped = 0;
+  m_cached = 0;
+  m_failed = 0;
+}
+
+CTexturePrecacher::~CTexturePrecacher()
+{
+  StopThread();
+  delete m_database;
+}
+
+void CTexturePrecacher::Process()
+{
+  unsigned int start = XbmcThreads::SystemClockMillis();
+  m_database->Open();
+  GetImages(m_path);
+  m_database->Close();
+  m_seen.clear();
+  CLog::Log(LOGNOTICE, "%s %u images to cache below %s, %u already cached, listed in %u ms", __FUNCTION__,
+            (unsigned int)m_images.size(), m_path.c_str(), m_skipped, XbmcThreads::SystemClockMillis() - start);
+
+  // one job per CPU in flight, at most as many run at once as the job manager allows
+  unsigned int maxJobs = std::max(g_cpuInfo.getCPUCount(), 1);
+  size_t next = 0;
+  unsigned int elapsed = 0; // time spent caching, excluding pauses
+  unsigned int lastTime = XbmcThreads::SystemClockMillis();
+  unsigned int lastReport = 0;
+  while (!m_bStop)
+  {
+    bool paused = CJobManager::GetInstance().IsPaused(kJobTypeCacheArtwork);
+    {
+      CSingleLock lock(m_section);
+      if (next == m_images.size() && m_jobs.empty())
+        break;
+      while (!paused && next < m_images.size() && m_jobs.size() < maxJobs)
+        m_jobs.insert(CJobManager::GetInstance().AddJob(new CTexturePrecacheJob(m_images[next++]), this));
+    }
+
+    AbortableWait(m_jobEvent, 1000);
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    if (!paused)
+      elapsed += now - lastTime;
+    lastTime = now;
+    if (elapsed - lastReport >= 10000)
+    {
+      LogProgress(elapsed);
+      lastReport = elapsed;
+    }
+  }
+
+  if (m_bStop)
+  { // queued jobs are dropped, running ones may still be calling back into us
+    CSingleLock lock(m_section);
+    for (std::set<unsigned int>::const_iterator i = m_jobs.begin(); i != m_jobs.end(); ++i)
+      CJobManager::GetInstance().CancelJob(*i);
+    m_jobs.clear();
+    lock.Leave();
+    while (CJobManager::GetInstance().IsProcessing(kJobTypeCacheArtwork))
+      m_jobEvent.WaitMSec(100);
+  }
+
+  LogProgress(elapsed);
+  CLog::Log(LOGNOTICE, "%s %s caching artwork below %s after %u s", __FUNCTION__,
+            m_bStop ? "stopped" : "finished", m_path.c_str(), (XbmcThreads::SystemClockMillis() - start) / 1000);
+}
+
+void CTexturePrecacher::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+{
+  CSingleLock lock(m_section);
+  if (success)
+    m_cached++;
+  else
+    m_failed++;
+  m_jobs.erase(jobID);
+  m_jobEvent.Set();
+}
+
+void CTexturePrecacher::LogProgress(unsigned int elapsed) const
+{
+  unsigned int done = m_cached + m_failed;
+  unsigned int remaining = m_images.size() - done;
+  float rate = elapsed ? done * 1000.0f / elapsed : 0;
+  if (rate > 0)
+    CLog::Log(LOGNOTICE, "%s cached %u of %u images (%u failed), %.1f images/s, about %u s left", __FUNCTION__,
+              done, (unsigned int)m_images.size(), m_failed, rate, (unsigned int)(remaining / rate));
+  else
+    CLog::Log(LOGNOTICE, "%s cached %u of %u images (%u failed)", __FUNCTION__,
+              done, (unsigned int)m_images.size(), m_failed);
+}
+
+void CTexturePrecacher::GetImages(const CStdString &path)
+{
+  if (m_bStop || !m_seen.insert(path).second)
+    return;
+
+  CFileItemList items;
+  if (!XFILE::CDirectory::GetDirectory(path, items))
+    return;
+
+  for (int i = 0; i < items.Size() && !m_bStop; i++)
+  {
+    CFileItemPtr item = items[i];
+    if (item->IsParentFolder())
+      continue;
+    AddItemImages(*item);
+    if (item->m_bIsFolder && !item->IsPlayList())
+      GetImages(item->GetPath());
+  }
+}
+
+void CTexturePrecacher::AddItemImages(CFileItem &item)
+{
+  bool archive = item.IsZIP() || item.IsRAR() || item.IsCBZ() || item.IsCBR() || item.IsPlayList();
+
+  // library items have their art in the database
+  if (item.HasVideoInfoTag() && item.GetVideoInfoTag()->m_iDbId > -1 && !item.GetVideoInfoTag()->m_type.IsEmpty())
+  {
+    std::map<std::string, std::string> art;
+    if (m_database->GetArtForItem(item.GetVideoInfoTag()->m_iDbId, item.GetVideoInfoTag()->m_type, art))
+    {
+      for (std::map<std::string, std::string>::const_iterator i = art.begin(); i != art.end(); ++i)
+        AddImage(i->second);
+      return;
+    }
+  }
+
+  // otherwise as found by the thumb loaders
+  if (item.IsPicture() && !archive)
+    AddImage(item.HasThumbnail() ? item.GetThumbnailImage() : CTextureCache::GetWrappedThumbURL(item.GetPath()));
+  else if (item.IsVideo() && !item.m_bIsFolder && !archive)
+  {
+    if (CVideoThumbLoader::FillThumb(item))
+      AddImage(item.GetThumbnailImage());
+    else if (g_guiSettings.GetBool("myvideos.extractthumb") && g_guiSettings.GetBool("myvideos.extractflags"))
+      AddImage(CVideoThumbLoader::GetEmbeddedThumbURL(item));
+    AddImage(item.GetLocalFanart());
+  }
+  else if (item.HasThumbnail())
+    AddImage(item.GetThumbnailImage());
+
+  if (item.HasProperty("fanart_image"))
+    AddImage(item.GetProperty("fanart_image").asString());
+}
+
+void CTexturePrecacher::AddImage(const CStdString &url)
+{
+  if (url.IsEmpty() || !m_seen.insert(url).second)
+    return;
+
+  if (CTextureCache::Get().HasCachedImage(url))
+    m_skipped++;
+  else
+    m_images.push_back(url);
+}
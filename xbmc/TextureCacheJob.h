@@ -21,10 +21,21 @@
 
 #pragma once
 
+#include <map>
+#include <set>
+#include <vector>
 #include "utils/StdString.h"
 #include "utils/Job.h"
+#include "threads/Thread.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "XBDateTime.h"
+
+#define kJobTypeCacheArtwork "cacheartwork"
 
 class CBaseTexture;
+class CFileItem;
+class CVideoDatabase;
 
 /*!
  \ingroup textures
@@ -37,6 +48,7 @@ public:
   {
     id = -1;
     width = height = 0;
+    derivatives = 0;
     updateable = false;
   };
   bool operator==(const CTextureDetails &right) const
@@ -50,9 +62,29 @@ public:
   std::string  hash;
   unsigned int width;
   unsigned int height;
+  unsigned int derivatives; ///< number of smaller copies, each half the size of the previous one
   bool         updateable;
 };
 
+/*!
+ \ingroup textures
+ \brief Usage of a cached texture, as used to decide which textures to remove from the cache
+ */
+class CTextureUsage
+{
+public:
+  CTextureUsage()
+  {
+    id = -1;
+    usecount = 0;
+  };
+  int          id;
+  CStdString   url;
+  std::string  file;
+  unsigned int usecount;
+  CDateTime    lastused;
+};
+
 /*!
  \ingroup textures
  \brief Job class for caching textures
@@ -118,6 +150,13 @@ private:
    */
   static CBaseTexture *LoadImage(const CStdString &image, unsigned int width, unsigned int height, const std::string &additional_info);
 
+  /*! \brief Cache the smaller copies of a texture that has just been cached
+   Sets m_details.derivatives to the number of copies cached.
+   \param texture the loaded image
+   \sa CTextureCache::GetDerivativeFile
+   */
+  void CacheDerivatives(CBaseTexture *texture);
+
   CStdString    m_cachePath;
 };
 
@@ -126,26 +165,109 @@ private:
 class CTextureDDSJob : public CJob
 {
 public:
-  CTextureDDSJob(const CStdString &original);
+  /*! \brief Create a job converting a cached image to .dds
+   \param original path of the cached image
+   \param fast use the fast but lower quality compressor, for bulk caching
+   */
+  CTextureDDSJob(const CStdString &original, bool fast = false);
 
   virtual const char* GetType() const { return "ddscompress"; };
   virtual bool operator==(const CJob *job) const;
   virtual bool DoWork();
 
   CStdString m_original;
+  bool       m_fast;
 };
 
+/*! \brief Number of uses of textures since they were last written to the database, by texture id
+ */
+typedef std::map<int, std::pair<CTextureDetails, unsigned int> > TextureUseCounts;
+
 /* \brief Job class for storing the use count of textures
  */
 class CTextureUseCountJob : public CJob
 {
 public:
-  CTextureUseCountJob(const std::vector<CTextureDetails> &textures);
+  CTextureUseCountJob(const TextureUseCounts &textures);
 
   virtual const char* GetType() const { return "usecount"; };
   virtual bool operator==(const CJob *job) const;
   virtual bool DoWork();
 
 private:
-  std::vector<CTextureDetails> m_textures;
+  TextureUseCounts m_textures;
+};
+
+/* \brief Job class for keeping the texture cache within its disk budget
+ Removes the textures with the lowest use count relative to the time since their last use
+ until the cache is below 90% of the budget.
+ */
+class CTexturePruneJob : public CJob
+{
+public:
+  /*! \param maxBytes maximal size of the cached files, 0 for no limit
+      \param maxFiles maximal number of cached textures, 0 for no limit
+   */
+  CTexturePruneJob(uint64_t maxBytes, unsigned int maxFiles);
+
+  virtual const char* GetType() const { return "prunetextures"; };
+  virtual bool operator==(const CJob *job) const;
+  virtual bool DoWork();
+
+private:
+  static double GetScore(const CTextureUsage &texture, const CDateTime &now);
+
+  uint64_t     m_maxBytes;
+  unsigned int m_maxFiles;
+};
+
+/* \brief Job class for caching a single image on behalf of a CTexturePrecacher
+ Embedded video thumbs (image://video@) are extracted from the video, all other images
+ are cached as by CTextureCache::CacheImage.
+ */
+class CTexturePrecacheJob : public CJob
+{
+public:
+  CTexturePrecacheJob(const CStdString &url);
+
+  virtual const char* GetType() const { return kJobTypeCacheArtwork; };
+  virtual bool operator==(const CJob *job) const;
+  virtual bool DoWork();
+
+  CStdString m_url;
+};
+
+/* \brief Thread for caching all artwork of a source or library path ahead of it being browsed
+ Walks the path recursively, collects the images its items would display, skipping those already
+ cached, and caches the rest with up to one CTexturePrecacheJob per CPU in flight. No new jobs are
+ started while kJobTypeCacheArtwork is paused in the job manager, as it is during playback.
+ */
+class CTexturePrecacher : public CThread, public IJobCallback
+{
+public:
+  CTexturePrecacher(const CStdString &path);
+  virtual ~CTexturePrecacher();
+
+  virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+protected:
+  virtual void Process();
+
+private:
+  void GetImages(const CStdString &path);
+  void AddItemImages(CFileItem &item);
+  void AddImage(const CStdString &url);
+  void LogProgress(unsigned int elapsed) const;
+
+  CStdString              m_path;
+  CVideoDatabase         *m_database;
+  std::set<CStdString>    m_seen;    ///< images and folders already visited
+  std::vector<CStdString> m_images;  ///< images that need caching, in listing order
+  unsigned int            m_skipped; ///< images that were already cached
+
+  CCriticalSection        m_section;
+  CEvent                  m_jobEvent; ///< Set whenever a job has finished
+  std::set<unsigned int>  m_jobs;     ///< ids of the jobs in flight
+  unsigned int            m_cached;
+  unsigned int            m_failed;
 };
@@ -141,31 +141,32 @@ bool CTextureDatabase::UpdateOldVersion(int version)
   return true;
 }
 
-bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details)
+bool CTextureDatabase::IncrementUseCount(const CTextureDetails &details, unsigned int count)
 {
-  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+1, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", details.id, details.width, details.height);
+  CStdString sql = PrepareSQL("UPDATE sizes SET usecount=usecount+%u, lastusetime=CURRENT_TIMESTAMP WHERE idtexture=%u AND width=%u AND height=%u", count, details.id, details.width, details.height);
   return ExecuteQuery(sql);
 }
 
-bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &details)
+bool CTextureDatabase::GetCachedTexture(const CStdString &url, CTextureDetails &details, CDateTime &lastHashCheck)
 {
   try
   {
     if (NULL == m_pDB.get()) return false;
     if (NULL == m_pDS.get()) return false;
 
-    CStdString sql = PrepareSQL("SELECT id, cachedurl, lasthashcheck, imagehash, width, height FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url='%s'", url.c_str());
+    CStdString sql = PrepareSQL("SELECT id, cachedurl, lasthashcheck, imagehash, width, height, "
+                                "(SELECT COUNT(*) FROM sizes AS derivatives WHERE derivatives.idtexture=texture.id AND derivatives.size>1) "
+                                "FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1) WHERE url='%s'", url.c_str());
     m_pDS->query(sql.c_str());
     if (!m_pDS->eof())
     { // have some information
       details.id = m_pDS->fv(0).get_asInt();
       details.file  = m_pDS->fv(1).get_asString();
-      CDateTime lastCheck;
-      lastCheck.SetFromDBDateTime(m_pDS->fv(2).get_asString());
-      if (lastCheck.IsValid() && lastCheck + CDateTimeSpan(1,0,0,0) < CDateTime::GetCurrentDateTime())
-        details.hash = m_pDS->fv(3).get_asString();
+      lastHashCheck.SetFromDBDateTime(m_pDS->fv(2).get_asString());
+      details.hash = m_pDS->fv(3).get_asString();
       details.width = m_pDS->fv(4).get_asInt();
       details.height = m_pDS->fv(5).get_asInt();
+      details.derivatives = m_pDS->fv(6).get_asInt();
       m_pDS->close();
       return true;
     }
@@ -203,6 +204,13 @@ bool CTextureDatabase::AddCachedTexture(const CStdString &url, const CTextureDet
     // set the size information
     sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, 1, 1, CURRENT_TIMESTAMP, %u, %u)", textureID, details.width, details.height);
     m_pDS->exec(sql.c_str());
+
+    // the smaller copies are size 2 and up, their use is counted with the original
+    for (unsigned int i = 1; i <= details.derivatives; i++)
+    {
+      sql = PrepareSQL("INSERT INTO sizes (idtexture, size, usecount, lastusetime, width, height) VALUES(%u, %u, 0, CURRENT_TIMESTAMP, %u, %u)", textureID, i + 1, details.width >> i, details.height >> i);
+      m_pDS->exec(sql.c_str());
+    }
   }
   catch (...)
   {
@@ -240,6 +248,55 @@ bool CTextureDatabase::ClearCachedTexture(const CStdString &url, CStdString &cac
   return false;
 }
 
+bool CTextureDatabase::GetTextureUsage(std::vector<CTextureUsage> &textures)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    m_pDS->query("SELECT id, url, cachedurl, usecount, lastusetime FROM texture JOIN sizes ON (texture.id=sizes.idtexture AND sizes.size=1)");
+    while (!m_pDS->eof())
+    {
+      CTextureUsage texture;
+      texture.id = m_pDS->fv(0).get_asInt();
+      texture.url = m_pDS->fv(1).get_asString();
+      texture.file = m_pDS->fv(2).get_asString();
+      texture.usecount = m_pDS->fv(3).get_asInt();
+      texture.lastused.SetFromDBDateTime(m_pDS->fv(4).get_asString());
+      textures.push_back(texture);
+      m_pDS->next();
+    }
+    m_pDS->close();
+    return true;
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+  }
+  return false;
+}
+
+bool CTextureDatabase::RemoveCachedTextures(const std::vector<int> &ids)
+{
+  try
+  {
+    if (NULL == m_pDB.get()) return false;
+    if (NULL == m_pDS.get()) return false;
+
+    BeginTransaction();
+    for (std::vector<int>::const_iterator i = ids.begin(); i != ids.end(); ++i)
+      m_pDS->exec(PrepareSQL("DELETE FROM texture WHERE id=%u", *i).c_str());
+    return CommitTransaction();
+  }
+  catch (...)
+  {
+    CLog::Log(LOGERROR, "%s failed", __FUNCTION__);
+    RollbackTransaction();
+  }
+  return false;
+}
+
 bool CTextureDatabase::InvalidateCachedTexture(const CStdString &url)
 {
   CStdString date = (CDateTime::GetCurrentDateTime() - CDateTimeSpan(2, 0, 0, 0)).GetAsDBDateTime();
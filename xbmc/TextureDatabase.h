@@ -24,6 +24,8 @@
 #include "dbwrappers/Database.h"
 #include "TextureCacheJob.h"
 
+class CDateTime;
+
 class CTextureDatabase : public CDatabase
 {
 public:
@@ -31,11 +33,30 @@ public:
   virtual ~CTextureDatabase();
   virtual bool Open();
 
-  bool GetCachedTexture(const CStdString &originalURL, CTextureDetails &details);
+  /*! \brief Get the details of a cached texture
+   \param originalURL url of the original image
+   \param details [out] the texture details. The hash is always filled in, whether it's due to be checked or not.
+   \param lastHashCheck [out] time the hash was last checked, invalid if the texture is never checked
+   \return true if the texture is cached, false otherwise
+   */
+  bool GetCachedTexture(const CStdString &originalURL, CTextureDetails &details, CDateTime &lastHashCheck);
   bool AddCachedTexture(const CStdString &originalURL, const CTextureDetails &details);
   bool SetCachedTextureValid(const CStdString &originalURL, bool updateable);
   bool ClearCachedTexture(const CStdString &originalURL, CStdString &cacheFile);
-  bool IncrementUseCount(const CTextureDetails &details);
+  bool IncrementUseCount(const CTextureDetails &details, unsigned int count = 1);
+
+  /*! \brief Get the usage of all cached textures
+   \param textures [out] the cached textures
+   \return true if successful, false otherwise.
+   */
+  bool GetTextureUsage(std::vector<CTextureUsage> &textures);
+
+  /*! \brief Remove textures from the database in a single transaction
+   The cached files are not removed.
+   \param ids database ids of the textures
+   \return true if all textures were removed, false if nothing was removed.
+   */
+  bool RemoveCachedTextures(const std::vector<int> &ids);
 
   /*! \brief Invalidate a previously cached texture
    Invalidates the texture hash, and sets the texture update time to the current time so that
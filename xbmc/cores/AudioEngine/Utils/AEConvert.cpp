@@ -26,6 +26,7 @@
 #include "AEUtil.h"
 #include "utils/MathUtils.h"
 #include "utils/EndianSwap.h"
+#include "utils/CPUInfo.h"
 #include <stdint.h>
 
 #if defined(TARGET_WINDOWS)
@@ -68,6 +69,29 @@ static inline int safeRound(double f)
 
 CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 {
+#if defined(__SSE2__)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_U8    : return &U8_Float_SSE2;
+      case AE_FMT_S8    : return &S8_Float_SSE2;
+      case AE_FMT_S16NE :
+      case AE_FMT_S16LE : return &S16LE_Float_SSE2;
+      case AE_FMT_S16BE : return &S16BE_Float_SSE2;
+      case AE_FMT_S24NE4:
+      case AE_FMT_S24LE4: return &S24LE4_Float_SSE2;
+      case AE_FMT_S24BE4: return &S24BE4_Float_SSE2;
+      case AE_FMT_S24NE3:
+      case AE_FMT_S24LE3: return &S24LE3_Float_SSE2;
+      case AE_FMT_S24BE3: return &S24BE3_Float_SSE2;
+      case AE_FMT_S32BE : return &S32BE_Float_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &U8_Float;
@@ -104,6 +128,24 @@ CAEConvert::AEConvertToFn CAEConvert::ToFloat(enum AEDataFormat dataFormat)
 
 CAEConvert::AEConvertFrFn CAEConvert::FrFloat(enum AEDataFormat dataFormat)
 {
+#if defined(__SSE2__)
+  if (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2)
+  {
+    switch (dataFormat)
+    {
+      case AE_FMT_U8    : return &Float_U8_SSE2;
+      case AE_FMT_S8    : return &Float_S8_SSE2;
+      case AE_FMT_S24NE4: return &Float_S24NE4_SSE2;
+      case AE_FMT_S24NE3: return &Float_S24NE3_SSE2;
+      case AE_FMT_S32NE :
+      case AE_FMT_S32LE : return &Float_S32LE_SSE2;
+      case AE_FMT_S32BE : return &Float_S32BE_SSE2;
+      default:
+        break;
+    }
+  }
+#endif
+
   switch (dataFormat)
   {
     case AE_FMT_U8    : return &Float_U8;
@@ -147,7 +189,7 @@ unsigned int CAEConvert::S8_Float(uint8_t *data, const unsigned int samples, flo
   const float mul = 1.0f / (INT8_MAX + 0.5f);
 
   for (unsigned int i = 0; i < samples; ++i)
-    *dest++ = *data++ * mul;
+    *dest++ = (int8_t)*data++ * mul;
 
   return samples;
 }
@@ -177,7 +219,7 @@ unsigned int CAEConvert::S16LE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapLE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapLE16(*(int16_t*)data) * mul;
 #endif
 
   return samples;
@@ -208,7 +250,7 @@ unsigned int CAEConvert::S16BE_Float(uint8_t* data, const unsigned int samples,
   }
 #else
   for (unsigned int i = 0; i < samples; ++i, data += 2)
-    *dest++ = Endian_SwapBE16(*(int16_t*)data) * mul;
+    *dest++ = (int16_t)Endian_SwapBE16(*(int16_t*)data) * mul;
 #endif
 
   return samples;
@@ -248,7 +290,7 @@ unsigned int CAEConvert::S24BE3_Float(uint8_t *data, const unsigned int samples,
 {
   for (unsigned int i = 0; i < samples; ++i, data += 3)
   {
-    int s = (data[1] << 24) | (data[2] << 16) | (data[3] << 8);
+    int s = (data[0] << 24) | (data[1] << 16) | (data[2] << 8);
     *dest++ = (float)s * INT32_SCALE;
   }
   return samples;
@@ -262,15 +304,15 @@ unsigned int CAEConvert::S32LE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapLE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapLE32(*src++) * factor;
 
   return samples;
 }
@@ -321,15 +363,15 @@ unsigned int CAEConvert::S32BE_Float(uint8_t *data, const unsigned int samples,
   /* do this in groups of 4 to give the compiler a better chance of optimizing this */
   for (float *end = dest + (samples & ~0x3); dest < end;)
   {
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
   }
 
   /* process any remaining samples */
   for (float *end = dest + (samples & 0x3); dest < end;)
-    *dest++ = (float)Endian_SwapBE32(*src++) * factor;
+    *dest++ = (float)(int32_t)Endian_SwapBE32(*src++) * factor;
 
   return samples;
 }
@@ -383,134 +425,16 @@ unsigned int CAEConvert::DOUBLE_Float(uint8_t *data, const unsigned int samples,
 
 unsigned int CAEConvert::Float_U8(float *data, const unsigned int samples, uint8_t *dest)
 {
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT8_MAX+.5f);
-  const __m128 add = _mm_set_ps1(1.0f);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dest[0] = safeRound((data[0] + 1.0f) * ((float)INT8_MAX+.5f));
-    ++data;
-    ++dest;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4)
-  {
-    __m128 in  = _mm_mul_ps(_mm_add_ps(_mm_load_ps(data), add), mul);
-    __m64  con = _mm_cvtps_pi16(in);
-
-    int16_t temp[4];
-    memcpy(temp, &con, sizeof(temp));
-    *dest++ = (uint8_t)temp[0];
-    *dest++ = (uint8_t)temp[1];
-    *dest++ = (uint8_t)temp[2];
-    *dest++ = (uint8_t)temp[3];
-  }
-
-  if (count != even)
-  {
-    const uint32_t odd = count - even;
-    if (odd == 1)
-    {
-      _mm_empty();
-      dest[0] = safeRound((data[0] + 1.0f) * ((float)INT8_MAX+.5f));
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(_mm_add_ps(_mm_load_ps(data), add), mul);
-        __m64 con = _mm_cvtps_pi16(in);
-
-        int16_t temp[2];
-        memcpy(temp, &con, sizeof(temp));
-        dest[0] = (uint8_t)temp[0];
-        dest[1] = (uint8_t)temp[1];
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(_mm_add_ps(_mm_load_ps(data), add), mul);
-        __m64 con = _mm_cvtps_pi16(in);
-
-        int16_t temp[3];
-        memcpy(temp, &con, sizeof(temp));
-        dest[0] = (uint8_t)temp[0];
-        dest[1] = (uint8_t)temp[1];
-        dest[2] = (uint8_t)temp[2];
-      }
-    }
-  }
-  _mm_empty();
-  #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i)
     *dest++ = safeRound((*data++ + 1.0f) * ((float)INT8_MAX+.5f));
-  #endif
 
   return samples;
 }
 
 unsigned int CAEConvert::Float_S8(float *data, const unsigned int samples, uint8_t *dest)
 {
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT8_MAX+.5f);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dest[0] = safeRound(data[0] * ((float)INT8_MAX+.5f));
-    ++data;
-    ++dest;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dest += 4)
-  {
-    __m128 in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m64  con = _mm_cvtps_pi8(in);
-    memcpy(dest, &con, 4);
-  }
-
-  if (count != even)
-  {
-    const uint32_t odd = count - even;
-    if (odd == 1)
-    {
-      _mm_empty();
-      dest[0] = safeRound(data[0] * ((float)INT8_MAX+.5f));
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(_mm_load_ps(data), mul);
-        __m64 con = _mm_cvtps_pi8(in);
-        memcpy(dest, &con, 2);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(_mm_load_ps(data), mul);
-        __m64 con = _mm_cvtps_pi8(in);
-        memcpy(dest, &con, 3);
-      }
-    }
-  }
-  _mm_empty();
-  #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i)
     *dest++ = safeRound(*data++ * ((float)INT8_MAX+.5f));
-  #endif
 
   return samples;
 }
@@ -786,60 +710,8 @@ unsigned int CAEConvert::Float_S16BE(float *data, const unsigned int samples, ui
 unsigned int CAEConvert::Float_S24NE4(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-
-  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f));
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    con         = _mm_slli_epi32(con, 8);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-      dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f));
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        con       = _mm_slli_pi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        con         = _mm_slli_epi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-      }
-    }
-  }
-  _mm_empty();
-  #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i)
     *dst++ = (safeRound(*data++ * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << 8;
-  #endif
 
   return samples << 2;
 }
@@ -855,70 +727,8 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
     0;
 #endif
 
-  /* disabled as it does not currently work */
-  #if 0 && defined(__SSE__)
-  int32_t *dst = (int32_t*)dest;
-
-  const __m128 mul = _mm_set_ps1((float)INT24_MAX+.5f);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
-    ++dest;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < count; i += 4, data += 4, dest += 12)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    con         = _mm_slli_epi32(con, 8);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 6)) = (dst[2] & 0xFFFFFF) << leftShift;
-    *((uint32_t*)(dest + 9)) = (dst[3] & 0xFFFFFF) << leftShift;
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-      dst[0] = safeRound(data[0] * ((float)INT24_MAX+.5f)) & 0xFFFFFF;
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        con       = _mm_slli_pi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        con         = _mm_slli_epi32(con, 8);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        *((uint32_t*)(dest + 0)) = (dst[0] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 3)) = (dst[1] & 0xFFFFFF) << leftShift;
-        *((uint32_t*)(dest + 6)) = (dst[2] & 0xFFFFFF) << leftShift;
-      }
-    }
-  }
-  _mm_empty();
-  #else /* no SSE */
   for (uint32_t i = 0; i < samples; ++i, ++data, dest += 3)
     *((uint32_t*)(dest)) = (safeRound(*data * ((float)INT24_MAX+.5f)) & 0xFFFFFF) << leftShift;
-  #endif
 
   return samples * 3;
 }
@@ -926,73 +736,11 @@ unsigned int CAEConvert::Float_S24NE3(float *data, const unsigned int samples, u
 unsigned int CAEConvert::Float_S32LE(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * (float)INT32_MAX);
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    dst[0] = Endian_SwapLE32(dst[0]);
-    dst[1] = Endian_SwapLE32(dst[1]);
-    dst[2] = Endian_SwapLE32(dst[2]);
-    dst[3] = Endian_SwapLE32(dst[3]);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-    {
-      dst[0] = safeRound(data[0] * (float)INT32_MAX);
-      dst[0] = Endian_SwapLE32(dst[0]);
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        dst[0] = Endian_SwapLE32(dst[0]);
-        dst[1] = Endian_SwapLE32(dst[1]);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        dst[0] = Endian_SwapLE32(dst[0]);
-        dst[1] = Endian_SwapLE32(dst[1]);
-        dst[2] = Endian_SwapLE32(dst[2]);
-      }
-    }
-  }
-  _mm_empty();
-  #else
-
-  /* no SIMD */
   for (uint32_t i = 0; i < samples; ++i, ++data, ++dst)
   {
     dst[0] = safeRound(data[0] * (float)INT32_MAX);
     dst[0] = Endian_SwapLE32(dst[0]);
   }
-  #endif
   return samples << 2;
 }
 
@@ -1035,72 +783,11 @@ unsigned int CAEConvert::Float_S32LE_Neon(float *data, const unsigned int sample
 unsigned int CAEConvert::Float_S32BE(float *data, const unsigned int samples, uint8_t *dest)
 {
   int32_t *dst = (int32_t*)dest;
-  #ifdef __SSE__
-  const __m128 mul = _mm_set_ps1((float)INT32_MAX);
-  unsigned int count = samples;
-
-  /* work around invalid alignment */
-  while ((((uintptr_t)data & 0xF) || ((uintptr_t)dest & 0xF)) && count > 0)
-  {
-    dst[0] = safeRound(data[0] * (float)INT32_MAX);
-    ++data;
-    ++dst;
-    --count;
-  }
-
-  const uint32_t even = count & ~0x3;
-  for (uint32_t i = 0; i < even; i += 4, data += 4, dst += 4)
-  {
-    __m128  in  = _mm_mul_ps(_mm_load_ps(data), mul);
-    __m128i con = _mm_cvtps_epi32(in);
-    memcpy(dst, &con, sizeof(int32_t) * 4);
-    dst[0] = Endian_SwapBE32(dst[0]);
-    dst[1] = Endian_SwapBE32(dst[1]);
-    dst[2] = Endian_SwapBE32(dst[2]);
-    dst[3] = Endian_SwapBE32(dst[3]);
-  }
-
-  if (samples != even)
-  {
-    const uint32_t odd = samples - even;
-    if (odd == 1)
-    {
-      dst[0] = safeRound(data[0] * (float)INT32_MAX);
-      dst[0] = Endian_SwapBE32(dst[0]);
-    }
-    else
-    {
-      __m128 in;
-      if (odd == 2)
-      {
-        in = _mm_setr_ps(data[0], data[1], 0, 0);
-        in = _mm_mul_ps(in, mul);
-        __m64 con = _mm_cvtps_pi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 2);
-        dst[0] = Endian_SwapBE32(dst[0]);
-        dst[1] = Endian_SwapBE32(dst[1]);
-      }
-      else
-      {
-        in = _mm_setr_ps(data[0], data[1], data[2], 0);
-        in = _mm_mul_ps(in, mul);
-        __m128i con = _mm_cvtps_epi32(in);
-        memcpy(dst, &con, sizeof(int32_t) * 3);
-        dst[0] = Endian_SwapBE32(dst[0]);
-        dst[1] = Endian_SwapBE32(dst[1]);
-        dst[2] = Endian_SwapBE32(dst[2]);
-      }
-    }
-  }
-  _mm_empty();
-  #else
-  /* no SIMD */
   for (uint32_t i = 0; i < samples; ++i, ++data, ++dst)
   {
     dst[0] = safeRound(data[0] * (float)INT32_MAX);
     dst[0] = Endian_SwapBE32(dst[0]);
   }
-  #endif
 
   return samples << 2;
 }
@@ -1149,3 +836,315 @@ unsigned int CAEConvert::Float_DOUBLE(float *data, const unsigned int samples, u
   return samples * sizeof(double);
 }
 
+
+#if defined(__SSE2__)
+/*
+  The SSE2 conversions below produce exactly the same output as the plain C
+  versions above, any change to one must be reflected in the other.
+*/
+
+/* swap the bytes of each 16 bit lane */
+static inline __m128i SwapBytes16_SSE2(__m128i v)
+{
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+/* swap the bytes of each 32 bit lane */
+static inline __m128i SwapBytes32_SSE2(__m128i v)
+{
+  v = SwapBytes16_SSE2(v);
+  return _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));
+}
+
+/*
+  round the same way as safeRound does. cvtps rounds halfway cases to even
+  so correct the result where MathUtils::round_int rounds differently, and
+  clamp positive overflow to INT_MAX as cvtps returns INT_MIN for it.
+*/
+static inline __m128i SafeRound_SSE2(__m128 f)
+{
+  const __m128 positive = _mm_cmpgt_ps(f, _mm_setzero_ps());
+  __m128i r = _mm_cvtps_epi32(f);
+  __m128  e = _mm_sub_ps(f, _mm_cvtepi32_ps(r));
+  __m128 up = _mm_or_ps(
+    _mm_and_ps   (positive, _mm_cmpeq_ps(e, _mm_set1_ps(0.5f))),
+    _mm_andnot_ps(positive, _mm_cmpgt_ps(e, _mm_set1_ps(0.4999999f))));
+  r = _mm_sub_epi32(r, _mm_castps_si128(up));
+  return _mm_xor_si128(r, _mm_castps_si128(_mm_cmpge_ps(f, _mm_set1_ps(2147483648.0f))));
+}
+
+/* convert 16 values to bytes keeping the low 8 bits of each, like a cast to uint8_t */
+static inline __m128i PackBytes_SSE2(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  __m128i lo = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+  __m128i hi = _mm_packs_epi32(_mm_and_si128(c, mask), _mm_and_si128(d, mask));
+  return _mm_packus_epi16(lo, hi);
+}
+
+/* load 4 packed 24 bit samples into the upper 3 bytes of each 32 bit lane, in memory order */
+static inline __m128i Load24_SSE2(const uint8_t *data)
+{
+  int32_t tail;
+  memcpy(&tail, data + 8, sizeof(tail));
+  __m128i in = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)data), _mm_cvtsi32_si128(tail));
+  return _mm_unpacklo_epi64(
+    _mm_unpacklo_epi32(in                   , _mm_srli_si128(in, 3)),
+    _mm_unpacklo_epi32(_mm_srli_si128(in, 6), _mm_srli_si128(in, 9)));
+}
+
+unsigned int CAEConvert::U8_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128  mul  = _mm_set1_ps(2.0f / UINT8_MAX);
+  const __m128  sub  = _mm_set1_ps(1.0f);
+  const __m128i zero = _mm_setzero_si128();
+
+  unsigned int i = 0;
+  for (; i + 16 <= samples; i += 16, data += 16, dest += 16)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)data);
+    __m128i lo = _mm_unpacklo_epi8(in, zero);
+    __m128i hi = _mm_unpackhi_epi8(in, zero);
+    _mm_storeu_ps(dest +  0, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), mul), sub));
+    _mm_storeu_ps(dest +  4, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), mul), sub));
+    _mm_storeu_ps(dest +  8, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), mul), sub));
+    _mm_storeu_ps(dest + 12, _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), mul), sub));
+  }
+
+  U8_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S8_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(1.0f / (INT8_MAX + 0.5f));
+
+  unsigned int i = 0;
+  for (; i + 16 <= samples; i += 16, data += 16, dest += 16)
+  {
+    /* sign extend by moving each byte to the top of its lane and shifting back down */
+    __m128i in = _mm_loadu_si128((const __m128i*)data);
+    __m128i lo = _mm_unpacklo_epi8(in, in);
+    __m128i hi = _mm_unpackhi_epi8(in, in);
+    _mm_storeu_ps(dest +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24)), mul));
+    _mm_storeu_ps(dest +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24)), mul));
+    _mm_storeu_ps(dest +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24)), mul));
+    _mm_storeu_ps(dest + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24)), mul));
+  }
+
+  S8_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S16LE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(1.0f / (INT16_MAX + 0.5f));
+
+  unsigned int i = 0;
+  for (; i + 8 <= samples; i += 8, data += 16, dest += 8)
+  {
+    __m128i in = _mm_loadu_si128((const __m128i*)data);
+    _mm_storeu_ps(dest + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16)), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16)), mul));
+  }
+
+  S16LE_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S16BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(1.0f / (INT16_MAX + 0.5f));
+
+  unsigned int i = 0;
+  for (; i + 8 <= samples; i += 8, data += 16, dest += 8)
+  {
+    __m128i in = SwapBytes16_SSE2(_mm_loadu_si128((const __m128i*)data));
+    _mm_storeu_ps(dest + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16)), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16)), mul));
+  }
+
+  S16BE_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(INT32_SCALE);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_slli_epi32(_mm_loadu_si128((const __m128i*)data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24LE4_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128  mul  = _mm_set1_ps(INT32_SCALE);
+  const __m128i mask = _mm_set1_epi32(0xFFFFFF00);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 16, dest += 4)
+  {
+    __m128i in = _mm_and_si128(SwapBytes32_SSE2(_mm_loadu_si128((const __m128i*)data)), mask);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24BE4_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24LE3_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(INT32_SCALE);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 12, dest += 4)
+  {
+    __m128i in = _mm_slli_epi32(Load24_SSE2(data), 8);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24LE3_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S24BE3_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128  mul  = _mm_set1_ps(INT32_SCALE);
+  const __m128i mask = _mm_set1_epi32(0xFFFFFF00);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 12, dest += 4)
+  {
+    __m128i in = _mm_and_si128(SwapBytes32_SSE2(Load24_SSE2(data)), mask);
+    _mm_storeu_ps(dest, _mm_mul_ps(_mm_cvtepi32_ps(in), mul));
+  }
+
+  S24BE3_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::S32BE_Float_SSE2(uint8_t *data, const unsigned int samples, float *dest)
+{
+  const __m128 mul = _mm_set1_ps(1.0f / (float)INT32_MAX);
+
+  unsigned int i = 0;
+  for (; i + 8 <= samples; i += 8, data += 32, dest += 8)
+  {
+    __m128i in0 = SwapBytes32_SSE2(_mm_loadu_si128((const __m128i*)(data +  0)));
+    __m128i in1 = SwapBytes32_SSE2(_mm_loadu_si128((const __m128i*)(data + 16)));
+    _mm_storeu_ps(dest + 0, _mm_mul_ps(_mm_cvtepi32_ps(in0), mul));
+    _mm_storeu_ps(dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(in1), mul));
+  }
+
+  S32BE_Float(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_U8_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set1_ps((float)INT8_MAX+.5f);
+  const __m128 add = _mm_set1_ps(1.0f);
+
+  unsigned int i = 0;
+  for (; i + 16 <= samples; i += 16, data += 16, dest += 16)
+  {
+    __m128i a = SafeRound_SSE2(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data +  0), add), mul));
+    __m128i b = SafeRound_SSE2(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data +  4), add), mul));
+    __m128i c = SafeRound_SSE2(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data +  8), add), mul));
+    __m128i d = SafeRound_SSE2(_mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data + 12), add), mul));
+    _mm_storeu_si128((__m128i*)dest, PackBytes_SSE2(a, b, c, d));
+  }
+
+  Float_U8(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_S8_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set1_ps((float)INT8_MAX+.5f);
+
+  unsigned int i = 0;
+  for (; i + 16 <= samples; i += 16, data += 16, dest += 16)
+  {
+    __m128i a = SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data +  0), mul));
+    __m128i b = SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data +  4), mul));
+    __m128i c = SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data +  8), mul));
+    __m128i d = SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data + 12), mul));
+    _mm_storeu_si128((__m128i*)dest, PackBytes_SSE2(a, b, c, d));
+  }
+
+  Float_S8(data, samples - i, dest);
+  return samples;
+}
+
+unsigned int CAEConvert::Float_S24NE4_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set1_ps((float)INT24_MAX+.5f);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 4, dest += 16)
+  {
+    __m128i out = _mm_slli_epi32(SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul)), 8);
+    _mm_storeu_si128((__m128i*)dest, out);
+  }
+
+  Float_S24NE4(data, samples - i, dest);
+  return samples << 2;
+}
+
+unsigned int CAEConvert::Float_S24NE3_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  /* x86 is always little endian, so there is no shift to apply here */
+  const __m128  mul    = _mm_set1_ps((float)INT24_MAX+.5f);
+  const __m128i evens  = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+  const __m128i odds   = _mm_set_epi32(0xFFFFFF, 0, 0xFFFFFF, 0);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 4, dest += 12)
+  {
+    __m128i in = SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul));
+
+    /* pack each pair of samples into the low 6 bytes of its 64 bit half, then join the halves */
+    in = _mm_or_si128(_mm_and_si128(in, evens), _mm_srli_epi64(_mm_and_si128(in, odds), 8));
+    in = _mm_or_si128(_mm_move_epi64(in), _mm_slli_si128(_mm_srli_si128(in, 8), 6));
+
+    int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(in, 8));
+    _mm_storel_epi64((__m128i*)dest, in);
+    memcpy(dest + 8, &tail, sizeof(tail));
+  }
+
+  Float_S24NE3(data, samples - i, dest);
+  return samples * 3;
+}
+
+unsigned int CAEConvert::Float_S32LE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set1_ps((float)INT32_MAX);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 4, dest += 16)
+    _mm_storeu_si128((__m128i*)dest, SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul)));
+
+  Float_S32LE(data, samples - i, dest);
+  return samples << 2;
+}
+
+unsigned int CAEConvert::Float_S32BE_SSE2(float *data, const unsigned int samples, uint8_t *dest)
+{
+  const __m128 mul = _mm_set1_ps((float)INT32_MAX);
+
+  unsigned int i = 0;
+  for (; i + 4 <= samples; i += 4, data += 4, dest += 16)
+    _mm_storeu_si128((__m128i*)dest, SwapBytes32_SSE2(SafeRound_SSE2(_mm_mul_ps(_mm_loadu_ps(data), mul))));
+
+  Float_S32BE(data, samples - i, dest);
+  return samples << 2;
+}
+#endif /* defined(__SSE2__) */
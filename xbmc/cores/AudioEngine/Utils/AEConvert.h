@@ -24,6 +24,9 @@
 #include "../AEAudioFormat.h"
 
 class CAEConvert{
+  /* gives the unit tests and the benchmark each version of a conversion */
+  friend class CAEConvertKernels;
+
 private:
   static unsigned int U8_Float    (uint8_t *data, const unsigned int samples, float   *dest);
   static unsigned int S8_Float    (uint8_t *data, const unsigned int samples, float   *dest);
@@ -52,6 +55,22 @@ private:
   static unsigned int Float_S32LE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
   static unsigned int Float_S32BE_Neon (float   *data, const unsigned int samples, uint8_t *dest);
 
+  static unsigned int U8_Float_SSE2    (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S8_Float_SSE2    (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16LE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S16BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24BE4_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24LE3_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S24BE3_Float_SSE2(uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int S32BE_Float_SSE2 (uint8_t *data, const unsigned int samples, float   *dest);
+  static unsigned int Float_U8_SSE2    (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S8_SSE2    (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S24NE4_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S24NE3_SSE2(float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S32LE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+  static unsigned int Float_S32BE_SSE2 (float   *data, const unsigned int samples, uint8_t *dest);
+
 public:
   typedef unsigned int (*AEConvertToFn)(uint8_t *data, const unsigned int samples, float   *dest);
   typedef unsigned int (*AEConvertFrFn)(float   *data, const unsigned int samples, uint8_t *dest);
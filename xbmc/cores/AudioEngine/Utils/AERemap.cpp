@@ -19,8 +19,13 @@
  *
  */
 #include <math.h>
+#include <string.h>
 #include <sstream>
 
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
 #include "AERemap.h"
 #include "AEFactory.h"
 #include "AEUtil.h"
@@ -87,7 +92,10 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
 
   /* the final stage does not need any down/upmix */
   if (finalStage)
+  {
+    CompileMatrix();
     return true;
+  }
 
   /* downmix from the specified channel to the specified list of channels */
   #define RM(from, ...) \
@@ -239,6 +247,7 @@ bool CAERemap::Initialize(CAEChannelInfo input, CAEChannelInfo output, bool fina
   CLog::Log(LOGINFO, "====================\n");
 #endif
 
+  CompileMatrix();
   return true;
 }
 
@@ -279,86 +288,174 @@ void CAERemap::ResolveMix(const AEChannel from, CAEChannelInfo to)
   fromInfo->in_src   = false;
 }
 
-/* This method has unrolled loop for higher performance */
-void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+void CAERemap::CompileMatrix()
 {
-  const unsigned int frameBlocks = frames & ~0x3;
+  bool identity = (m_inChannels == m_outChannels);
+  bool reorder  = true;
 
   for (int o = 0; o < m_outChannels; ++o)
   {
     const AEMixInfo *info = &m_mixInfo[m_output[o]];
+    m_mixCount[o] = 0;
+    m_mixCopy [o] = false;
+
     if (!info->in_dst)
     {
-      unsigned int f = 0;
-      unsigned int odx = 0;
-      for(; f < frameBlocks; f += 4)
-      {
-        out[odx + o] = 0.0f, odx += m_outChannels;
-        out[odx + o] = 0.0f, odx += m_outChannels;
-        out[odx + o] = 0.0f, odx += m_outChannels;
-        out[odx + o] = 0.0f, odx += m_outChannels;
-      }
-
-      switch (frames & 0x3)
-      {
-        case 3: out[odx + o] = 0.0f, odx += m_outChannels;
-        case 2: out[odx + o] = 0.0f, odx += m_outChannels;
-        case 1: out[odx + o] = 0.0f;
-      }
+      identity = false;
       continue;
     }
 
     /* if there is only 1 source, just copy it so we dont break DPL */
     if (info->srcCount == 1)
     {
-      unsigned int f = 0;
-      unsigned int idx = 0;
-      unsigned int odx = 0;
-      unsigned int srcIndex = info->srcIndex[0].index;
-      /* the compiler has a better chance of optimizing this if it is done in parallel */
-      for (; f < frameBlocks; f += 4)
-      {
-        out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-        out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-        out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-        out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-      }
+      m_mixIndex[o][0] = info->srcIndex[0].index;
+      m_mixLevel[o][0] = 1.0f;
+      m_mixCount[o]    = 1;
+      m_mixCopy [o]    = true;
+      if (info->srcIndex[0].index != o)
+        identity = false;
+      continue;
+    }
+
+    identity = false;
+    if (info->srcCount > 0)
+      reorder = false;
+
+    /* sources with a zero level do not contribute anything */
+    for (int i = 0; i < info->srcCount; ++i)
+    {
+      if (info->srcIndex[i].level == 0.0f)
+        continue;
+      m_mixIndex[o][m_mixCount[o]] = info->srcIndex[i].index;
+      m_mixLevel[o][m_mixCount[o]] = info->srcIndex[i].level;
+      ++m_mixCount[o];
+    }
+  }
+
+  if (identity)
+    m_mode = AE_REMAP_COPY;
+  else if (reorder)
+    m_mode = AE_REMAP_REORDER;
+  else
+    m_mode = AE_REMAP_MIX;
+}
+
+void CAERemap::Remap(float * const in, float * const out, const unsigned int frames) const
+{
+  switch (m_mode)
+  {
+    case AE_REMAP_COPY:
+      memcpy(out, in, frames * m_outChannels * sizeof(float));
+      break;
+
+    case AE_REMAP_REORDER:
+    {
+      const float *src = in;
+      float       *dst = out;
+      for (unsigned int f = 0; f < frames; ++f, src += m_inChannels, dst += m_outChannels)
+        for (int o = 0; o < m_outChannels; ++o)
+          dst[o] = m_mixCount[o] ? src[m_mixIndex[o][0]] : 0.0f;
+      break;
+    }
+
+    case AE_REMAP_MIX:
+      Mix(in, out, frames);
+      break;
+  }
+}
 
-      switch (frames & 0x3)
+/*
+  Each output sample is the sum of its sources in matrix order starting from
+  zero, the SSE path computes four frames at a time in exactly the same order
+  so both paths give identical results.
+*/
+void CAERemap::Mix(const float *in, float *out, const unsigned int frames) const
+{
+  unsigned int f = 0;
+
+#ifdef __SSE__
+  for (; f + 4 <= frames; f += 4, in += m_inChannels * 4, out += m_outChannels * 4)
+  {
+    /* deinterleave the block into one vector of four frames per input channel */
+    __m128 ch[AE_CH_MAX];
+    if ((m_inChannels & 0x3) == 0)
+    {
+      for (int c = 0; c < m_inChannels; c += 4)
       {
-        case 3: out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-        case 2: out[odx + o] = in[idx + srcIndex], idx += m_inChannels, odx += m_outChannels;
-        case 1: out[odx + o] = in[idx + srcIndex];
+        ch[c + 0] = _mm_loadu_ps(in + c);
+        ch[c + 1] = _mm_loadu_ps(in + c + m_inChannels);
+        ch[c + 2] = _mm_loadu_ps(in + c + m_inChannels * 2);
+        ch[c + 3] = _mm_loadu_ps(in + c + m_inChannels * 3);
+        _MM_TRANSPOSE4_PS(ch[c + 0], ch[c + 1], ch[c + 2], ch[c + 3]);
       }
     }
     else
     {
-      for (unsigned int f = 0; f < frames; ++f)
+      for (int c = 0; c < m_inChannels; ++c)
+        ch[c] = _mm_setr_ps(in[c], in[c + m_inChannels], in[c + m_inChannels * 2], in[c + m_inChannels * 3]);
+    }
+
+    __m128 mix[AE_CH_MAX];
+    for (int o = 0; o < m_outChannels; ++o)
+    {
+      if (m_mixCopy[o])
       {
-        float *outOffset = out + (f * m_outChannels) + o;
-        float *inOffset  = in  + (f * m_inChannels);
-        *outOffset = 0.0f;
+        mix[o] = ch[m_mixIndex[o][0]];
+        continue;
+      }
 
-        int blocks = info->srcCount & ~0x3;
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < m_mixCount[o]; ++i)
+        sum = _mm_add_ps(sum, _mm_mul_ps(ch[m_mixIndex[o][i]], _mm_set1_ps(m_mixLevel[o][i])));
+      mix[o] = sum;
+    }
 
-        /* the compiler has a better chance of optimizing this if it is done in parallel */
-        int i = 0;
-        for (; i < blocks; i += 4)
-        {
-          *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-          *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-          *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-          *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-        }
+    /* and interleave the result again */
+    if (m_outChannels == 2)
+    {
+      _mm_storeu_ps(out    , _mm_unpacklo_ps(mix[0], mix[1]));
+      _mm_storeu_ps(out + 4, _mm_unpackhi_ps(mix[0], mix[1]));
+    }
+    else if ((m_outChannels & 0x3) == 0)
+    {
+      for (int o = 0; o < m_outChannels; o += 4)
+      {
+        _MM_TRANSPOSE4_PS(mix[o + 0], mix[o + 1], mix[o + 2], mix[o + 3]);
+        _mm_storeu_ps(out + o                     , mix[o + 0]);
+        _mm_storeu_ps(out + o + m_outChannels     , mix[o + 1]);
+        _mm_storeu_ps(out + o + m_outChannels * 2 , mix[o + 2]);
+        _mm_storeu_ps(out + o + m_outChannels * 3 , mix[o + 3]);
+      }
+    }
+    else
+    {
+      MEMALIGN(16, float block[4]);
+      for (int o = 0; o < m_outChannels; ++o)
+      {
+        _mm_store_ps(block, mix[o]);
+        out[o                    ] = block[0];
+        out[o + m_outChannels    ] = block[1];
+        out[o + m_outChannels * 2] = block[2];
+        out[o + m_outChannels * 3] = block[3];
+      }
+    }
+  }
+#endif
 
-        /* unrolled loop for higher performance */
-        switch (info->srcCount & 0x3)
-        {
-          case 3: *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-          case 2: *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level, i++;
-          case 1: *outOffset += inOffset[info->srcIndex[i].index] * info->srcIndex[i].level;
-        }
+  for (; f < frames; ++f, in += m_inChannels, out += m_outChannels)
+  {
+    for (int o = 0; o < m_outChannels; ++o)
+    {
+      if (m_mixCopy[o])
+      {
+        out[o] = in[m_mixIndex[o][0]];
+        continue;
       }
+
+      float sum = 0.0f;
+      for (int i = 0; i < m_mixCount[o]; ++i)
+        sum += in[m_mixIndex[o][i]] * m_mixLevel[o][i];
+      out[o] = sum;
     }
   }
 }
@@ -45,12 +45,28 @@ private:
     int               cpyCount; /* the number of times the channel has been cloned */
   } AEMixInfo;
 
+  /* how Remap processes the frames, decided once the matrix is known */
+  enum AERemapMode {
+    AE_REMAP_COPY,    /* input and output are identical */
+    AE_REMAP_REORDER, /* every output is a single input channel or silent */
+    AE_REMAP_MIX      /* at least one output mixes several input channels */
+  };
+
   AEMixInfo      m_mixInfo[AE_CH_MAX+1];
   CAEChannelInfo m_output;
   int            m_inChannels;
   int            m_outChannels;
 
+  /* the matrix flattened per output channel, without the silent sources */
+  AERemapMode    m_mode;
+  int            m_mixCount[AE_CH_MAX];
+  bool           m_mixCopy [AE_CH_MAX]; /* single source, copied as is */
+  int            m_mixIndex[AE_CH_MAX][AE_CH_MAX];
+  float          m_mixLevel[AE_CH_MAX][AE_CH_MAX];
+
   void ResolveMix(const AEChannel from, CAEChannelInfo to);
   void BuildUpmixMatrix(const CAEChannelInfo& input, const CAEChannelInfo& output);
+  void CompileMatrix();
+  void Mix(const float *in, float *out, const unsigned int frames) const;
 };
 
@@ -0,0 +1,92 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "cores/AudioEngine/Utils/AEConvert.h"
+
+#include <vector>
+
+struct AEConvertToKernel
+{
+  const char*               name;
+  enum AEDataFormat         format;
+  unsigned int              bytes;     // bytes per input sample
+  CAEConvert::AEConvertToFn reference; // the plain C version
+  CAEConvert::AEConvertToFn simd;      // NULL if there is no SIMD version
+};
+
+struct AEConvertFrKernel
+{
+  const char*               name;
+  enum AEDataFormat         format;
+  unsigned int              bytes;     // bytes per output sample
+  CAEConvert::AEConvertFrFn reference;
+  CAEConvert::AEConvertFrFn simd;
+};
+
+#if defined(__SSE2__)
+  #define AE_SIMD(fn) &CAEConvert::fn##_SSE2
+#else
+  #define AE_SIMD(fn) NULL
+#endif
+
+// every conversion that has a plain C version, little endian hosts only
+class CAEConvertKernels
+{
+public:
+  static std::vector<AEConvertToKernel> ToFloat()
+  {
+    const AEConvertToKernel kernels[] =
+    {
+      { "U8"    , AE_FMT_U8    , 1, &CAEConvert::U8_Float    , AE_SIMD(U8_Float)     },
+      { "S8"    , AE_FMT_S8    , 1, &CAEConvert::S8_Float    , AE_SIMD(S8_Float)     },
+      { "S16LE" , AE_FMT_S16LE , 2, &CAEConvert::S16LE_Float , AE_SIMD(S16LE_Float)  },
+      { "S16BE" , AE_FMT_S16BE , 2, &CAEConvert::S16BE_Float , AE_SIMD(S16BE_Float)  },
+      { "S24LE4", AE_FMT_S24LE4, 4, &CAEConvert::S24LE4_Float, AE_SIMD(S24LE4_Float) },
+      { "S24BE4", AE_FMT_S24BE4, 4, &CAEConvert::S24BE4_Float, AE_SIMD(S24BE4_Float) },
+      { "S24LE3", AE_FMT_S24LE3, 3, &CAEConvert::S24LE3_Float, AE_SIMD(S24LE3_Float) },
+      { "S24BE3", AE_FMT_S24BE3, 3, &CAEConvert::S24BE3_Float, AE_SIMD(S24BE3_Float) },
+      { "S32LE" , AE_FMT_S32LE , 4, &CAEConvert::S32LE_Float , NULL                  },
+      { "S32BE" , AE_FMT_S32BE , 4, &CAEConvert::S32BE_Float , AE_SIMD(S32BE_Float)  },
+      { "DOUBLE", AE_FMT_DOUBLE, 8, &CAEConvert::DOUBLE_Float, NULL                  }
+    };
+    return std::vector<AEConvertToKernel>(kernels, kernels + sizeof(kernels) / sizeof(kernels[0]));
+  }
+
+  // the dithered S16 conversions are left out, their output is random
+  static std::vector<AEConvertFrKernel> FrFloat()
+  {
+    const AEConvertFrKernel kernels[] =
+    {
+      { "U8"    , AE_FMT_U8    , 1, &CAEConvert::Float_U8    , AE_SIMD(Float_U8)     },
+      { "S8"    , AE_FMT_S8    , 1, &CAEConvert::Float_S8    , AE_SIMD(Float_S8)     },
+      { "S24NE4", AE_FMT_S24NE4, 4, &CAEConvert::Float_S24NE4, AE_SIMD(Float_S24NE4) },
+      { "S24NE3", AE_FMT_S24NE3, 3, &CAEConvert::Float_S24NE3, AE_SIMD(Float_S24NE3) },
+      { "S32LE" , AE_FMT_S32LE , 4, &CAEConvert::Float_S32LE , AE_SIMD(Float_S32LE)  },
+      { "S32BE" , AE_FMT_S32BE , 4, &CAEConvert::Float_S32BE , AE_SIMD(Float_S32BE)  },
+      { "DOUBLE", AE_FMT_DOUBLE, 8, &CAEConvert::Float_DOUBLE, NULL                  }
+    };
+    return std::vector<AEConvertFrKernel>(kernels, kernels + sizeof(kernels) / sizeof(kernels[0]));
+  }
+};
+
+#undef AE_SIMD
@@ -0,0 +1,130 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Reports the throughput of every sample format conversion, for the plain C
+ * version, the SIMD version and the one ToFloat/FrFloat select at runtime.
+ *
+ * usage: benchConvert [samples per call] [seconds per conversion]
+ */
+
+#include "AEConvertKernels.h"
+#include "TestHelpers.h"
+#include "utils/TimeUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+static unsigned int g_samples = 4096;
+static double       g_seconds = 0.5;
+
+static double Now()
+{
+  return (double)CurrentHostCounter() / (double)CurrentHostFrequency();
+}
+
+// million samples per second, 0 if there is no such conversion
+static double BenchToFloat(CAEConvert::AEConvertToFn fn, std::vector<uint8_t>& in, std::vector<float>& out)
+{
+  if (!fn)
+    return 0.0;
+
+  uint64_t samples = 0;
+  double   start   = Now();
+  double   elapsed;
+  do
+  {
+    for (int i = 0; i < 64; i++)
+      samples += fn(&in[0], g_samples, &out[0]);
+    elapsed = Now() - start;
+  } while (elapsed < g_seconds);
+
+  return samples / elapsed / 1e6;
+}
+
+static double BenchFrFloat(CAEConvert::AEConvertFrFn fn, unsigned int bytes, std::vector<float>& in, std::vector<uint8_t>& out)
+{
+  if (!fn)
+    return 0.0;
+
+  uint64_t samples = 0;
+  double   start   = Now();
+  double   elapsed;
+  do
+  {
+    for (int i = 0; i < 64; i++)
+      samples += fn(&in[0], g_samples, &out[0]) / bytes;
+    elapsed = Now() - start;
+  } while (elapsed < g_seconds);
+
+  return samples / elapsed / 1e6;
+}
+
+static void PrintResult(const char *direction, const char *name, double reference, double simd, double selected)
+{
+  if (simd > 0.0)
+    printf("%-10s %-7s %10.1f %10.1f %10.1f %7.2fx\n", direction, name, reference, simd, selected, simd / reference);
+  else
+    printf("%-10s %-7s %10.1f %10s %10.1f\n", direction, name, reference, "-", selected);
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1)
+    g_samples = std::max(1, atoi(argv[1]));
+  if (argc > 2)
+    g_seconds = std::max(0.01, atof(argv[2]));
+
+  CTestRandom random;
+  std::vector<uint8_t> raw(g_samples * sizeof(double) + 16);
+  std::vector<float>   floats(g_samples + 16);
+  for (size_t i = 0; i < raw.size(); i++)
+    raw[i] = (uint8_t)(random.Next() >> 24);
+  for (size_t i = 0; i < floats.size(); i++)
+    floats[i] = random.NextFloat(-1.0f, 1.0f);
+
+  printf("%u samples per call, million samples per second\n", g_samples);
+  printf("%-10s %-7s %10s %10s %10s %8s\n", "", "format", "plain C", "SIMD", "selected", "speedup");
+
+  std::vector<AEConvertToKernel> to = CAEConvertKernels::ToFloat();
+  for (size_t k = 0; k < to.size(); k++)
+  {
+    std::vector<float> out(g_samples + 16);
+    double reference = BenchToFloat(to[k].reference, raw, out);
+    double simd      = BenchToFloat(to[k].simd, raw, out);
+    double selected  = BenchToFloat(CAEConvert::ToFloat(to[k].format), raw, out);
+    PrintResult("to float", to[k].name, reference, simd, selected);
+  }
+
+  std::vector<AEConvertFrKernel> fr = CAEConvertKernels::FrFloat();
+  for (size_t k = 0; k < fr.size(); k++)
+  {
+    std::vector<uint8_t> out(g_samples * fr[k].bytes + 16);
+    double reference = BenchFrFloat(fr[k].reference, fr[k].bytes, floats, out);
+    double simd      = BenchFrFloat(fr[k].simd, fr[k].bytes, floats, out);
+    double selected  = BenchFrFloat(CAEConvert::FrFloat(fr[k].format), fr[k].bytes, floats, out);
+    PrintResult("from float", fr[k].name, reference, simd, selected);
+  }
+
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "AEConvertKernels.h"
+#include "TestHelpers.h"
+
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+#include <vector>
+
+// covers the unrolled bodies, every tail length and some odd lengths
+#define MAX_SAMPLES 67
+
+// input offsets so both aligned and unaligned buffers are used
+#define MAX_OFFSET  4
+
+// values next to the output range, on the rounding boundaries and below it
+static const float g_edgeValues[] =
+{
+   0.0f, -0.0f,
+   1.0f, -1.0f,
+   0.99999994f, -0.99999994f,       // closest to full scale
+   1.00000012f, -1.00000012f,       // just clipping
+   1.5f, -1.5f, 2.0f, -2.0f,
+   1e10f, -1e10f,
+   0.5f, -0.5f,
+   0.5f / 127.5f, -0.5f / 127.5f,   // halfway between 8 bit steps
+   0.5f / 8388607.5f, -0.5f / 8388607.5f,
+   0.5f / 2147483647.0f,
+   1e-10f, -1e-10f,
+   FLT_MIN, -FLT_MIN,
+   1e-40f, -1e-40f,                 // denormals
+   FLT_MIN / 2, -FLT_MIN / 2
+};
+
+#define EDGE_VALUES (sizeof(g_edgeValues) / sizeof(g_edgeValues[0]))
+
+// samples at the limits of the integer formats, whatever their width
+static const uint8_t g_edgeBytes[] = { 0x00, 0xFF, 0x80, 0x7F, 0x01, 0xFE };
+
+#define EDGE_BYTES (sizeof(g_edgeBytes) / sizeof(g_edgeBytes[0]))
+
+static void FillEdgeInput(std::vector<uint8_t>& in, unsigned int bytes, CTestRandom& random)
+{
+  for (size_t i = 0; i < in.size(); i += bytes)
+  {
+    // the top byte is what makes a sample the minimum or maximum, mix it with
+    // random or equally extreme lower bytes
+    uint8_t top = g_edgeBytes[random.Next() % EDGE_BYTES];
+    uint8_t low = (random.Next() & 1) ? (top & 0x80 ? 0x00 : 0xFF) : (uint8_t)random.Next();
+    for (size_t b = 0; b < bytes && i + b < in.size(); b++)
+      in[i + b] = b == 0 || b == bytes - 1 ? top : low;
+  }
+}
+
+static void FillRandomInput(std::vector<uint8_t>& in, CTestRandom& random)
+{
+  for (size_t i = 0; i < in.size(); i++)
+    in[i] = (uint8_t)(random.Next() >> 24);
+}
+
+static void FillFloatInput(std::vector<float>& in, CTestRandom& random)
+{
+  for (size_t i = 0; i < in.size(); i++)
+  {
+    switch (random.Next() % 3)
+    {
+      case 0 : in[i] = g_edgeValues[random.Next() % EDGE_VALUES]; break;
+      case 1 : in[i] = random.NextFloat(-1.0f, 1.0f); break;
+      default: in[i] = random.NextFloat(-1.2f, 1.2f); break;
+    }
+  }
+}
+
+static bool CompareToFloat(const AEConvertToKernel& kernel, std::vector<uint8_t>& in, unsigned int offset, unsigned int samples)
+{
+  // the bytes after the output must be left alone, so compare those too
+  std::vector<float> reference(samples + 16, -7.0f);
+  std::vector<float> simd     (samples + 16, -7.0f);
+
+  unsigned int referenceRet = kernel.reference(&in[offset], samples, &reference[0]);
+  unsigned int simdRet      = kernel.simd     (&in[offset], samples, &simd     [0]);
+
+  return referenceRet == simdRet &&
+         memcmp(&reference[0], &simd[0], reference.size() * sizeof(float)) == 0;
+}
+
+static bool CompareFrFloat(const AEConvertFrKernel& kernel, const std::vector<float>& in, unsigned int offset, unsigned int samples)
+{
+  // both get their own copy of the input, in case one of them clamps in place
+  std::vector<float> referenceIn(in);
+  std::vector<float> simdIn     (in);
+
+  std::vector<uint8_t> reference(samples * kernel.bytes + 16, 0xAB);
+  std::vector<uint8_t> simd     (samples * kernel.bytes + 16, 0xAB);
+
+  unsigned int referenceRet = kernel.reference(&referenceIn[offset], samples, &reference[0]);
+  unsigned int simdRet      = kernel.simd     (&simdIn     [offset], samples, &simd     [0]);
+
+  return referenceRet == simdRet &&
+         memcmp(&reference[0], &simd[0], samples * kernel.bytes) == 0;
+}
+
+TEST(AEConvertToFloatMatchesReference)
+{
+  std::vector<AEConvertToKernel> kernels = CAEConvertKernels::ToFloat();
+  CTestRandom random;
+
+  for (size_t k = 0; k < kernels.size(); k++)
+  {
+    const AEConvertToKernel& kernel = kernels[k];
+    if (!kernel.simd)
+      continue;
+
+    unsigned int mismatches = 0;
+    for (unsigned int samples = 0; samples <= MAX_SAMPLES; samples++)
+    {
+      for (unsigned int offset = 0; offset < MAX_OFFSET; offset++)
+      {
+        std::vector<uint8_t> in((samples + 1) * kernel.bytes + MAX_OFFSET);
+
+        FillEdgeInput(in, kernel.bytes, random);
+        if (!CompareToFloat(kernel, in, offset, samples))
+          mismatches++;
+
+        FillRandomInput(in, random);
+        if (!CompareToFloat(kernel, in, offset, samples))
+          mismatches++;
+      }
+    }
+
+    if (mismatches)
+      printf("%s to float: %u mismatches\n", kernel.name, mismatches);
+    CHECK_EQUAL(0u, mismatches);
+  }
+}
+
+TEST(AEConvertFrFloatMatchesReference)
+{
+  std::vector<AEConvertFrKernel> kernels = CAEConvertKernels::FrFloat();
+  CTestRandom random;
+
+  for (size_t k = 0; k < kernels.size(); k++)
+  {
+    const AEConvertFrKernel& kernel = kernels[k];
+    if (!kernel.simd)
+      continue;
+
+    unsigned int mismatches = 0;
+    for (unsigned int samples = 0; samples <= MAX_SAMPLES; samples++)
+    {
+      for (unsigned int offset = 0; offset < MAX_OFFSET; offset++)
+      {
+        std::vector<float> in(samples + MAX_OFFSET);
+        for (int pass = 0; pass < 4; pass++)
+        {
+          FillFloatInput(in, random);
+          if (!CompareFrFloat(kernel, in, offset, samples))
+            mismatches++;
+        }
+      }
+    }
+
+    // each edge value over a whole vector body, and in the tail
+    for (size_t e = 0; e < EDGE_VALUES; e++)
+    {
+      std::vector<float> in(MAX_SAMPLES, g_edgeValues[e]);
+      if (!CompareFrFloat(kernel, in, 0, MAX_SAMPLES))
+        mismatches++;
+    }
+
+    if (mismatches)
+      printf("float to %s: %u mismatches\n", kernel.name, mismatches);
+    CHECK_EQUAL(0u, mismatches);
+  }
+}
+
+TEST(AEConvertFullScale)
+{
+  // goes through the runtime selected conversions
+  float in[] = { 1.0f, -1.0f, 2.0f, -2.0f, 0.0f, 1e-40f };
+  int32_t out[6];
+
+  CAEConvert::AEConvertFrFn toS32 = CAEConvert::FrFloat(AE_FMT_S32LE);
+  CHECK(toS32 != NULL);
+  CHECK_EQUAL(sizeof(out), toS32(in, 6, (uint8_t*)out));
+  CHECK_EQUAL(INT_MAX, out[0]);
+  CHECK_EQUAL(INT_MIN, out[1]);
+  CHECK_EQUAL(INT_MAX, out[2]);
+  CHECK_EQUAL(INT_MIN, out[3]);
+  CHECK_EQUAL(0      , out[4]);
+  CHECK_EQUAL(0      , out[5]);
+
+  CAEConvert::AEConvertToFn fromS32 = CAEConvert::ToFloat(AE_FMT_S32LE);
+  float back[6];
+  CHECK(fromS32 != NULL);
+  CHECK_EQUAL(6u, fromS32((uint8_t*)out, 6, back));
+  CHECK_EQUAL( 1.0f, back[0]);
+  CHECK_EQUAL(-1.0f, back[1]);
+  CHECK_EQUAL( 0.0f, back[4]);
+
+  // S16 is scaled by 32767.5, so both limits are within a step of full scale
+  uint8_t limits[] = { 0x00, 0x80, 0xFF, 0x7F };
+  float fromS16[2];
+  CAEConvert::AEConvertToFn s16 = CAEConvert::ToFloat(AE_FMT_S16LE);
+  CHECK(s16 != NULL);
+  CHECK_EQUAL(2u, s16(limits, 2, fromS16));
+  CHECK(fromS16[0] > -1.0001f && fromS16[0] < -0.9999f);
+  CHECK(fromS16[1] >  0.9999f && fromS16[1] <= 1.0f);
+}
@@ -0,0 +1,235 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "cores/AudioEngine/Utils/AERemap.h"
+#include "TestHelpers.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#define N AE_CH_NULL
+
+// level of a channel mixed into two others
+#define HALF_POWER 0.70710678f
+
+struct RemapCase
+{
+  const char*   name;
+  AEChannel     input [9];
+  AEChannel     output[9];
+  AEStdChLayout stdChLayout; // forced output layout, AE_CH_LAYOUT_INVALID for none
+  bool          upmix;       // audiooutput.stereoupmix
+  bool          normalize;   // audiooutput.normalizelevels
+  bool          valid;       // whether Initialize can build a matrix at all
+  float         in    [9];   // one input frame
+  float         out   [9];   // the expected output frame
+};
+
+static const RemapCase g_remapCases[] =
+{
+  { "stereo to stereo",
+    { AE_CH_FL, AE_CH_FR, N },
+    { AE_CH_FL, AE_CH_FR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.25f, -0.5f },
+    { 0.25f, -0.5f } },
+
+  { "stereo swapped",
+    { AE_CH_FL, AE_CH_FR, N },
+    { AE_CH_FR, AE_CH_FL, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.25f, -0.5f },
+    { -0.5f, 0.25f } },
+
+  { "5.1 to stereo",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FL, AE_CH_FR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { 0.1f + 0.5f + (0.3f + 0.4f) * HALF_POWER,
+      0.2f + 0.6f + (0.3f + 0.4f) * HALF_POWER } },
+
+  { "5.1 to stereo normalized",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FL, AE_CH_FR, N },
+    AE_CH_LAYOUT_INVALID, false, true, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { (0.1f + 0.5f + (0.3f + 0.4f) * HALF_POWER) / (2.0f + 2.0f * HALF_POWER),
+      (0.2f + 0.6f + (0.3f + 0.4f) * HALF_POWER) / (2.0f + 2.0f * HALF_POWER) } },
+
+  { "5.1 to mono",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FC, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { 0.1f + 0.2f + 0.3f + 0.4f + 0.5f + 0.6f } },
+
+  { "stereo to 5.1",
+    { AE_CH_FL, AE_CH_FR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.2f, 0.6f },
+    { 0.2f, 0.6f, 0.0f, 0.0f, 0.0f, 0.0f } },
+
+  { "stereo to 5.1 upmixed",
+    { AE_CH_FL, AE_CH_FR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_INVALID, true, false, true,
+    { 0.2f, 0.6f },
+    { 0.2f, 0.6f, 0.4f, 0.4f, 0.2f, 0.6f } },
+
+  { "mono to stereo",
+    { AE_CH_FC, N },
+    { AE_CH_FL, AE_CH_FR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.5f },
+    { 0.5f, 0.5f } },
+
+  { "2.1 to stereo, LFE into the fronts",
+    { AE_CH_FL, AE_CH_FR, AE_CH_LFE, N },
+    { AE_CH_FL, AE_CH_FR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.4f },
+    { 0.1f + 0.4f * HALF_POWER, 0.2f + 0.4f * HALF_POWER } },
+
+  { "5.1 to 5.1 with LFE last",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_BL, AE_CH_BR, AE_CH_LFE, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { 0.1f, 0.2f, 0.3f, 0.5f, 0.6f, 0.4f } },
+
+  { "7.1 to 5.1, sides into backs and fronts",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, AE_CH_SL, AE_CH_SR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f },
+    { 0.1f + 0.7f * HALF_POWER, 0.2f + 0.8f * HALF_POWER, 0.3f, 0.4f,
+      0.5f + 0.7f * HALF_POWER, 0.6f + 0.8f * HALF_POWER } },
+
+  { "5.1 to quad, missing centre and LFE",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_INVALID, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { 0.1f + (0.3f + 0.4f) * HALF_POWER, 0.2f + (0.3f + 0.4f) * HALF_POWER, 0.5f, 0.6f } },
+
+  { "5.1 on a 5.1 device limited to stereo",
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    { AE_CH_FL, AE_CH_FR, AE_CH_FC, AE_CH_LFE, AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_2_0, false, false, true,
+    { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f },
+    { 0.1f + 0.5f + (0.3f + 0.4f) * HALF_POWER,
+      0.2f + 0.6f + (0.3f + 0.4f) * HALF_POWER, 0.0f, 0.0f, 0.0f, 0.0f } },
+
+  { "mono without speakers for the centre",
+    { AE_CH_FC, N },
+    { AE_CH_BL, AE_CH_BR, N },
+    AE_CH_LAYOUT_INVALID, false, false, false,
+    { 0.5f },
+    { } }
+};
+
+#define REMAP_CASES (sizeof(g_remapCases) / sizeof(g_remapCases[0]))
+
+static unsigned int CountChannels(const AEChannel *channels)
+{
+  unsigned int count = 0;
+  while (channels[count] != AE_CH_NULL)
+    ++count;
+  return count;
+}
+
+static bool Near(float a, float b)
+{
+  return fabs(a - b) <= 1e-5f * std::max(1.0f, (float)fabs(b));
+}
+
+TEST(AERemapMatrix)
+{
+  for (size_t c = 0; c < REMAP_CASES; c++)
+  {
+    const RemapCase& test = g_remapCases[c];
+    SetTestSetting("audiooutput.stereoupmix"   , test.upmix);
+    SetTestSetting("audiooutput.normalizelevels", test.normalize);
+
+    CAERemap remap;
+    bool valid = remap.Initialize(CAEChannelInfo(test.input), CAEChannelInfo(test.output), false, false, test.stdChLayout);
+    if (valid != test.valid)
+      printf("%s: Initialize returned %d\n", test.name, valid);
+    CHECK_EQUAL(test.valid, valid);
+    if (!valid || !test.valid)
+      continue;
+
+    unsigned int inChannels  = CountChannels(test.input);
+    unsigned int outChannels = CountChannels(test.output);
+
+    // enough frames for the vector path and every tail length, each one
+    // scaled differently so swapped frames are noticed
+    for (unsigned int frames = 1; frames <= 11; frames++)
+    {
+      std::vector<float> in (frames * inChannels);
+      std::vector<float> out(frames * outChannels + 1, -7.0f);
+      for (unsigned int f = 0; f < frames; f++)
+        for (unsigned int i = 0; i < inChannels; i++)
+          in[f * inChannels + i] = test.in[i] * (f + 1) / frames;
+
+      remap.Remap(&in[0], &out[0], frames);
+
+      unsigned int mismatches = 0;
+      for (unsigned int f = 0; f < frames; f++)
+        for (unsigned int o = 0; o < outChannels; o++)
+          if (!Near(out[f * outChannels + o], test.out[o] * (f + 1) / frames))
+          {
+            if (!mismatches)
+              printf("%s: %u frames, frame %u channel %u is %f instead of %f\n", test.name,
+                     frames, f, o, out[f * outChannels + o], test.out[o] * (f + 1) / frames);
+            mismatches++;
+          }
+
+      CHECK_EQUAL(0u, mismatches);
+      CHECK_EQUAL(-7.0f, out[frames * outChannels]);
+    }
+  }
+
+  SetTestSetting("audiooutput.stereoupmix"   , false);
+  SetTestSetting("audiooutput.normalizelevels", false);
+}
+
+TEST(AERemapFinalStage)
+{
+  // the final stage only reorders, even if channels have nowhere to go
+  AEChannel input [] = { AE_CH_FL, AE_CH_FR, AE_CH_FC, N };
+  AEChannel output[] = { AE_CH_FR, AE_CH_FL, N };
+
+  CAERemap remap;
+  CHECK(remap.Initialize(CAEChannelInfo(input), CAEChannelInfo(output), true));
+
+  float in [] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f };
+  float out[4];
+  remap.Remap(in, out, 2);
+  CHECK_EQUAL(0.2f, out[0]);
+  CHECK_EQUAL(0.1f, out[1]);
+  CHECK_EQUAL(0.5f, out[2]);
+  CHECK_EQUAL(0.4f, out[3]);
+}
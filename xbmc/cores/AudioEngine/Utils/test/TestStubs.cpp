@@ -0,0 +1,55 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * The settings the AudioEngine utilities read, the rest comes from the
+ * common stubs in test/TestStubs.cpp
+ */
+
+#include "settings/GUISettings.h"
+#include "TestHelpers.h"
+
+#include <map>
+#include <string>
+
+// boolean settings read by the code under test, false unless a test sets them
+static std::map<std::string, bool> g_testSettings;
+
+void SetTestSetting(const char *setting, bool value)
+{
+  g_testSettings[setting] = value;
+}
+
+CGUISettings::CGUISettings(void)
+{
+}
+
+CGUISettings::~CGUISettings(void)
+{
+}
+
+bool CGUISettings::GetBool(const char *strSetting) const
+{
+  std::map<std::string, bool>::const_iterator it = g_testSettings.find(strSetting);
+  return it != g_testSettings.end() && it->second;
+}
+
+CGUISettings g_guiSettings;
@@ -29,6 +29,7 @@ struct TextCacheStruct_t;
 class TiXmlElement;
 class CStreamDetails;
 class CAction;
+namespace XFILE { struct SCacheStatus; }
 
 class IPlayerCallback
 {
@@ -162,6 +163,8 @@ public:
   virtual bool IsCaching() const {return false;};
   //Cache filled in Percent
   virtual int GetCacheLevel() const {return -1;};
+  //Status of the cache the stream is read through
+  virtual bool GetCacheStatus(XFILE::SCacheStatus &status) const {return false;};
 
   virtual bool IsInMenu() const {return false;};
   virtual bool HasMenu() { return false; };
@@ -37,13 +37,122 @@ extern "C" {
 #endif
 }
 
+#include "threads/Atomics.h"
+
+#include <stddef.h>
+
+/*
+ * Packets are recycled through a pool of size classes so playback doesn't
+ * hit the heap for every packet. A pooled block holds the packet, followed by
+ * its 16 byte aligned payload. Payloads bigger than the biggest size class
+ * are allocated on their own and never pooled. The pool is emptied by the
+ * player once playback ends.
+ */
+#define POOL_MIN_PAYLOAD   512            // payload capacity of the smallest class
+#define POOL_SIZE_CLASSES  12             // up to 1 MB of payload
+#define POOL_MAX_BYTES     (16*1024*1024) // memory kept over all classes
+
+typedef struct DemuxPacketBlock
+{
+  DemuxPacketBlock* next;      // free list link
+  int               sizeClass; // -1 for blocks not from the pool
+  DemuxPacket       packet;
+} DemuxPacketBlock;
+
+#define POOL_HEADER_SIZE ((sizeof(DemuxPacketBlock) + 15) & ~15)
+
+struct DemuxPacketSizeClass
+{
+  long              lock;
+  DemuxPacketBlock* free;
+  long              count;
+};
+
+static DemuxPacketSizeClass g_packetPool[POOL_SIZE_CLASSES];
+static DemuxPacketPoolStats g_packetPoolStats;
+
+static inline int GetPayloadCapacity(int sizeClass)
+{
+  return POOL_MIN_PAYLOAD << sizeClass;
+}
+
+static inline long GetBlockSize(int sizeClass)
+{
+  return POOL_HEADER_SIZE + GetPayloadCapacity(sizeClass);
+}
+
+static int GetSizeClass(int payloadSize)
+{
+  for (int sizeClass = 0; sizeClass < POOL_SIZE_CLASSES; sizeClass++)
+  {
+    if (payloadSize <= GetPayloadCapacity(sizeClass))
+      return sizeClass;
+  }
+  return -1;
+}
+
+static DemuxPacketBlock* GetBlock(int payloadSize)
+{
+  int sizeClass = GetSizeClass(payloadSize);
+  AtomicIncrement(&g_packetPoolStats.allocations);
+
+  if (sizeClass >= 0)
+  {
+    DemuxPacketSizeClass& pool = g_packetPool[sizeClass];
+    DemuxPacketBlock* block = NULL;
+    {
+      CAtomicSpinLock lock(pool.lock);
+      block = pool.free;
+      if (block)
+      {
+        pool.free = block->next;
+        pool.count--;
+      }
+    }
+
+    if (block)
+    {
+      AtomicIncrement(&g_packetPoolStats.reused);
+      AtomicSubtract(&g_packetPoolStats.pooledBytes, GetBlockSize(sizeClass));
+      return block;
+    }
+    payloadSize = GetPayloadCapacity(sizeClass);
+  }
+
+  DemuxPacketBlock* block = (DemuxPacketBlock*)_aligned_malloc(POOL_HEADER_SIZE + payloadSize, 16);
+  if (block)
+    block->sizeClass = sizeClass;
+  return block;
+}
+
+static void PutBlock(DemuxPacketBlock* block)
+{
+  int sizeClass = block->sizeClass;
+  if (sizeClass >= 0)
+  {
+    // reserve the memory first, so the cap holds over all size classes
+    long blockSize = GetBlockSize(sizeClass);
+    if (AtomicAdd(&g_packetPoolStats.pooledBytes, blockSize) <= POOL_MAX_BYTES)
+    {
+      DemuxPacketSizeClass& pool = g_packetPool[sizeClass];
+      CAtomicSpinLock lock(pool.lock);
+      block->next = pool.free;
+      pool.free = block;
+      pool.count++;
+      return;
+    }
+    AtomicSubtract(&g_packetPoolStats.pooledBytes, blockSize);
+  }
+
+  _aligned_free(block);
+}
+
 void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 {
   if (pPacket)
   {
     try {
-      if (pPacket->pData) _aligned_free(pPacket->pData);
-      delete pPacket;
+      PutBlock((DemuxPacketBlock*)((BYTE*)pPacket - offsetof(DemuxPacketBlock, packet)));
     }
     catch(...) {
       CLog::Log(LOGERROR, "%s - Exception thrown while freeing packet", __FUNCTION__);
@@ -53,45 +162,67 @@ void CDVDDemuxUtils::FreeDemuxPacket(DemuxPacket* pPacket)
 
 DemuxPacket* CDVDDemuxUtils::AllocateDemuxPacket(int iDataSize)
 {
-  DemuxPacket* pPacket = new DemuxPacket;
-  if (!pPacket) return NULL;
+  // need to allocate a few bytes more.
+  // From avcodec.h (ffmpeg)
+  /**
+    * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
+    * this is mainly needed because some optimized bitstream readers read
+    * 32 or 64 bit at once and could read over the end<br>
+    * Note, if the first 23 bits of the additional bytes are not 0 then damaged
+    * MPEG bitstreams could cause overread and segfault
+    */
+  int iPayloadSize = iDataSize > 0 ? iDataSize + FF_INPUT_BUFFER_PADDING_SIZE : 0;
 
-  try
-  {
-    memset(pPacket, 0, sizeof(DemuxPacket));
+  DemuxPacketBlock* block = GetBlock(iPayloadSize);
+  if (!block) return NULL;
 
-    if (iDataSize > 0)
-    {
-      // need to allocate a few bytes more.
-      // From avcodec.h (ffmpeg)
-      /**
-        * Required number of additionally allocated bytes at the end of the input bitstream for decoding.
-        * this is mainly needed because some optimized bitstream readers read
-        * 32 or 64 bit at once and could read over the end<br>
-        * Note, if the first 23 bits of the additional bytes are not 0 then damaged
-        * MPEG bitstreams could cause overread and segfault
-        */
-      pPacket->pData =(BYTE*)_aligned_malloc(iDataSize + FF_INPUT_BUFFER_PADDING_SIZE, 16);
-      if (!pPacket->pData)
-      {
-        FreeDemuxPacket(pPacket);
-        return NULL;
-      }
+  DemuxPacket* pPacket = &block->packet;
+  memset(pPacket, 0, sizeof(DemuxPacket));
 
-      // reset the last 8 bytes to 0;
-      memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
-    }
+  if (iDataSize > 0)
+  {
+    pPacket->pData = (BYTE*)block + POOL_HEADER_SIZE;
 
-    // setup defaults
-    pPacket->dts       = DVD_NOPTS_VALUE;
-    pPacket->pts       = DVD_NOPTS_VALUE;
-    pPacket->iStreamId = -1;
+    // reset the last 8 bytes to 0;
+    memset(pPacket->pData + iDataSize, 0, FF_INPUT_BUFFER_PADDING_SIZE);
   }
-  catch(...)
+
+  // setup defaults
+  pPacket->dts       = DVD_NOPTS_VALUE;
+  pPacket->pts       = DVD_NOPTS_VALUE;
+  pPacket->iStreamId = -1;
+
+  return pPacket;
+}
+
+void CDVDDemuxUtils::TrimPool()
+{
+  for (int sizeClass = 0; sizeClass < POOL_SIZE_CLASSES; sizeClass++)
   {
-    CLog::Log(LOGERROR, "%s - Exception thrown", __FUNCTION__);
-    FreeDemuxPacket(pPacket);
-    pPacket = NULL;
+    DemuxPacketSizeClass& pool = g_packetPool[sizeClass];
+    DemuxPacketBlock* block;
+    long count;
+    {
+      CAtomicSpinLock lock(pool.lock);
+      block = pool.free;
+      count = pool.count;
+      pool.free  = NULL;
+      pool.count = 0;
+    }
+
+    AtomicSubtract(&g_packetPoolStats.pooledBytes, count * GetBlockSize(sizeClass));
+    while (block)
+    {
+      DemuxPacketBlock* next = block->next;
+      _aligned_free(block);
+      block = next;
+    }
   }
-  return pPacket;
+}
+
+void CDVDDemuxUtils::GetPoolStats(DemuxPacketPoolStats& stats)
+{
+  stats.allocations = g_packetPoolStats.allocations;
+  stats.reused      = g_packetPoolStats.reused;
+  stats.pooledBytes = g_packetPoolStats.pooledBytes;
 }
@@ -23,10 +23,27 @@
 
 #include "DVDDemux.h"
 
+typedef struct DemuxPacketPoolStats
+{
+  long allocations; // packets handed out
+  long reused;      // packets handed out without allocating memory
+  long pooledBytes; // memory kept around for reuse
+} DemuxPacketPoolStats;
+
 class CDVDDemuxUtils
 {
 public:
   static void FreeDemuxPacket(DemuxPacket* pPacket);
   static DemuxPacket* AllocateDemuxPacket(int iDataSize = 0);
+
+  /*!
+   \brief Free the memory kept around by the packet pool, packets in use are not affected
+   */
+  static void TrimPool();
+
+  /*!
+   \brief Get the statistics of the packet pool, counters wrap around
+   */
+  static void GetPoolStats(DemuxPacketPoolStats& stats);
 };
 
@@ -146,5 +146,5 @@ void CDVDInputStreamFile::SetReadRate(unsigned rate)
 {
   unsigned maxrate = rate + 1024 * 1024 / 8;
   if(m_pFile->IoControl(IOCTRL_CACHE_SETRATE, &maxrate) >= 0)
-    CLog::Log(LOGDEBUG, "CDVDInputStreamFile::SetReadRate - set cache throttle rate to %u bytes per second", maxrate);
+    CLog::Log(LOGDEBUG, "CDVDInputStreamFile::SetReadRate - set expected read rate to %u bytes per second", maxrate);
 }
@@ -25,10 +25,21 @@
 #include "threads/SingleLock.h"
 #include "DVDClock.h"
 #include "utils/MathUtils.h"
+#include "threads/Atomics.h"
 
 using namespace std;
 
-CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
+// number of demuxer packets that can be queued without taking the lock,
+// the list takes the rest if the consumer falls behind
+#define MSGQ_PACKET_RING_SIZE 1024
+
+// whether sequence number a was handed out before b, allowing for wrap around
+static inline bool IsBefore(long a, long b)
+{
+  return (long)((unsigned long)a - (unsigned long)b) < 0;
+}
+
+CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true), m_packets(MSGQ_PACKET_RING_SIZE)
 {
   m_owner = owner;
   m_iDataSize     = 0;
@@ -36,6 +47,9 @@ CDVDMessageQueue::CDVDMessageQueue(const string &owner) : m_hEvent(true)
   m_bInitialized  = false;
   m_bCaching      = false;
   m_bEmptied      = true;
+  m_iListSize     = 0;
+  m_iSequence     = 0;
+  m_iWaiting      = 0;
 
   m_TimeBack      = DVD_NOPTS_VALUE;
   m_TimeFront     = DVD_NOPTS_VALUE;
@@ -54,6 +68,8 @@ void CDVDMessageQueue::Init()
   m_bAbortRequest = false;
   m_bEmptied      = true;
   m_bInitialized  = true;
+
+  CSingleLock lock(m_timeSection);
   m_TimeBack      = DVD_NOPTS_VALUE;
   m_TimeFront     = DVD_NOPTS_VALUE;
 }
@@ -65,14 +81,26 @@ void CDVDMessageQueue::Flush(CDVDMsg::Message type)
   for(SList::iterator it = m_list.begin(); it != m_list.end();)
   {
     if (it->message->IsType(type) ||  type == CDVDMsg::NONE)
+    {
+      if (it->message->IsType(CDVDMsg::DEMUXER_PACKET) && it->priority == 0)
+        PacketRemoved(it->message, false);
       it = m_list.erase(it);
+      AtomicDecrement(&m_iListSize);
+    }
     else
       it++;
   }
 
   if (type == CDVDMsg::DEMUXER_PACKET ||  type == CDVDMsg::NONE)
   {
-    m_iDataSize = 0;
+    DVDMessageRingItem item;
+    while (m_packets.Pop(item))
+    {
+      PacketRemoved(item.message, false);
+      item.message->Release();
+    }
+
+    CSingleLock timeLock(m_timeSection);
     m_TimeBack  = DVD_NOPTS_VALUE;
     m_TimeFront = DVD_NOPTS_VALUE;
     m_bEmptied = true;
@@ -102,8 +130,6 @@ void CDVDMessageQueue::End()
 
 MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
 {
-  CSingleLock lock(m_section);
-
   if (!m_bInitialized)
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Put MSGQ_NOT_INITIALIZED", m_owner.c_str());
@@ -116,21 +142,15 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
     return MSGQ_INVALID_MSG;
   }
 
-  SList::iterator it = m_list.begin();
-  while(it != m_list.end())
-  {
-    if(priority <= it->priority)
-      break;
-    it++;
-  }
-  m_list.insert(it, DVDMessageListItem(pMsg, priority));
-
-  if (pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0)
+  bool isPacket = pMsg->IsType(CDVDMsg::DEMUXER_PACKET) && priority == 0;
+  if (isPacket)
   {
     DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
     if(packet)
     {
-      m_iDataSize += packet->iSize;
+      AtomicAdd(&m_iDataSize, packet->iSize);
+
+      CSingleLock timeLock(m_timeSection);
       if     (packet->dts != DVD_NOPTS_VALUE)
         m_TimeFront = packet->dts;
       else if(packet->pts != DVD_NOPTS_VALUE)
@@ -138,7 +158,30 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
       if(m_TimeBack == DVD_NOPTS_VALUE)
         m_TimeBack = m_TimeFront;
     }
+
+    // the ring takes over the reference of the caller
+    DVDMessageRingItem item;
+    item.message  = pMsg;
+    item.sequence = AtomicIncrement(&m_iSequence);
+    if (m_packets.Push(item))
+    {
+      if (m_iWaiting)
+        m_hEvent.Set(); // inform waiter for new packet
+      return MSGQ_OK;
+    }
+  }
+
+  CSingleLock lock(m_section);
+
+  SList::iterator it = m_list.begin();
+  while(it != m_list.end())
+  {
+    if(priority <= it->priority)
+      break;
+    it++;
   }
+  m_list.insert(it, DVDMessageListItem(pMsg, priority, AtomicIncrement(&m_iSequence)));
+  AtomicIncrement(&m_iListSize);
 
   pMsg->Release();
 
@@ -147,10 +190,76 @@ MsgQueueReturnCode CDVDMessageQueue::Put(CDVDMsg* pMsg, int priority)
   return MSGQ_OK;
 }
 
-MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+bool CDVDMessageQueue::Pop(CDVDMsg** pMsg, int &priority)
 {
-  CSingleLock lock(m_section);
+  DVDMessageRingItem packet;
+  long position;
+
+  while (true)
+  {
+    bool hasPacket = priority <= 0 && m_packets.Front(packet, position);
 
+    // only look at the list if there is something in it, the size has to be
+    // checked after the ring so we can't miss a message put before the packet
+    if (m_iListSize > 0)
+    {
+      CSingleLock lock(m_section);
+
+      if(!m_list.empty() && m_list.back().priority >= priority)
+      {
+        DVDMessageListItem& item(m_list.back());
+        if (!hasPacket || item.priority > 0 ||
+           (item.priority == 0 && IsBefore(item.sequence, packet.sequence)))
+        {
+          priority = item.priority;
+
+          if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
+            PacketRemoved(item.message, true);
+
+          *pMsg = item.message->Acquire();
+          m_list.pop_back();
+          AtomicDecrement(&m_iListSize);
+          return true;
+        }
+      }
+    }
+
+    if (!hasPacket)
+      return false;
+
+    // the packet is only gone if a flush took it, just try again then
+    if (m_packets.Remove(position))
+    {
+      priority = 0;
+      PacketRemoved(packet.message, true);
+      *pMsg = packet.message;
+      return true;
+    }
+  }
+}
+
+void CDVDMessageQueue::PacketRemoved(CDVDMsg* pMsg, bool delivered)
+{
+  DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)pMsg)->GetPacket();
+  if(packet)
+  {
+    AtomicSubtract(&m_iDataSize, packet->iSize);
+    if (delivered)
+    {
+      CSingleLock timeLock(m_timeSection);
+      if     (packet->dts != DVD_NOPTS_VALUE)
+        m_TimeBack = packet->dts;
+      else if(packet->pts != DVD_NOPTS_VALUE)
+        m_TimeBack = packet->pts;
+    }
+  }
+
+  if(delivered && m_bEmptied && m_iDataSize > 0)
+    m_bEmptied = false;
+}
+
+MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutInMilliSeconds, int &priority)
+{
   *pMsg = NULL;
 
   int ret = 0;
@@ -161,38 +270,17 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
     return MSGQ_NOT_INITIALIZED;
   }
 
-  if(m_list.empty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
+  if(m_iListSize == 0 && m_packets.IsEmpty() && m_bEmptied == false && priority == 0 && m_owner != "teletext")
   {
     CLog::Log(LOGWARNING, "CDVDMessageQueue(%s)::Get - asked for new data packet, with nothing available", m_owner.c_str());
     m_bEmptied = true;
   }
 
+  bool waiting = false;
   while (!m_bAbortRequest)
   {
-    if(!m_list.empty() && m_list.back().priority >= priority && !m_bCaching)
+    if (!m_bCaching && Pop(pMsg, priority))
     {
-      DVDMessageListItem& item(m_list.back());
-      priority = item.priority;
-
-      if (item.message->IsType(CDVDMsg::DEMUXER_PACKET) && item.priority == 0)
-      {
-        DemuxPacket* packet = ((CDVDMsgDemuxerPacket*)item.message)->GetPacket();
-        if(packet)
-        {
-          m_iDataSize -= packet->iSize;
-          if     (packet->dts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->dts;
-          else if(packet->pts != DVD_NOPTS_VALUE)
-            m_TimeBack = packet->pts;
-        }
-
-        if(m_bEmptied && m_iDataSize > 0)
-          m_bEmptied = false;
-      }
-
-      *pMsg = item.message->Acquire();
-      m_list.pop_back();
-
       ret = MSGQ_OK;
       break;
     }
@@ -201,19 +289,29 @@ MsgQueueReturnCode CDVDMessageQueue::Get(CDVDMsg** pMsg, unsigned int iTimeoutIn
       ret = MSGQ_TIMEOUT;
       break;
     }
-    else
+    else if (!waiting)
     {
+      // packets are put without taking the lock, so look at the queue once
+      // more after resetting the event or we could miss the wakeup
+      AtomicIncrement(&m_iWaiting);
       m_hEvent.Reset();
-      lock.Leave();
-
+      waiting = true;
+    }
+    else
+    {
       // wait for a new message
-      if (!m_hEvent.WaitMSec(iTimeoutInMilliSeconds))
-        return MSGQ_TIMEOUT;
+      bool signaled = m_hEvent.WaitMSec(iTimeoutInMilliSeconds);
+      AtomicDecrement(&m_iWaiting);
+      waiting = false;
 
-      lock.Enter();
+      if (!signaled)
+        return MSGQ_TIMEOUT;
     }
   }
 
+  if (waiting)
+    AtomicDecrement(&m_iWaiting);
+
   if (m_bAbortRequest) return MSGQ_ABORT;
 
   return (MsgQueueReturnCode)ret;
@@ -234,6 +332,9 @@ unsigned CDVDMessageQueue::GetPacketCount(CDVDMsg::Message type)
       count++;
   }
 
+  if (type == CDVDMsg::DEMUXER_PACKET)
+    count += m_packets.GetCount();
+
   return count;
 }
 
@@ -248,28 +349,49 @@ void CDVDMessageQueue::WaitUntilEmpty()
 
 int CDVDMessageQueue::GetLevel() const
 {
-  if(m_iDataSize > m_iMaxDataSize)
+  int iDataSize = GetDataSize();
+  if(iDataSize > m_iMaxDataSize)
     return 100;
-  if(m_iDataSize == 0)
+  if(iDataSize == 0)
     return 0;
 
-  if(IsDataBased())
-    return min(100, 100 * m_iDataSize / m_iMaxDataSize);
+  double front, back;
+  GetTimes(front, back);
 
-  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (m_TimeFront - m_TimeBack) / DVD_TIME_BASE ));
+  if(IsDataBased(front, back))
+    return min(100, 100 * iDataSize / m_iMaxDataSize);
+
+  return min(100, MathUtils::round_int(100.0 * m_TimeSize * (front - back) / DVD_TIME_BASE ));
 }
 
 int CDVDMessageQueue::GetTimeSize() const
 {
-  if(IsDataBased())
+  double front, back;
+  GetTimes(front, back);
+
+  if(IsDataBased(front, back))
     return 0;
   else
-    return (int)((m_TimeFront - m_TimeBack) / DVD_TIME_BASE);
+    return (int)((front - back) / DVD_TIME_BASE);
 }
 
 bool CDVDMessageQueue::IsDataBased() const
 {
-  return (m_TimeBack == DVD_NOPTS_VALUE  ||
-          m_TimeFront == DVD_NOPTS_VALUE ||
-          m_TimeFront <= m_TimeBack);
+  double front, back;
+  GetTimes(front, back);
+  return IsDataBased(front, back);
+}
+
+bool CDVDMessageQueue::IsDataBased(double front, double back)
+{
+  return (back == DVD_NOPTS_VALUE  ||
+          front == DVD_NOPTS_VALUE ||
+          front <= back);
+}
+
+void CDVDMessageQueue::GetTimes(double &front, double &back) const
+{
+  CSingleLock lock(m_timeSection);
+  front = m_TimeFront;
+  back  = m_TimeBack;
 }
@@ -26,18 +26,21 @@
 #include <list>
 #include "threads/CriticalSection.h"
 #include "threads/Event.h"
+#include "threads/LockFreeRing.h"
 
 struct DVDMessageListItem
 {
-  DVDMessageListItem(CDVDMsg* msg, int prio)
+  DVDMessageListItem(CDVDMsg* msg, int prio, long seq)
   {
     message  = msg->Acquire();
     priority = prio;
+    sequence = seq;
   }
   DVDMessageListItem()
   {
     message  = NULL;
     priority = 0;
+    sequence = 0;
   }
   DVDMessageListItem(const DVDMessageListItem& item)
   {
@@ -46,6 +49,7 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
   }
  ~DVDMessageListItem()
   {
@@ -62,11 +66,20 @@ struct DVDMessageListItem
     else
       message = NULL;
     priority = item.priority;
+    sequence = item.sequence;
     return *this;
   }
 
   CDVDMsg* message;
   int      priority;
+  long     sequence;
+};
+
+// demuxer packets in the lock-free ring, the ring owns the reference
+struct DVDMessageRingItem
+{
+  CDVDMsg* message;
+  long     sequence;
 };
 
 enum MsgQueueReturnCode
@@ -106,7 +119,7 @@ public:
     return Get(pMsg, iTimeoutInMilliSeconds, priority);
   }
 
-  int GetDataSize() const               { return m_iDataSize; }
+  int GetDataSize() const               { return (int)m_iDataSize; }
   int GetTimeSize() const;
   unsigned GetPacketCount(CDVDMsg::Message type);
   bool ReceivedAbortRequest()           { return m_bAbortRequest; }
@@ -124,6 +137,10 @@ public:
   bool IsDataBased() const;
 
 private:
+  bool  Pop(CDVDMsg** pMsg, int &priority);
+  void  PacketRemoved(CDVDMsg* pMsg, bool delivered);
+  void  GetTimes(double &front, double &back) const;
+  static bool IsDataBased(double front, double back);
 
   CEvent m_hEvent;
   mutable CCriticalSection m_section;
@@ -132,7 +149,11 @@ private:
   bool m_bInitialized;
   bool m_bCaching;
 
-  int m_iDataSize;
+  volatile long m_iDataSize;
+
+  // the demuxer moves the front on the lock-free path while the player moves
+  // the back, both are only touched under m_timeSection (taken after m_section)
+  mutable CCriticalSection m_timeSection;
   double m_TimeFront;
   double m_TimeBack;
   double m_TimeSize;
@@ -143,5 +164,13 @@ private:
 
   typedef std::list<DVDMessageListItem> SList;
   SList m_list;
+  volatile long m_iListSize;
+
+  // priority 0 demuxer packets bypass the list and m_section. They must only be
+  // put from a single thread (the demuxer), everything else goes through the list.
+  // Sequence numbers keep the order between both within priority 0.
+  CLockFreeRing<DVDMessageRingItem> m_packets;
+  volatile long m_iSequence;
+  volatile long m_iWaiting;
 };
 
@@ -21,6 +21,7 @@
 
 #include "DVDPerformanceCounter.h"
 #include "DVDMessageQueue.h"
+#include "DVDDemuxers/DVDDemuxUtils.h"
 #include "utils/TimeUtils.h"
 
 #include "dvd_config.h"
@@ -112,6 +113,12 @@ HRESULT __stdcall DVDPerformanceCounterMainPerformance(PLARGE_INTEGER numerator,
   return S_OK;
 }
 
+HRESULT __stdcall DVDPerformanceCounterPacketPool(PLARGE_INTEGER numerator, PLARGE_INTEGER demoninator)
+{
+  numerator->QuadPart = g_dvdPerformanceCounter.GetPacketPoolReuse();
+  return S_OK;
+}
+
 CDVDPerformanceCounter g_dvdPerformanceCounter;
 
 CDVDPerformanceCounter::CDVDPerformanceCounter()
@@ -142,6 +149,7 @@ bool CDVDPerformanceCounter::Initialize()
   DmRegisterPerformanceCounter("DVDVideoDecodePerformance",   DMCOUNT_SYNC, DVDPerformanceCounterVideoDecodePerformance);
   DmRegisterPerformanceCounter("DVDAudioDecodePerformance",   DMCOUNT_SYNC, DVDPerformanceCounterAudioDecodePerformance);
   DmRegisterPerformanceCounter("DVDMainPerformance",          DMCOUNT_SYNC, DVDPerformanceCounterMainPerformance);
+  DmRegisterPerformanceCounter("DVDPacketPoolReuse",          DMCOUNT_SYNC, DVDPerformanceCounterPacketPool);
 
 #endif
 
@@ -153,3 +161,12 @@ void CDVDPerformanceCounter::DeInitialize()
 
 }
 
+int CDVDPerformanceCounter::GetPacketPoolReuse()
+{
+  DemuxPacketPoolStats stats;
+  CDVDDemuxUtils::GetPoolStats(stats);
+
+  if (stats.allocations <= 0)
+    return 100;
+  return (int)((int64_t)stats.reused * 100 / stats.allocations);
+}
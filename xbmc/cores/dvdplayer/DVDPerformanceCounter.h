@@ -60,6 +60,11 @@ public:
   void EnableMainPerformance(CThread *thread)         { CSingleLock lock(m_critSection); m_mainPerformance.thread = thread;  }
   void DisableMainPerformance()                       { CSingleLock lock(m_critSection); m_mainPerformance.thread = NULL;  }
 
+  /*!
+   \brief Percentage of demux packets served from the packet pool since startup
+   */
+  int GetPacketPoolReuse();
+
   CDVDMessageQueue*         m_pAudioQueue;
   CDVDMessageQueue*         m_pVideoQueue;
 
@@ -1862,6 +1862,9 @@ void CDVDPlayer::OnExit()
 
     m_messenger.End();
 
+    // all streams are closed, don't keep the packet memory around until the next file
+    CDVDDemuxUtils::TrimPool();
+
   }
   catch (...)
   {
@@ -2396,15 +2399,20 @@ void CDVDPlayer::GetGeneralInfo(CStdString& strGeneralInfo)
                          , m_State.cache_level * 100);
       if(m_playSpeed == 0 || m_caching == CACHESTATE_FULL)
         strBuf.AppendFormat(" %d sec", DVD_TIME_TO_SEC(m_State.cache_delay));
+      if(m_State.cache_status.hits || m_State.cache_status.misses)
+        strBuf.AppendFormat(" hit:%u/%u", m_State.cache_status.hits, m_State.cache_status.hits + m_State.cache_status.misses);
+      if(m_State.cache_status.stalls)
+        strBuf.AppendFormat(" stalls:%u", m_State.cache_status.stalls);
     }
 
-    strGeneralInfo.Format("C( ad:% 6.3f, a/v:% 6.3f%s, dcpu:%2i%% acpu:%2i%% vcpu:%2i%%%s )"
+    strGeneralInfo.Format("C( ad:% 6.3f, a/v:% 6.3f%s, dcpu:%2i%% acpu:%2i%% vcpu:%2i%% pool:%3i%%%s )"
                          , dDelay
                          , dDiff
                          , strEDL.c_str()
                          , (int)(CThread::GetRelativeUsage()*100)
                          , (int)(m_dvdPlayerAudio.GetRelativeUsage()*100)
                          , (int)(m_dvdPlayerVideo.GetRelativeUsage()*100)
+                         , g_dvdPerformanceCounter.GetPacketPoolReuse()
                          , strBuf.c_str());
 
   }
@@ -3524,6 +3532,15 @@ int CDVDPlayer::GetCacheLevel() const
   return (int)(m_State.cache_level * 100);
 }
 
+bool CDVDPlayer::GetCacheStatus(XFILE::SCacheStatus &status) const
+{
+  CSingleLock lock(m_StateSection);
+  if (!m_State.cache_valid)
+    return false;
+  status = m_State.cache_status;
+  return true;
+}
+
 double CDVDPlayer::GetQueueTime()
 {
   int a = m_dvdPlayerAudio.GetLevel();
@@ -3700,9 +3717,14 @@ void CDVDPlayer::UpdatePlayState(double timeout)
     state.cache_bytes = status.forward;
     if(state.time_total)
       state.cache_bytes += m_pInputStream->GetLength() * GetQueueTime() / state.time_total;
+    state.cache_valid  = true;
+    state.cache_status = status;
   }
   else
-    state.cache_bytes = 0;
+  {
+    state.cache_bytes  = 0;
+    state.cache_valid  = false;
+  }
 
   state.timestamp = CDVDClock::GetAbsoluteClock();
 
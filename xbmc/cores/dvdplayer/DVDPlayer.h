@@ -36,6 +36,7 @@
 //#include "DVDChapterReader.h"
 #include "DVDSubtitles/DVDFactorySubtitle.h"
 #include "utils/BitstreamStats.h"
+#include "filesystem/IFileTypes.h"
 
 #include "Edl.h"
 #include "FileItem.h"
@@ -252,6 +253,7 @@ public:
 
   virtual bool IsCaching() const { return m_caching == CACHESTATE_FULL; }
   virtual int GetCacheLevel() const ;
+  virtual bool GetCacheStatus(XFILE::SCacheStatus &status) const;
 
   virtual int OnDVDNavResult(void* pData, int iMessage);
 protected:
@@ -407,6 +409,8 @@ protected:
       cache_level   = 0.0;
       cache_delay   = 0.0;
       cache_offset  = 0.0;
+      cache_valid   = false;
+      cache_status  = XFILE::SCacheStatus();
     }
 
     double timestamp;         // last time of update
@@ -432,6 +436,8 @@ protected:
     double  cache_level;   // current estimated required cache level
     double  cache_delay;   // time until cache is expected to reach estimated level
     double  cache_offset;  // percentage of file ahead of current position
+    bool    cache_valid;   // is the input stream cached
+    XFILE::SCacheStatus cache_status; // status of the stream cache
   } m_State;
   CCriticalSection m_StateSection;
 
@@ -0,0 +1,182 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Times CDVDMessageQueue the way the player uses it: a demuxer thread putting
+ * packets and a player thread getting them. Priority 0 packets go through the
+ * lock-free ring, priority 1 through the locked list they used to share with
+ * every other message.
+ *
+ * usage: benchQueue [packets]
+ */
+
+#include "cores/dvdplayer/DVDClock.h"
+#include "cores/dvdplayer/DVDMessageQueue.h"
+#include "cores/dvdplayer/DVDDemuxers/DVDDemuxUtils.h"
+#include "threads/Atomics.h"
+#include "threads/Thread.h"
+#include "utils/TimeUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// packets the demuxer may be ahead of the player, well below the size of the ring
+#define QUEUE_WINDOW 256
+#define PACKET_SIZE  4096
+
+static double Now()
+{
+  return (double)CurrentHostCounter() / (double)CurrentHostFrequency();
+}
+
+static CDVDMsg* NewPacket(unsigned int number)
+{
+  DemuxPacket* packet = CDVDDemuxUtils::AllocateDemuxPacket(PACKET_SIZE);
+  packet->dts = (double)number * DVD_TIME_BASE / 25;
+  return new CDVDMsgDemuxerPacket(packet);
+}
+
+// puts packets as fast as the player takes them
+class CDemuxer : public CThread
+{
+public:
+  CDemuxer(CDVDMessageQueue& queue, int priority, unsigned int packets, volatile long& received)
+    : CThread("BenchDemuxer"), m_queue(queue), m_priority(priority), m_packets(packets), m_received(received) {}
+
+protected:
+  virtual void Process()
+  {
+    for (unsigned int i = 0; i < m_packets; i++)
+    {
+      while ((long)i - m_received >= QUEUE_WINDOW)
+        XbmcThreads::ThreadSleep(0);
+      m_queue.Put(NewPacket(i), m_priority);
+    }
+  }
+
+private:
+  CDVDMessageQueue& m_queue;
+  int m_priority;
+  unsigned int m_packets;
+  volatile long& m_received;
+};
+
+// gets every packet from one queue and puts it back on the other
+class CEcho : public CThread
+{
+public:
+  CEcho(CDVDMessageQueue& in, CDVDMessageQueue& out, int priority, unsigned int packets)
+    : CThread("BenchEcho"), m_in(in), m_out(out), m_priority(priority), m_packets(packets) {}
+
+protected:
+  virtual void Process()
+  {
+    for (unsigned int i = 0; i < m_packets; i++)
+    {
+      CDVDMsg* msg;
+      if (m_in.Get(&msg, 1000) != MSGQ_OK)
+        break;
+      m_out.Put(msg, m_priority);
+    }
+  }
+
+private:
+  CDVDMessageQueue& m_in;
+  CDVDMessageQueue& m_out;
+  int m_priority;
+  unsigned int m_packets;
+};
+
+// packets per second from the demuxer thread to the player thread
+static double Throughput(int priority, unsigned int packets)
+{
+  CDVDMessageQueue queue("bench");
+  queue.Init();
+  volatile long received = 0;
+
+  CDemuxer demuxer(queue, priority, packets, received);
+  double start = Now();
+  demuxer.Create();
+  for (unsigned int i = 0; i < packets; i++)
+  {
+    CDVDMsg* msg;
+    if (queue.Get(&msg, 1000) != MSGQ_OK)
+    {
+      fprintf(stderr, "packet %u never arrived\n", i);
+      exit(1);
+    }
+    msg->Release();
+    AtomicIncrement(&received);
+  }
+  double elapsed = Now() - start;
+  demuxer.StopThread();
+  queue.End();
+  return packets / elapsed;
+}
+
+// microseconds a Put() takes to wake up the thread waiting in Get()
+static double Wakeup(int priority, unsigned int packets)
+{
+  CDVDMessageQueue ping("ping"), pong("pong");
+  ping.Init();
+  pong.Init();
+
+  CEcho echo(ping, pong, priority, packets);
+  echo.Create();
+  double start = Now();
+  for (unsigned int i = 0; i < packets; i++)
+  {
+    ping.Put(NewPacket(i), priority);
+    CDVDMsg* msg;
+    if (pong.Get(&msg, 1000) != MSGQ_OK)
+    {
+      fprintf(stderr, "packet %u never came back\n", i);
+      exit(1);
+    }
+    msg->Release();
+  }
+  double elapsed = Now() - start;
+  echo.StopThread();
+  ping.End();
+  pong.End();
+  return elapsed * 1e6 / (2.0 * packets);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int packets = argc > 1 ? atoi(argv[1]) : 200000;
+  if (packets == 0)
+  {
+    fprintf(stderr, "usage: %s [packets]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%u packets of %u bytes\n", packets, PACKET_SIZE);
+  printf("%-16s %12s %14s\n", "path", "packets/s", "wakeup (usec)");
+  double listRate = Throughput(1, packets);
+  double listWakeup = Wakeup(1, packets / 10);
+  printf("%-16s %12.0f %14.1f\n", "locked list", listRate, listWakeup);
+  double ringRate = Throughput(0, packets);
+  double ringWakeup = Wakeup(0, packets / 10);
+  printf("%-16s %12.0f %14.1f\n", "lock-free ring", ringRate, ringWakeup);
+  printf("speedup %.2fx\n", ringRate / listRate);
+  return 0;
+}
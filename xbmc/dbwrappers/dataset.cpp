@@ -211,6 +211,62 @@ void Dataset::parse_sql(string &sql) {
 }
 
 
+string Dataset::bind_params(const string &sql, const ParamValues &params) {
+  if (db == NULL) throw DbErrors("No Database Connection");
+
+  string result;
+  result.reserve(sql.size() + params.size() * 16);
+
+  unsigned int param = 0;
+  char quote = 0;
+  for (string::const_iterator c = sql.begin(); c != sql.end(); c++) {
+    // placeholders inside of string literals are left alone
+    if (quote) {
+      if (*c == quote) quote = 0;
+    }
+    else if (*c == '\'' || *c == '"')
+      quote = *c;
+    else if (*c == '?') {
+      if (param >= params.size())
+        throw DbErrors("Not enough parameters for query: %s", sql.c_str());
+
+      const field_value &value = params[param++];
+      if (value.get_isNull())
+        result += "NULL";
+      else switch (value.get_fType()) {
+        case ft_String:
+        case ft_WideString:
+        case ft_Char:
+        case ft_WChar:
+          result += db->prepare("'%s'", value.get_asString().c_str());
+          break;
+        case ft_Boolean:
+          result += value.get_asBool() ? "1" : "0";
+          break;
+        default:
+          result += value.get_asString();
+          break;
+      }
+      continue;
+    }
+    result += *c;
+  }
+
+  if (param != params.size())
+    throw DbErrors("Too many parameters for query: %s", sql.c_str());
+
+  return result;
+}
+
+bool Dataset::query_params(const string &sql, const ParamValues &params) {
+  return query(bind_params(sql, params).c_str());
+}
+
+int Dataset::exec_params(const string &sql, const ParamValues &params) {
+  return exec(bind_params(sql, params));
+}
+
+
 void Dataset::close(void) {
   haveError  = false;
   frecno = 0;
@@ -171,6 +171,7 @@ enum sqlType {sqlSelect,sqlUpdate,sqlInsert,sqlDelete,sqlExec};
 
 typedef std::list<std::string> StringList;
 typedef std::map<std::string,field_value> ParamList;
+typedef std::vector<field_value> ParamValues;
 
 
 class Dataset  {
@@ -248,6 +249,9 @@ protected:
 /* Parse Sql - replacing fields with prefixes :OLD_ and :NEW_ with current values of OLD or NEW field. */
   void parse_sql(std::string &sql);
 
+/* Replaces the ? placeholders in sql with the properly quoted values of params */
+  std::string bind_params(const std::string &sql, const ParamValues &params);
+
 /* Returns old field value (for :OLD) */
   virtual const field_value f_old(const char *f);
 
@@ -296,6 +300,10 @@ public:
   virtual const void* getExecRes()=0;
 /* as open, but with our query exept Sql */
   virtual bool query(const char *sql) = 0;
+/* as query/exec, but with the ? placeholders in sql bound to params. Drivers
+   supporting prepared statements cache and reuse the compiled statement. */
+  virtual bool query_params(const std::string &sql, const ParamValues &params);
+  virtual int  exec_params(const std::string &sql, const ParamValues &params);
 /* Close SQL Query*/
   virtual void close();
 /* This function looks for field Field_name with value equal Field_value
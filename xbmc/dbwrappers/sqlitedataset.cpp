@@ -92,6 +92,7 @@ SqliteDatabase::SqliteDatabase() {
 
   active = false;	
   _in_transaction = false;		// for transaction
+  statements_compiled = 0;
 
   error = "Unknown database error";//S_NO_CONNECTION;
   host = "localhost";
@@ -260,6 +261,7 @@ bool SqliteDatabase::exists(void)
 
 void SqliteDatabase::disconnect(void) {
   if (active == false) return;
+  clear_statements();
   sqlite3_close(conn);
   active = false;
 }
@@ -403,6 +405,70 @@ string SqliteDatabase::vprepare(const char *format, va_list args)
 
   return strResult;
 }
+// methods for prepared statements
+// ---------------------------------------------
+sqlite3_stmt *SqliteDatabase::acquire_statement(const string &sql)
+{
+  if (!active) throw DbErrors("No Database Connection");
+
+  for (StatementCache::iterator it = statements.begin(); it != statements.end(); ++it)
+  {
+    if (it->first == sql)
+    {
+      sqlite3_stmt *stmt = it->second;
+      statements.erase(it);
+      return stmt;
+    }
+  }
+
+  sqlite3_stmt *stmt = NULL;
+#if defined(TARGET_DARWIN)
+  if (setErr(sqlite3_prepare(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+#else
+  if (setErr(sqlite3_prepare_v2(conn, sql.c_str(), -1, &stmt, NULL), sql.c_str()) != SQLITE_OK)
+#endif
+    throw DbErrors(getErrorMsg());
+
+  statements_compiled++;
+  return stmt;
+}
+
+void SqliteDatabase::release_statement(const string &sql, sqlite3_stmt *stmt)
+{
+  if (stmt == NULL)
+    return;
+
+  if (!active || sqlite3_reset(stmt) != SQLITE_OK)
+  {
+    sqlite3_finalize(stmt);
+    return;
+  }
+  sqlite3_clear_bindings(stmt);
+
+  // another dataset may have released the same statement in the meantime
+  for (StatementCache::iterator it = statements.begin(); it != statements.end(); ++it)
+  {
+    if (it->first == sql)
+    {
+      sqlite3_finalize(stmt);
+      return;
+    }
+  }
+
+  statements.push_front(make_pair(sql, stmt));
+  while (statements.size() > MAX_CACHED_STATEMENTS)
+  {
+    sqlite3_finalize(statements.back().second);
+    statements.pop_back();
+  }
+}
+
+void SqliteDatabase::clear_statements()
+{
+  for (StatementCache::iterator it = statements.begin(); it != statements.end(); ++it)
+    sqlite3_finalize(it->second);
+  statements.clear();
+}
 
 
 //************* SqliteDataset implementation ***************
@@ -615,6 +681,26 @@ bool SqliteDataset::query(const char *query) {
   #endif
     throw DbErrors(db->getErrorMsg());
 
+  fetch_rows(stmt);
+
+  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+  {
+    active = true;
+    ds_state = dsSelect;
+    this->first();
+    return true;
+  }
+  else
+  {
+    throw DbErrors(db->getErrorMsg());
+  }  
+}
+
+bool SqliteDataset::query(const string &q){
+  return query(q.c_str());
+}
+
+void SqliteDataset::fetch_rows(sqlite3_stmt *stmt) {
   // column headers
   const unsigned int numColumns = sqlite3_column_count(stmt);
   result.record_header.resize(numColumns);
@@ -652,21 +738,103 @@ bool SqliteDataset::query(const char *query) {
     }
     result.records.push_back(res);
   }
-  if (db->setErr(sqlite3_finalize(stmt),query) == SQLITE_OK)
+}
+
+void SqliteDataset::bind_statement(sqlite3_stmt *stmt, const string &sql, const ParamValues &params) {
+  if (sqlite3_bind_parameter_count(stmt) != (int)params.size())
+    throw DbErrors("Parameter count mismatch for query: %s", sql.c_str());
+
+  for (unsigned int i = 0; i < params.size(); i++)
   {
-    active = true;
-    ds_state = dsSelect;
-    this->first();
-    return true;
+    const field_value &value = params[i];
+    int res;
+    if (value.get_isNull())
+      res = sqlite3_bind_null(stmt, i + 1);
+    else switch (value.get_fType())
+    {
+    case ft_Boolean:
+    case ft_Short:
+    case ft_UShort:
+    case ft_Int:
+    case ft_UInt:
+    case ft_Int64:
+      res = sqlite3_bind_int64(stmt, i + 1, value.get_asInt64());
+      break;
+    case ft_Float:
+    case ft_Double:
+    case ft_LongDouble:
+      res = sqlite3_bind_double(stmt, i + 1, value.get_asDouble());
+      break;
+    default:
+    {
+      const string str = value.get_asString();
+      res = sqlite3_bind_text(stmt, i + 1, str.c_str(), (int)str.size(), SQLITE_TRANSIENT);
+      break;
+    }
+    }
+    if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+      throw DbErrors(db->getErrorMsg());
   }
-  else
+}
+
+bool SqliteDataset::query_params(const string &sql, const ParamValues &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+
+  close();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->acquire_statement(sql);
+  try
+  {
+    bind_statement(stmt, sql, params);
+    fetch_rows(stmt);
+  }
+  catch (...)
   {
+    database->release_statement(sql, stmt);
+    throw;
+  }
+
+  // sqlite3_reset() reports the error of the last sqlite3_step()
+  int res = sqlite3_reset(stmt);
+  database->release_statement(sql, stmt);
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
     throw DbErrors(db->getErrorMsg());
-  }  
+
+  active = true;
+  ds_state = dsSelect;
+  this->first();
+  return true;
 }
 
-bool SqliteDataset::query(const string &q){
-  return query(q.c_str());
+int SqliteDataset::exec_params(const string &sql, const ParamValues &params) {
+  if(!handle()) throw DbErrors("No Database Connection");
+  exec_res.clear();
+
+  SqliteDatabase *database = static_cast<SqliteDatabase*>(db);
+  sqlite3_stmt *stmt = database->acquire_statement(sql);
+  int res;
+  try
+  {
+    bind_statement(stmt, sql, params);
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
+      ;
+  }
+  catch (...)
+  {
+    database->release_statement(sql, stmt);
+    throw;
+  }
+
+  if (res != SQLITE_DONE)
+    res = sqlite3_reset(stmt);
+  else
+    res = SQLITE_OK;
+  database->release_statement(sql, stmt);
+
+  if (db->setErr(res, sql.c_str()) != SQLITE_OK)
+    throw DbErrors(db->getErrorMsg());
+  return res;
 }
 
 void SqliteDataset::open(const string &sql) {
@@ -30,9 +30,13 @@
 #define _SQLITEDATASET_H
 
 #include <stdio.h>
+#include <list>
 #include "dataset.h"
 #include <sqlite3.h>
 
+// number of prepared statements each connection keeps
+#define MAX_CACHED_STATEMENTS 32
+
 namespace dbiplus {
 /***************** Class SqliteDatabase definition ******************
 
@@ -46,6 +50,11 @@ protected:
   bool _in_transaction;
   int last_err;
 
+/* LRU cache of prepared statements (most recently used first) */
+  typedef std::list< std::pair<std::string, sqlite3_stmt*> > StatementCache;
+  StatementCache statements;
+  unsigned int statements_compiled;
+
 public:
 /* default constructor */
   SqliteDatabase();
@@ -94,6 +103,16 @@ public:
 
   bool in_transaction() {return _in_transaction;}; 	
 
+/* prepared statements: acquire returns a cached statement (removing it from the
+   cache while in use) or compiles a new one, release resets it and puts it back */
+  sqlite3_stmt *acquire_statement(const std::string &sql);
+  void release_statement(const std::string &sql, sqlite3_stmt *stmt);
+  void clear_statements();
+/* number of statements compiled so far and currently cached, a statement
+   taken from the cache isn't compiled again */
+  unsigned int get_statements_compiled() const {return statements_compiled;};
+  unsigned int get_statements_cached() const {return statements.size();};
+
 };
 
 
@@ -125,6 +144,11 @@ protected:
 /* Changing field values during dataset navigation */
   virtual void free_row();  // free the memory allocated for the current row
 
+/* Fills the result set with the rows returned by a compiled statement */
+  void fetch_rows(sqlite3_stmt *stmt);
+/* Binds the parameter values to a compiled statement */
+  void bind_statement(sqlite3_stmt *stmt, const std::string &sql, const ParamValues &params);
+
 public:
 /* constructor */
   SqliteDataset();
@@ -147,6 +171,9 @@ or insert() operations default = false) */
 /* as open, but with our query exept Sql */
   virtual bool query(const char *query);
   virtual bool query(const std::string &query);
+/* as query/exec but using a cached prepared statement */
+  virtual bool query_params(const std::string &sql, const ParamValues &params);
+  virtual int  exec_params(const std::string &sql, const ParamValues &params);
 /* func. closes a query */
   virtual void close(void);
 /* Cancel changes, made in insert or edit states of dataset */
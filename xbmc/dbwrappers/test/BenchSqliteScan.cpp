@@ -0,0 +1,186 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Times the statements a library scan issues for every file it adds, the way
+ * CVideoDatabase::AddFile()/AddPath()/GetPathId() issue them: once with the
+ * values formatted into the sql, parsed by sqlite for every call, and once
+ * with bound parameters on statements from the cache.
+ *
+ * usage: benchScan [files] [files per folder]
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace dbiplus;
+
+static double Now()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+class CScanDatabase
+{
+public:
+  CScanDatabase(bool prepared) : m_prepared(prepared)
+  {
+    char name[64];
+    sprintf(name, "xbmc-dbbench-%d.db", (int)getpid());
+    m_file = std::string("/tmp/") + name;
+    unlink(m_file.c_str());
+    m_db.setHostName("/tmp/");
+    m_db.setDatabase(name);
+    m_db.connect(true);
+    m_ds = m_db.CreateDataset();
+    m_ds->exec("CREATE TABLE path ( idPath integer primary key, strPath text, strContent text, strScraper text, strHash text, scanRecursive integer, useFolderNames bool, strSettings text, noUpdate bool, exclude bool, dateAdded text)");
+    m_ds->exec("CREATE UNIQUE INDEX ix_path ON path ( strPath )");
+    m_ds->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
+    m_ds->exec("CREATE UNIQUE INDEX ix_files ON files ( idPath, strFilename )");
+  }
+
+  ~CScanDatabase()
+  {
+    delete m_ds;
+    m_db.disconnect();
+    unlink(m_file.c_str());
+  }
+
+  void Begin()  { m_db.start_transaction(); }
+  void Commit() { m_db.commit_transaction(); }
+
+  int GetPathId(const std::string &path)
+  {
+    if (m_prepared)
+    {
+      ParamValues params;
+      params.push_back(path.c_str());
+      m_ds->query_params("select idPath from path where strPath=?", params);
+    }
+    else
+      m_ds->query(m_db.prepare("select idPath from path where strPath='%s'", path.c_str()).c_str());
+    int id = m_ds->eof() ? -1 : m_ds->fv(0).get_asInt();
+    m_ds->close();
+    return id;
+  }
+
+  int AddPath(const std::string &path)
+  {
+    int id = GetPathId(path);
+    if (id >= 0)
+      return id;
+    if (m_prepared)
+    {
+      ParamValues params;
+      params.push_back(path.c_str());
+      m_ds->exec_params("insert into path (idPath, strPath, strContent, strScraper) values (NULL,?,'','')", params);
+    }
+    else
+      m_ds->exec(m_db.prepare("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", path.c_str()));
+    return (int)m_ds->lastinsertid();
+  }
+
+  int AddFile(const std::string &path, const std::string &file)
+  {
+    int idPath = AddPath(path);
+    if (m_prepared)
+    {
+      ParamValues params;
+      params.push_back(file.c_str());
+      params.push_back(idPath);
+      m_ds->query_params("select idFile from files where strFileName=? and idPath=?", params);
+    }
+    else
+      m_ds->query(m_db.prepare("select idFile from files where strFileName='%s' and idPath=%i", file.c_str(), idPath).c_str());
+    if (m_ds->num_rows() > 0)
+    {
+      int id = m_ds->fv(0).get_asInt();
+      m_ds->close();
+      return id;
+    }
+    m_ds->close();
+    if (m_prepared)
+    {
+      ParamValues params;
+      params.push_back(idPath);
+      params.push_back(file.c_str());
+      m_ds->exec_params("insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)", params);
+    }
+    else
+      m_ds->exec(m_db.prepare("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, file.c_str()));
+    return (int)m_ds->lastinsertid();
+  }
+
+private:
+  bool m_prepared;
+  std::string m_file;
+  SqliteDatabase m_db;
+  Dataset *m_ds;
+};
+
+// files per second, adding every file twice as a rescan of an unchanged library does
+static double BenchScan(bool prepared, unsigned int files, unsigned int perFolder)
+{
+  CScanDatabase db(prepared);
+  char path[64], file[64];
+  double start = Now();
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (unsigned int i = 0; i < files; i += perFolder)
+    {
+      sprintf(path, "smb://server/movies/folder %u/", i / perFolder);
+      db.Begin();
+      for (unsigned int j = i; j < i + perFolder && j < files; j++)
+      {
+        sprintf(file, "movie %u (2012).mkv", j);
+        db.AddFile(path, file);
+      }
+      db.Commit();
+    }
+  }
+  return 2.0 * files / (Now() - start);
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned int files     = argc > 1 ? atoi(argv[1]) : 20000;
+  unsigned int perFolder = argc > 2 ? atoi(argv[2]) : 20;
+  if (files == 0 || perFolder == 0)
+  {
+    fprintf(stderr, "usage: %s [files] [files per folder]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%u files, %u per folder, added twice\n", files, perFolder);
+  printf("%-12s %12s\n", "statements", "files/s");
+  double formatted = BenchScan(false, files, perFolder);
+  printf("%-12s %12.0f\n", "formatted", formatted);
+  double prepared = BenchScan(true, files, perFolder);
+  printf("%-12s %12.0f\n", "prepared", prepared);
+  printf("speedup %.2fx\n", prepared / formatted);
+  return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "dbwrappers/sqlitedataset.h"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace dbiplus;
+
+namespace
+{
+  // a fresh database in /tmp, removed again when done
+  class CTestDatabase
+  {
+  public:
+    CTestDatabase()
+    {
+      char name[64];
+      sprintf(name, "xbmc-dbtest-%d.db", (int)getpid());
+      m_file = std::string("/tmp/") + name;
+      unlink(m_file.c_str());
+      db.setHostName("/tmp/");
+      db.setDatabase(name);
+      db.connect(true);
+      ds = db.CreateDataset();
+      ds->exec("CREATE TABLE path (idPath integer primary key, strPath text, strHash text)");
+    }
+
+    ~CTestDatabase()
+    {
+      delete ds;
+      db.disconnect();
+      unlink(m_file.c_str());
+    }
+
+    int AddPath(const char *path)
+    {
+      ParamValues params;
+      params.push_back(path);
+      ds->exec_params("insert into path (idPath, strPath) values (NULL, ?)", params);
+      return (int)ds->lastinsertid();
+    }
+
+    int GetPathId(const char *path)
+    {
+      ParamValues params;
+      params.push_back(path);
+      ds->query_params("select idPath from path where strPath=?", params);
+      int id = ds->eof() ? -1 : ds->fv(0).get_asInt();
+      ds->close();
+      return id;
+    }
+
+    SqliteDatabase db;
+    Dataset *ds;
+
+  private:
+    std::string m_file;
+  };
+
+  // a distinct statement per number
+  void QueryNumber(CTestDatabase &test, int number)
+  {
+    char sql[64];
+    sprintf(sql, "select idPath from path where idPath=? or %d=0", number);
+    ParamValues params;
+    params.push_back(number);
+    test.ds->query_params(sql, params);
+    test.ds->close();
+  }
+}
+
+TEST(SqliteStatementsReusedFromCache)
+{
+  CTestDatabase test;
+  unsigned int compiled = test.db.get_statements_compiled();
+
+  CHECK_EQUAL(1, test.AddPath("/movies/"));
+  CHECK_EQUAL(2, test.AddPath("/tv/"));
+  CHECK_EQUAL(compiled + 1, test.db.get_statements_compiled());
+
+  CHECK_EQUAL(2, test.GetPathId("/tv/"));
+  CHECK_EQUAL(1, test.GetPathId("/movies/"));
+  CHECK_EQUAL(-1, test.GetPathId("/music/"));
+  CHECK_EQUAL(compiled + 2, test.db.get_statements_compiled());
+  CHECK_EQUAL(2u, test.db.get_statements_cached());
+}
+
+TEST(SqliteStatementsBindValues)
+{
+  CTestDatabase test;
+
+  // nothing is pasted into the sql, so quotes need no escaping
+  const char *path = "/it's \"quoted\"/";
+  int id = test.AddPath(path);
+  CHECK_EQUAL(id, test.GetPathId(path));
+
+  field_value null;
+  null.set_isNull();
+  ParamValues params;
+  params.push_back(null);
+  params.push_back(id);
+  test.ds->exec_params("update path set strHash=? where idPath=?", params);
+  test.ds->query("select strPath, strHash from path");
+  CHECK_EQUAL(1, test.ds->num_rows());
+  CHECK(test.ds->fv(0).get_asString() == path);
+  CHECK(test.ds->fv(1).get_isNull());
+  test.ds->close();
+}
+
+TEST(SqliteStatementsEvictLeastRecentlyUsed)
+{
+  CTestDatabase test;
+  unsigned int compiled = test.db.get_statements_compiled();
+
+  for (int i = 0; i <= MAX_CACHED_STATEMENTS; i++)
+    QueryNumber(test, i);
+  CHECK_EQUAL(compiled + MAX_CACHED_STATEMENTS + 1, test.db.get_statements_compiled());
+  CHECK_EQUAL((unsigned int)MAX_CACHED_STATEMENTS, test.db.get_statements_cached());
+
+  // the most recent one is still cached, the first one was dropped for it
+  QueryNumber(test, MAX_CACHED_STATEMENTS);
+  CHECK_EQUAL(compiled + MAX_CACHED_STATEMENTS + 1, test.db.get_statements_compiled());
+  QueryNumber(test, 0);
+  CHECK_EQUAL(compiled + MAX_CACHED_STATEMENTS + 2, test.db.get_statements_compiled());
+  CHECK_EQUAL((unsigned int)MAX_CACHED_STATEMENTS, test.db.get_statements_cached());
+
+  test.db.disconnect();
+  CHECK_EQUAL(0u, test.db.get_statements_cached());
+}
+
+TEST(SqliteStatementsSurviveBindErrors)
+{
+  CTestDatabase test;
+  CHECK_EQUAL(-1, test.GetPathId("/movies/"));
+  unsigned int compiled = test.db.get_statements_compiled();
+
+  bool thrown = false;
+  try
+  {
+    ParamValues params;
+    test.ds->query_params("select idPath from path where strPath=?", params);
+  }
+  catch (DbErrors&)
+  {
+    thrown = true;
+  }
+  CHECK(thrown);
+
+  // the statement went back to the cache without the bad binding
+  test.AddPath("/movies/");
+  CHECK_EQUAL(1, test.GetPathId("/movies/"));
+  CHECK_EQUAL(compiled + 1, test.db.get_statements_compiled());
+}
@@ -54,6 +54,21 @@ public:
   virtual int64_t Seek(int64_t iFilePosition) = 0;
   virtual void Reset(int64_t iSourcePosition) = 0;
 
+  // is the position cached or about to be written. if not, the source has to be moved
+  // there before reading. strategies only caching around the source position never say no.
+  virtual bool IsCachedPosition(int64_t iFilePosition) { return true; }
+
+  // strategies keeping the data in memory can lend it out instead of copying it.
+  // BorrowRead() returns a pointer to up to iMaxSize bytes at the read position, or the
+  // same codes as ReadFromCache(). the data stays valid until ReleaseRead() consumes it.
+  // BorrowWrite() returns a pointer to iSize bytes of space at the write position or 0 if
+  // there isn't that much in one piece. CommitWrite() adds what was filled in to the cache.
+  virtual bool CanBorrow() { return false; }
+  virtual int BorrowRead(const char *&pBuffer, size_t iMaxSize) { return CACHE_RC_ERROR; }
+  virtual void ReleaseRead(size_t iSize) {}
+  virtual int BorrowWrite(char *&pBuffer, size_t iSize) { return 0; }
+  virtual void CommitWrite(size_t iSize) {}
+
   virtual void EndOfInput(); // mark the end of the input stream so that Read will know when to return EOF
   virtual bool IsEndOfInput();
   virtual void ClearEndOfInput();
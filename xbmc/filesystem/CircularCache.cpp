@@ -33,6 +33,7 @@ CCircularCache::CCircularCache(size_t front, size_t back)
  , m_beg(0)
  , m_end(0)
  , m_cur(0)
+ , m_borrowed(0)
  , m_buf(NULL)
  , m_size(front + back)
  , m_size_back(back)
@@ -62,6 +63,7 @@ int CCircularCache::Open()
   m_beg = 0;
   m_end = 0;
   m_cur = 0;
+  m_borrowed = 0;
   return CACHE_RC_OK;
 }
 
@@ -167,6 +169,80 @@ int CCircularCache::ReadFromCache(char *buf, size_t len)
   return len;
 }
 
+/**
+ * Lends the data ReadFromCache would copy out. The writer
+ * never overwrites data ahead of m_cur, so it stays valid
+ * until ReleaseRead moves m_cur past it.
+ */
+int CCircularCache::BorrowRead(const char *&buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t pos   = m_cur % m_size;
+  size_t front = (size_t)(m_end - m_cur);
+  size_t avail = std::min(m_size - pos, front);
+
+  if(avail == 0)
+  {
+    if(IsEndOfInput())
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  if(len > avail)
+    len = avail;
+
+  buf = (const char*)m_buf + pos;
+  return len;
+}
+
+void CCircularCache::ReleaseRead(size_t len)
+{
+  CSingleLock lock(m_sync);
+  m_cur += len;
+
+  m_space.Set();
+}
+
+/**
+ * Lends len bytes of space at m_end % m_size, if WriteToCache
+ * could write that much in one go. The history about to be
+ * overwritten is dropped right away so that the reader can't
+ * seek back into it while the space is being filled.
+ */
+int CCircularCache::BorrowWrite(char *&buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  size_t pos   = m_end % m_size;
+  size_t back  = (size_t)(m_cur - m_beg);
+  size_t front = (size_t)(m_end - m_cur);
+
+  size_t limit = m_size - std::min(back, m_size_back) - front;
+  size_t wrap  = m_size - pos;
+
+  if(len == 0 || len > limit || len > wrap)
+    return 0;
+
+  // the history is only dropped once the space is actually written, until
+  // then it can't be sought back to as it's being overwritten
+  m_borrowed = len;
+  buf = (char*)m_buf + pos;
+  return len;
+}
+
+void CCircularCache::CommitWrite(size_t len)
+{
+  CSingleLock lock(m_sync);
+  m_borrowed = 0;
+  if(m_end + len - m_beg > m_size)
+    m_beg = m_end + len - m_size;
+  m_end += len;
+
+  m_written.Set();
+}
+
 int64_t CCircularCache::WaitForData(unsigned int minumum, unsigned int millis)
 {
   CSingleLock lock(m_sync);
@@ -203,7 +279,12 @@ int64_t CCircularCache::Seek(int64_t pos)
     lock.Enter();
   }
 
-  if((uint64_t)pos >= m_beg && (uint64_t)pos <= m_end)
+  // skip the history a borrowed write is overwriting
+  uint64_t beg = m_beg;
+  if(m_end + m_borrowed - m_beg > m_size)
+    beg = m_end + m_borrowed - m_size;
+
+  if((uint64_t)pos >= beg && (uint64_t)pos <= m_end)
   {
     m_cur = pos;
     return pos;
@@ -218,5 +299,6 @@ void CCircularCache::Reset(int64_t pos)
   m_end = pos;
   m_beg = pos;
   m_cur = pos;
+  m_borrowed = 0;
 }
 
@@ -44,10 +44,17 @@ public:
     virtual int64_t Seek(int64_t pos) ;
     virtual void Reset(int64_t pos) ;
 
+    virtual bool CanBorrow() { return true; }
+    virtual int BorrowRead(const char *&buf, size_t len);
+    virtual void ReleaseRead(size_t len);
+    virtual int BorrowWrite(char *&buf, size_t len);
+    virtual void CommitWrite(size_t len);
+
 protected:
     uint64_t          m_beg;       /**< index in file (not buffer) of beginning of valid data */
     uint64_t          m_end;       /**< index in file (not buffer) of end of valid data */
     uint64_t          m_cur;       /**< current reading index in file */
+    size_t            m_borrowed;  /**< space lent out by BorrowWrite() that isn't committed yet */
     uint8_t          *m_buf;       /**< buffer holding data */
     size_t            m_size;      /**< size of data buffer used (m_buf) */
     size_t            m_size_back; /**< guaranteed size of back buffer (actual size can be smaller, or larger if front buffer doesn't need it) */
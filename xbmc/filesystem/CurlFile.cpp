@@ -44,14 +44,14 @@
 #include "SpecialProtocol.h"
 #include "utils/CharsetConverter.h"
 #include "utils/log.h"
+#include "threads/SystemClock.h"
 
 using namespace XFILE;
 using namespace XCURL;
 
-#define XMIN(a,b) ((a)<(b)?(a):(b))
-#define FITS_INT(a) (((a) <= INT_MAX) && ((a) >= INT_MIN))
-
-#define dllselect select
+/* the transfer callbacks are with CReadState, in CurlReadState.cpp */
+extern "C" size_t write_callback(char *buffer, size_t size, size_t nitems, void *userp);
+extern "C" size_t header_callback(void *ptr, size_t size, size_t nmemb, void *stream);
 
 // curl calls this routine to debug
 extern "C" int debug_callback(CURL_HANDLE *handle, curl_infotype info, char *output, size_t size, void *data)
@@ -76,228 +76,6 @@ extern "C" int debug_callback(CURL_HANDLE *handle, curl_infotype info, char *out
   return 0;
 }
 
-/* curl calls this routine to get more data */
-extern "C" size_t write_callback(char *buffer,
-               size_t size,
-               size_t nitems,
-               void *userp)
-{
-  if(userp == NULL) return 0;
-
-  CCurlFile::CReadState *state = (CCurlFile::CReadState *)userp;
-  return state->WriteCallback(buffer, size, nitems);
-}
-
-extern "C" size_t header_callback(void *ptr, size_t size, size_t nmemb, void *stream)
-{
-  CCurlFile::CReadState *state = (CCurlFile::CReadState *)stream;
-  return state->HeaderCallback(ptr, size, nmemb);
-}
-
-/* fix for silly behavior of realloc */
-static inline void* realloc_simple(void *ptr, size_t size)
-{
-  void *ptr2 = realloc(ptr, size);
-  if(ptr && !ptr2 && size > 0)
-  {
-    free(ptr);
-    return NULL;
-  }
-  else
-    return ptr2;
-}
-
-size_t CCurlFile::CReadState::HeaderCallback(void *ptr, size_t size, size_t nmemb)
-{
-  // clear any previous header
-  if(m_headerdone)
-  {
-    m_httpheader.Clear();
-    m_headerdone = false;
-  }
-
-  // libcurl doc says that this info is not always \0 terminated
-  char* strData = (char*)ptr;
-  int iSize = size * nmemb;
-
-  if (strData[iSize] != 0)
-  {
-    strData = (char*)malloc(iSize + 1);
-    strncpy(strData, (char*)ptr, iSize);
-    strData[iSize] = 0;
-  }
-  else strData = strdup((char*)ptr);
-
-  if(strcmp(strData, "\r\n") == 0)
-    m_headerdone = true;
-
-  m_httpheader.Parse(strData);
-
-  free(strData);
-
-  return iSize;
-}
-
-size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t nitems)
-{
-  unsigned int amount = size * nitems;
-//  CLog::Log(LOGDEBUG, "CCurlFile::WriteCallback (%p) with %i bytes, readsize = %i, writesize = %i", this, amount, m_buffer.getMaxReadSize(), m_buffer.getMaxWriteSize() - m_overflowSize);
-  if (m_overflowSize)
-  {
-    // we have our overflow buffer - first get rid of as much as we can
-    unsigned int maxWriteable = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
-    if (maxWriteable)
-    {
-      if (!m_buffer.WriteData(m_overflowBuffer, maxWriteable))
-        CLog::Log(LOGERROR, "Unable to write to buffer - what's up?");
-      if (m_overflowSize > maxWriteable)
-      { // still have some more - copy it down
-        memmove(m_overflowBuffer, m_overflowBuffer + maxWriteable, m_overflowSize - maxWriteable);
-      }
-      m_overflowSize -= maxWriteable;
-    }
-  }
-  // ok, now copy the data into our ring buffer
-  unsigned int maxWriteable = XMIN((unsigned int)m_buffer.getMaxWriteSize(), amount);
-  if (maxWriteable)
-  {
-    if (!m_buffer.WriteData(buffer, maxWriteable))
-    {
-      CLog::Log(LOGERROR, "%s - Unable to write to buffer with %i bytes - what's up?", __FUNCTION__, maxWriteable);
-    }
-    else
-    {
-      amount -= maxWriteable;
-      buffer += maxWriteable;
-    }
-  }
-  if (amount)
-  {
-//    CLog::Log(LOGDEBUG, "CCurlFile::WriteCallback(%p) not enough free space for %i bytes", (void*)this,  amount);
-
-    m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, amount + m_overflowSize);
-    if(m_overflowBuffer == NULL)
-    {
-      CLog::Log(LOGWARNING, "%s - Failed to grow overflow buffer from %i bytes to %i bytes", __FUNCTION__, m_overflowSize, amount + m_overflowSize);
-      return 0;
-    }
-    memcpy(m_overflowBuffer + m_overflowSize, buffer, amount);
-    m_overflowSize += amount;
-  }
-  return size * nitems;
-}
-
-CCurlFile::CReadState::CReadState()
-{
-  m_easyHandle = NULL;
-  m_multiHandle = NULL;
-  m_overflowBuffer = NULL;
-  m_overflowSize = 0;
-  m_filePos = 0;
-  m_fileSize = 0;
-  m_bufferSize = 0;
-  m_cancelled = false;
-  m_bFirstLoop = true;
-  m_headerdone = false;
-}
-
-CCurlFile::CReadState::~CReadState()
-{
-  Disconnect();
-
-  if(m_easyHandle)
-    g_curlInterface.easy_release(&m_easyHandle, &m_multiHandle);
-}
-
-bool CCurlFile::CReadState::Seek(int64_t pos)
-{
-  if(pos == m_filePos)
-    return true;
-
-  if(FITS_INT(pos - m_filePos) && m_buffer.SkipBytes((int)(pos - m_filePos)))
-  {
-    m_filePos = pos;
-    return true;
-  }
-
-  if(pos > m_filePos && pos < m_filePos + m_bufferSize)
-  {
-    int len = m_buffer.getMaxReadSize();
-    m_filePos += len;
-    m_buffer.SkipBytes(len);
-    if(!FillBuffer(m_bufferSize))
-    {
-      if(!m_buffer.SkipBytes(-len))
-        CLog::Log(LOGERROR, "%s - Failed to restore position after failed fill", __FUNCTION__);
-      else
-        m_filePos -= len;
-      return false;
-    }
-
-    if(!FITS_INT(pos - m_filePos) || !m_buffer.SkipBytes((int)(pos - m_filePos)))
-    {
-      CLog::Log(LOGERROR, "%s - Failed to skip to position after having filled buffer", __FUNCTION__);
-      if(!m_buffer.SkipBytes(-len))
-        CLog::Log(LOGERROR, "%s - Failed to restore position after failed seek", __FUNCTION__);
-      else
-        m_filePos -= len;
-      return false;
-    }
-    m_filePos = pos;
-    return true;
-  }
-  return false;
-}
-
-long CCurlFile::CReadState::Connect(unsigned int size)
-{
-  g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, m_filePos);
-  g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
-
-  m_bufferSize = size;
-  m_buffer.Destroy();
-  m_buffer.Create(size * 3);
-  m_headerdone = false;
-
-  // read some data in to try and obtain the length
-  // maybe there's a better way to get this info??
-  m_stillRunning = 1;
-  if (!FillBuffer(1))
-  {
-    CLog::Log(LOGERROR, "CCurlFile::CReadState::Open, didn't get any data from stream.");
-    return -1;
-  }
-
-  double length;
-  if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length))
-  {
-    if (length < 0)
-      length = 0.0;
-    m_fileSize = m_filePos + (int64_t)length;
-  }
-
-  long response;
-  if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_RESPONSE_CODE, &response))
-    return response;
-
-  return -1;
-}
-
-void CCurlFile::CReadState::Disconnect()
-{
-  if(m_multiHandle && m_easyHandle)
-    g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
-
-  m_buffer.Clear();
-  free(m_overflowBuffer);
-  m_overflowBuffer = NULL;
-  m_overflowSize = 0;
-  m_filePos = 0;
-  m_fileSize = 0;
-  m_bufferSize = 0;
-}
-
-
 CCurlFile::~CCurlFile()
 {
   if (m_opened)
@@ -313,6 +91,7 @@ CCurlFile::CCurlFile()
   m_curlHeaderList = NULL;
   m_opened = false;
   m_multisession  = true;
+  m_parallel = false;
   m_seekable = true;
   m_useOldHttpVersion = false;
   m_connecttimeout = 0;
@@ -564,6 +343,14 @@ void CCurlFile::SetCorrectHeaders(CReadState* state)
   }
 }
 
+void CCurlFile::SetupParallel(CReadState* state)
+{
+  if (m_parallel && state->m_fileSize > 0 && state->m_rangeEnd > 0)
+    state->EnableParallel(g_advancedSettings.m_curlconnections, g_advancedSettings.m_curlchunksize, g_advancedSettings.m_curlbuffersize);
+  else if (state->m_rangeEnd > 0 && (state->m_fileSize == 0 || state->m_rangeEnd < state->m_fileSize))
+    state->RequestPrimary(state->m_fillPos, 0); // a single connection goes on past the first range
+}
+
 void CCurlFile::ParseAndCorrectUrl(CURL &url2)
 {
   CStdString strProtocol = url2.GetTranslatedProtocol();
@@ -838,6 +625,13 @@ bool CCurlFile::Open(const CURL& url)
   SetCommonOptions(m_state);
   SetRequestHeaders(m_state);
 
+  // a request that may go parallel asks for the first range only, the
+  // answer tells whether the server honours ranges at all
+  m_state->m_rangeEnd = 0;
+  if((url2.GetProtocol().Equals("http") || url2.GetProtocol().Equals("https"))
+  && g_advancedSettings.m_curlconnections > 1 && m_contentencoding.IsEmpty() && m_postdata.IsEmpty())
+    m_state->m_rangeEnd = m_state->m_filePos + g_advancedSettings.m_curlchunksize;
+
   long response = m_state->Connect(m_bufferSize);
   if( response < 0 || response >= 400)
     return false;
@@ -888,6 +682,12 @@ bool CCurlFile::Open(const CURL& url)
     }
   }
 
+  // fetch over several connections only from servers that answered the first range
+  m_parallel = false;
+  if(m_seekable && m_multisession && m_state->m_rangeEnd > 0)
+    m_parallel = true;
+  SetupParallel(m_state);
+
   char* efurl;
   if (CURLE_OK == g_curlInterface.easy_getinfo(m_state->m_easyHandle, CURLINFO_EFFECTIVE_URL,&efurl) && efurl)
     m_url = efurl;
@@ -895,38 +695,6 @@ bool CCurlFile::Open(const CURL& url)
   return true;
 }
 
-bool CCurlFile::CReadState::ReadString(char *szLine, int iLineLength)
-{
-  unsigned int want = (unsigned int)iLineLength;
-
-  if((m_fileSize == 0 || m_filePos < m_fileSize) && !FillBuffer(want))
-    return false;
-
-  // ensure only available data is considered
-  want = XMIN((unsigned int)m_buffer.getMaxReadSize(), want);
-
-  /* check if we finished prematurely */
-  if (!m_stillRunning && (m_fileSize == 0 || m_filePos != m_fileSize) && !want)
-  {
-    if (m_fileSize != 0)
-      CLog::Log(LOGWARNING, "%s - Transfer ended before entire file was retrieved pos %"PRId64", size %"PRId64, __FUNCTION__, m_filePos, m_fileSize);
-
-    return false;
-  }
-
-  char* pLine = szLine;
-  do
-  {
-    if (!m_buffer.ReadData(pLine, 1))
-      break;
-
-    pLine++;
-  } while (((pLine - 1)[0] != '\n') && ((unsigned int)(pLine - szLine) < want));
-  pLine[0] = 0;
-  m_filePos += (pLine - szLine);
-  return (bool)((pLine - szLine) > 0);
-}
-
 bool CCurlFile::Exists(const CURL& url)
 {
   // if file is already running, get info from it
@@ -1016,6 +784,10 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   if (oldstate)
     m_state->m_fileSize = oldstate->m_fileSize;
 
+  m_state->m_rangeEnd = 0;
+  if (m_parallel && nextPos < m_state->m_fileSize)
+    m_state->m_rangeEnd = nextPos + g_advancedSettings.m_curlchunksize;
+
   long response = m_state->Connect(m_bufferSize);
   if(response < 0 && (m_state->m_fileSize == 0 || m_state->m_fileSize != m_state->m_filePos))
   {
@@ -1029,6 +801,7 @@ int64_t CCurlFile::Seek(int64_t iFilePosition, int iWhence)
   }
 
   SetCorrectHeaders(m_state);
+  SetupParallel(m_state);
   delete oldstate;
 
   return m_state->m_filePos;
@@ -1171,183 +944,6 @@ int CCurlFile::Stat(const CURL& url, struct __stat64* buffer)
   return 0;
 }
 
-unsigned int CCurlFile::CReadState::Read(void* lpBuf, int64_t uiBufSize)
-{
-  /* only request 1 byte, for truncated reads (only if not eof) */
-  if((m_fileSize == 0 || m_filePos < m_fileSize) && !FillBuffer(1))
-    return 0;
-
-  /* ensure only available data is considered */
-  unsigned int want = (unsigned int)XMIN(m_buffer.getMaxReadSize(), uiBufSize);
-
-  /* xfer data to caller */
-  if (m_buffer.ReadData((char *)lpBuf, want))
-  {
-    m_filePos += want;
-    return want;
-  }
-
-  /* check if we finished prematurely */
-  if (!m_stillRunning && (m_fileSize == 0 || m_filePos != m_fileSize))
-  {
-    CLog::Log(LOGWARNING, "%s - Transfer ended before entire file was retrieved pos %"PRId64", size %"PRId64, __FUNCTION__, m_filePos, m_fileSize);
-    return 0;
-  }
-
-  return 0;
-}
-
-/* use to attempt to fill the read buffer up to requested number of bytes */
-bool CCurlFile::CReadState::FillBuffer(unsigned int want)
-{
-  int retry=0;
-  fd_set fdread;
-  fd_set fdwrite;
-  fd_set fdexcep;
-
-  // only attempt to fill buffer if transactions still running and buffer
-  // doesnt exceed required size already
-  while ((unsigned int)m_buffer.getMaxReadSize() < want && m_buffer.getMaxWriteSize() > 0 )
-  {
-    if (m_cancelled)
-      return false;
-
-    /* if there is data in overflow buffer, try to use that first */
-    if (m_overflowSize)
-    {
-      unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
-      m_buffer.WriteData(m_overflowBuffer, amount);
-
-      if (amount < m_overflowSize)
-        memcpy(m_overflowBuffer, m_overflowBuffer+amount,m_overflowSize-amount);
-
-      m_overflowSize -= amount;
-      m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
-      continue;
-    }
-
-    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &m_stillRunning);
-    if (!m_stillRunning)
-    {
-      if (result == CURLM_OK)
-      {
-        /* if we still have stuff in buffer, we are fine */
-        if (m_buffer.getMaxReadSize())
-          return true;
-
-        /* verify that we are actually okey */
-        int msgs;
-        CURLcode CURLresult = CURLE_OK;
-        CURLMsg* msg;
-        while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
-        {
-          if (msg->msg == CURLMSG_DONE)
-          {
-            if (msg->data.result == CURLE_OK)
-              return true;
-
-            CLog::Log(LOGWARNING, "%s: curl failed with code %i", __FUNCTION__, msg->data.result);
-
-            // We need to check the data.result here as we don't want to retry on every error
-            if ( (msg->data.result == CURLE_OPERATION_TIMEDOUT ||
-                  msg->data.result == CURLE_PARTIAL_FILE       ||
-                  msg->data.result == CURLE_RECV_ERROR)        &&
-                  !m_bFirstLoop)
-              CURLresult=msg->data.result;
-            else
-              return false;
-          }
-        }
-
-        // Don't retry, when we didn't "see" any error
-        if (CURLresult == CURLE_OK)
-          return false;
-
-        // Close handle
-        if (m_multiHandle && m_easyHandle)
-          g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
-
-        // Reset all the stuff like we would in Disconnect()
-        m_buffer.Clear();
-        free(m_overflowBuffer);
-        m_overflowBuffer = NULL;
-        m_overflowSize = 0;
-
-        // If we got here something is wrong
-        if (++retry > g_advancedSettings.m_curlretries)
-        {
-          CLog::Log(LOGWARNING, "%s: Reconnect failed!", __FUNCTION__);
-          // Reset the rest of the variables like we would in Disconnect()
-          m_filePos = 0;
-          m_fileSize = 0;
-          m_bufferSize = 0;
-
-          return false;
-        }
-
-        CLog::Log(LOGDEBUG, "%s: Reconnect, (re)try %i", __FUNCTION__, retry);
-
-        // Connect + seek to current position (again)
-        g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, m_filePos);
-        g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
-
-        // Return to the beginning of the loop:
-        continue;
-      }
-      return false;
-    }
-
-    // We've finished out first loop
-    if(m_bFirstLoop && m_buffer.getMaxReadSize() > 0)
-      m_bFirstLoop = false;
-
-    switch (result)
-    {
-      case CURLM_OK:
-      {
-        int maxfd = -1;
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
-
-        // get file descriptors from the transfers
-        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-        long timeout = 0;
-        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1)
-          timeout = 200;
-
-        struct timeval t = { timeout / 1000, (timeout % 1000) * 1000 };
-
-        /* Wait until data is available or a timeout occurs.
-           We call dllselect(maxfd + 1, ...), specially in case of (maxfd == -1),
-           we call dllselect(0, ...), which is basically equal to sleep. */
-        if (SOCKET_ERROR == dllselect(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t))
-        {
-          CLog::Log(LOGERROR, "%s - curl failed with socket error", __FUNCTION__);
-          return false;
-        }
-      }
-      break;
-      case CURLM_CALL_MULTI_PERFORM:
-      {
-        // we don't keep calling here as that can easily overwrite our buffer which we want to avoid
-        // docs says we should call it soon after, but aslong as we are reading data somewhere
-        // this aught to be soon enough. should stay in socket otherwise
-        continue;
-      }
-      break;
-      default:
-      {
-        CLog::Log(LOGERROR, "%s - curl multi perform failed with code %d, aborting", __FUNCTION__, result);
-        return false;
-      }
-      break;
-    }
-  }
-  return true;
-}
-
 void CCurlFile::ClearRequestHeaders()
 {
   m_requestheaders.clear();
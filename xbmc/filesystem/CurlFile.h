@@ -23,6 +23,8 @@
 #include "IFile.h"
 #include "utils/RingBuffer.h"
 #include <map>
+#include <deque>
+#include <vector>
 #include "utils/HttpHeader.h"
 
 namespace XCURL
@@ -101,6 +103,7 @@ namespace XFILE
           bool            m_cancelled;
           int64_t         m_fileSize;
           int64_t         m_filePos;
+          int64_t         m_rangeEnd;         // end of the range asked of the primary connection, 0 for all of the file
           bool            m_bFirstLoop;
 
           /* returned http header */
@@ -114,9 +117,57 @@ namespace XFILE
           unsigned int Read(void* lpBuf, int64_t uiBufSize);
           bool         ReadString(char *szLine, int iLineLength);
           bool         FillBuffer(unsigned int want);
+          void         FlushOverflow();
 
           long         Connect(unsigned int size);
           void         Disconnect();
+          void         RequestPrimary(int64_t pos, int64_t end);
+
+          /* parallel fetching, the file is requested in consecutive ranges over */
+          /* several connections of the multi handle and reassembled in order    */
+          struct SChunk
+          {
+            XCURL::CURL_HANDLE* m_easyHandle;
+            CReadState*     m_state;
+            int64_t         m_start;      // file position of the first byte of the range
+            unsigned int    m_length;
+            unsigned int    m_received;
+            unsigned int    m_consumed;   // bytes already moved to the ring buffer
+            char *          m_data;
+            int             m_retries;
+            bool            m_running;
+            bool            m_checked;    // response verified to be a partial content
+            bool            m_unranged;   // server ignored the range request
+          };
+
+          std::deque<SChunk*>               m_chunks;
+          std::vector<XCURL::CURL_HANDLE*>  m_idleHandles;
+          bool            m_parallel;
+          bool            m_primaryDone;      // primary connection delivered its range
+          int             m_primaryRetries;
+          int64_t         m_primaryEnd;       // end of the range served by the primary connection
+          int64_t         m_fillPos;          // file position of the next byte entering the ring buffer
+          int64_t         m_nextChunk;        // file position of the next range to request
+          unsigned int    m_chunkSize;
+          unsigned int    m_maxBuffered;      // most bytes held in ranges at once
+          unsigned int    m_connections;      // current number of concurrent transfers
+          unsigned int    m_maxConnections;
+          int64_t         m_rateBytes;
+          unsigned int    m_rateTime;
+          unsigned int    m_rateTick;
+          double          m_rateLast;
+          bool            m_rateLimited;      // transfers were held back by buffer space
+
+          size_t ChunkWriteCallback(SChunk* chunk, char *buffer, size_t size, size_t nitems);
+
+          void         EnableParallel(unsigned int connections, unsigned int chunkSize, unsigned int maxBuffered);
+          void         DisableParallel();
+          bool         FillBufferParallel(unsigned int want);
+          bool         StartChunk();
+          void         StartTransfer(SChunk* chunk);
+          bool         ProcessTransfers();
+          void         AdaptConnections();
+          void         ReleaseChunk(SChunk* chunk);
       };
 
     protected:
@@ -124,6 +175,7 @@ namespace XFILE
       void SetCommonOptions(CReadState* state);
       void SetRequestHeaders(CReadState* state);
       void SetCorrectHeaders(CReadState* state);
+      void SetupParallel(CReadState* state);
       bool Service(const CStdString& strURL, const CStdString& strPostData, CStdString& strHTML);
 
     private:
@@ -153,6 +205,7 @@ namespace XFILE
       bool            m_useOldHttpVersion;
       bool            m_seekable;
       bool            m_multisession;
+      bool            m_parallel;
       bool            m_skipshout;
 
       CRingBuffer     m_buffer;           // our ringhold buffer
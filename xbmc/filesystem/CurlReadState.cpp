@@ -0,0 +1,905 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/* the read side of CCurlFile, filling the ring buffer from one connection or */
+/* from ranges fetched over several, kept apart so it can be tested alone     */
+
+#include "CurlFile.h"
+#include "settings/AdvancedSettings.h"
+
+#include <vector>
+#include <climits>
+
+#ifdef _LINUX
+#include <inttypes.h>
+#include "PlatformDefs.h"
+#endif
+
+#include "DllLibCurl.h"
+#include "utils/log.h"
+#include "threads/SystemClock.h"
+
+using namespace XFILE;
+using namespace XCURL;
+
+#define XMIN(a,b) ((a)<(b)?(a):(b))
+#define FITS_INT(a) (((a) <= INT_MAX) && ((a) >= INT_MIN))
+
+#define dllselect select
+
+/* curl calls this routine to get more data */
+extern "C" size_t write_callback(char *buffer,
+               size_t size,
+               size_t nitems,
+               void *userp)
+{
+  if(userp == NULL) return 0;
+
+  CCurlFile::CReadState *state = (CCurlFile::CReadState *)userp;
+  return state->WriteCallback(buffer, size, nitems);
+}
+
+extern "C" size_t header_callback(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+  CCurlFile::CReadState *state = (CCurlFile::CReadState *)stream;
+  return state->HeaderCallback(ptr, size, nmemb);
+}
+
+/* curl calls these routines for the additional connections of a parallel fetch */
+extern "C" size_t chunk_write_callback(char *buffer,
+               size_t size,
+               size_t nitems,
+               void *userp)
+{
+  if(userp == NULL) return 0;
+
+  CCurlFile::CReadState::SChunk *chunk = (CCurlFile::CReadState::SChunk *)userp;
+  return chunk->m_state->ChunkWriteCallback(chunk, buffer, size, nitems);
+}
+
+extern "C" size_t chunk_header_callback(void *ptr, size_t size, size_t nmemb, void *stream)
+{
+  // headers of the primary connection are the ones reported
+  return size * nmemb;
+}
+
+/* fix for silly behavior of realloc */
+static inline void* realloc_simple(void *ptr, size_t size)
+{
+  void *ptr2 = realloc(ptr, size);
+  if(ptr && !ptr2 && size > 0)
+  {
+    free(ptr);
+    return NULL;
+  }
+  else
+    return ptr2;
+}
+
+size_t CCurlFile::CReadState::HeaderCallback(void *ptr, size_t size, size_t nmemb)
+{
+  // clear any previous header
+  if(m_headerdone)
+  {
+    m_httpheader.Clear();
+    m_headerdone = false;
+  }
+
+  // libcurl doc says that this info is not always \0 terminated
+  char* strData = (char*)ptr;
+  int iSize = size * nmemb;
+
+  if (strData[iSize] != 0)
+  {
+    strData = (char*)malloc(iSize + 1);
+    strncpy(strData, (char*)ptr, iSize);
+    strData[iSize] = 0;
+  }
+  else strData = strdup((char*)ptr);
+
+  if(strcmp(strData, "\r\n") == 0)
+    m_headerdone = true;
+
+  m_httpheader.Parse(strData);
+
+  free(strData);
+
+  return iSize;
+}
+
+size_t CCurlFile::CReadState::WriteCallback(char *buffer, size_t size, size_t nitems)
+{
+  unsigned int amount = size * nitems;
+  unsigned int accepted = amount;
+//  CLog::Log(LOGDEBUG, "CCurlFile::WriteCallback (%p) with %i bytes, readsize = %i, writesize = %i", this, amount, m_buffer.getMaxReadSize(), m_buffer.getMaxWriteSize() - m_overflowSize);
+  if (m_overflowSize)
+  {
+    // we have our overflow buffer - first get rid of as much as we can
+    unsigned int maxWriteable = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
+    if (maxWriteable)
+    {
+      if (!m_buffer.WriteData(m_overflowBuffer, maxWriteable))
+        CLog::Log(LOGERROR, "Unable to write to buffer - what's up?");
+      if (m_overflowSize > maxWriteable)
+      { // still have some more - copy it down
+        memmove(m_overflowBuffer, m_overflowBuffer + maxWriteable, m_overflowSize - maxWriteable);
+      }
+      m_overflowSize -= maxWriteable;
+    }
+  }
+  // ok, now copy the data into our ring buffer
+  unsigned int maxWriteable = XMIN((unsigned int)m_buffer.getMaxWriteSize(), amount);
+  if (maxWriteable)
+  {
+    if (!m_buffer.WriteData(buffer, maxWriteable))
+    {
+      CLog::Log(LOGERROR, "%s - Unable to write to buffer with %i bytes - what's up?", __FUNCTION__, maxWriteable);
+    }
+    else
+    {
+      amount -= maxWriteable;
+      buffer += maxWriteable;
+    }
+  }
+  if (amount)
+  {
+//    CLog::Log(LOGDEBUG, "CCurlFile::WriteCallback(%p) not enough free space for %i bytes", (void*)this,  amount);
+
+    m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, amount + m_overflowSize);
+    if(m_overflowBuffer == NULL)
+    {
+      CLog::Log(LOGWARNING, "%s - Failed to grow overflow buffer from %i bytes to %i bytes", __FUNCTION__, m_overflowSize, amount + m_overflowSize);
+      return 0;
+    }
+    memcpy(m_overflowBuffer + m_overflowSize, buffer, amount);
+    m_overflowSize += amount;
+  }
+  m_fillPos += accepted;
+  m_rateBytes += accepted;
+  return accepted;
+}
+
+size_t CCurlFile::CReadState::ChunkWriteCallback(SChunk* chunk, char *buffer, size_t size, size_t nitems)
+{
+  unsigned int amount = size * nitems;
+  if (!chunk->m_checked)
+  {
+    // a server ignoring the range would send us the file from its start
+    long response = 0;
+    g_curlInterface.easy_getinfo(chunk->m_easyHandle, CURLINFO_RESPONSE_CODE, &response);
+    if (response != 206)
+    {
+      chunk->m_unranged = true;
+      return 0;
+    }
+    chunk->m_checked = true;
+  }
+
+  amount = XMIN(amount, chunk->m_length - chunk->m_received);
+  memcpy(chunk->m_data + chunk->m_received, buffer, amount);
+  chunk->m_received += amount;
+  m_rateBytes += amount;
+  return amount;
+}
+
+CCurlFile::CReadState::CReadState()
+{
+  m_easyHandle = NULL;
+  m_multiHandle = NULL;
+  m_overflowBuffer = NULL;
+  m_overflowSize = 0;
+  m_filePos = 0;
+  m_fileSize = 0;
+  m_rangeEnd = 0;
+  m_bufferSize = 0;
+  m_cancelled = false;
+  m_bFirstLoop = true;
+  m_headerdone = false;
+  m_parallel = false;
+  m_primaryDone = false;
+  m_primaryRetries = 0;
+  m_primaryEnd = 0;
+  m_fillPos = 0;
+  m_nextChunk = 0;
+  m_chunkSize = 0;
+  m_maxBuffered = 0;
+  m_connections = 0;
+  m_maxConnections = 0;
+  m_rateBytes = 0;
+  m_rateTime = 0;
+  m_rateTick = 0;
+  m_rateLast = 0.0;
+  m_rateLimited = false;
+}
+
+CCurlFile::CReadState::~CReadState()
+{
+  Disconnect();
+
+  if(m_easyHandle)
+    g_curlInterface.easy_release(&m_easyHandle, &m_multiHandle);
+}
+
+bool CCurlFile::CReadState::Seek(int64_t pos)
+{
+  if(pos == m_filePos)
+    return true;
+
+  if(FITS_INT(pos - m_filePos) && m_buffer.SkipBytes((int)(pos - m_filePos)))
+  {
+    m_filePos = pos;
+    return true;
+  }
+
+  if(pos > m_filePos && pos < m_filePos + m_bufferSize)
+  {
+    int len = m_buffer.getMaxReadSize();
+    m_filePos += len;
+    m_buffer.SkipBytes(len);
+    if(!FillBuffer(m_bufferSize))
+    {
+      if(!m_buffer.SkipBytes(-len))
+        CLog::Log(LOGERROR, "%s - Failed to restore position after failed fill", __FUNCTION__);
+      else
+        m_filePos -= len;
+      return false;
+    }
+
+    if(!FITS_INT(pos - m_filePos) || !m_buffer.SkipBytes((int)(pos - m_filePos)))
+    {
+      CLog::Log(LOGERROR, "%s - Failed to skip to position after having filled buffer", __FUNCTION__);
+      if(!m_buffer.SkipBytes(-len))
+        CLog::Log(LOGERROR, "%s - Failed to restore position after failed seek", __FUNCTION__);
+      else
+        m_filePos -= len;
+      return false;
+    }
+    m_filePos = pos;
+    return true;
+  }
+  return false;
+}
+
+long CCurlFile::CReadState::Connect(unsigned int size)
+{
+  RequestPrimary(m_filePos, m_rangeEnd);
+
+  m_fillPos = m_filePos;
+  m_bufferSize = size;
+  m_buffer.Destroy();
+  m_buffer.Create(size * 3);
+  m_headerdone = false;
+
+  // read some data in to try and obtain the length
+  // maybe there's a better way to get this info??
+  m_stillRunning = 1;
+  if (!FillBuffer(1))
+  {
+    CLog::Log(LOGERROR, "CCurlFile::CReadState::Open, didn't get any data from stream.");
+    return -1;
+  }
+
+  long response;
+  if (CURLE_OK != g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_RESPONSE_CODE, &response))
+    response = -1;
+
+  if (m_rangeEnd && response != 206)
+  {
+    // an ignored range means the data starts at the beginning of the file,
+    // resuming lets curl verify the server can start anywhere else. a file
+    // shorter than the range start, like an empty one, can't be ranged at all
+    m_rangeEnd = 0;
+    if (response == 416 || (response >= 200 && response < 300 && m_filePos > 0))
+    {
+      m_overflowSize = 0;
+      return Connect(size);
+    }
+  }
+
+  if (m_rangeEnd)
+  {
+    // the length is the one of the range, the file size follows it as in "bytes 0-1023/4096"
+    CStdString contentRange = m_httpheader.GetValue("Content-Range");
+    int total = contentRange.ReverseFind('/');
+    m_fileSize = total < 0 ? 0 : strtoll(contentRange.c_str() + total + 1, NULL, 10);
+  }
+  else
+  {
+    double length;
+    if (CURLE_OK == g_curlInterface.easy_getinfo(m_easyHandle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length))
+    {
+      if (length < 0)
+        length = 0.0;
+      m_fileSize = m_filePos + (int64_t)length;
+    }
+  }
+
+  return response;
+}
+
+void CCurlFile::CReadState::RequestPrimary(int64_t pos, int64_t end)
+{
+  // a bounded request ends cleanly at its last byte, so its connection stays open
+  g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+  if (end > pos)
+  {
+    CStdString range;
+    range.Format("%"PRId64"-%"PRId64, pos, end - 1);
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, range.c_str());
+    m_rangeEnd = end;
+  }
+  else
+  {
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RANGE, (char*)NULL);
+    g_curlInterface.easy_setopt(m_easyHandle, CURLOPT_RESUME_FROM_LARGE, pos);
+    m_rangeEnd = 0;
+  }
+  g_curlInterface.multi_add_handle(m_multiHandle, m_easyHandle);
+  m_stillRunning = 1;
+}
+
+void CCurlFile::CReadState::Disconnect()
+{
+  if(m_multiHandle && m_easyHandle)
+    g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+
+  DisableParallel();
+  for (std::vector<CURL_HANDLE*>::iterator it = m_idleHandles.begin(); it != m_idleHandles.end(); ++it)
+    g_curlInterface.easy_release(&(*it), NULL);
+  m_idleHandles.clear();
+
+  m_buffer.Clear();
+  free(m_overflowBuffer);
+  m_overflowBuffer = NULL;
+  m_overflowSize = 0;
+  m_filePos = 0;
+  m_fileSize = 0;
+  m_bufferSize = 0;
+}
+
+
+bool CCurlFile::CReadState::ReadString(char *szLine, int iLineLength)
+{
+  unsigned int want = (unsigned int)iLineLength;
+
+  if((m_fileSize == 0 || m_filePos < m_fileSize) && !FillBuffer(want))
+    return false;
+
+  // ensure only available data is considered
+  want = XMIN((unsigned int)m_buffer.getMaxReadSize(), want);
+
+  /* check if we finished prematurely */
+  if (!m_stillRunning && (m_fileSize == 0 || m_filePos != m_fileSize) && !want)
+  {
+    if (m_fileSize != 0)
+      CLog::Log(LOGWARNING, "%s - Transfer ended before entire file was retrieved pos %"PRId64", size %"PRId64, __FUNCTION__, m_filePos, m_fileSize);
+
+    return false;
+  }
+
+  char* pLine = szLine;
+  do
+  {
+    if (!m_buffer.ReadData(pLine, 1))
+      break;
+
+    pLine++;
+  } while (((pLine - 1)[0] != '\n') && ((unsigned int)(pLine - szLine) < want));
+  pLine[0] = 0;
+  m_filePos += (pLine - szLine);
+  return (bool)((pLine - szLine) > 0);
+}
+
+unsigned int CCurlFile::CReadState::Read(void* lpBuf, int64_t uiBufSize)
+{
+  /* only request 1 byte, for truncated reads (only if not eof) */
+  if((m_fileSize == 0 || m_filePos < m_fileSize) && !FillBuffer(1))
+    return 0;
+
+  /* ensure only available data is considered */
+  unsigned int want = (unsigned int)XMIN(m_buffer.getMaxReadSize(), uiBufSize);
+
+  /* xfer data to caller */
+  if (m_buffer.ReadData((char *)lpBuf, want))
+  {
+    m_filePos += want;
+    return want;
+  }
+
+  /* check if we finished prematurely */
+  if (!m_stillRunning && (m_fileSize == 0 || m_filePos != m_fileSize))
+  {
+    CLog::Log(LOGWARNING, "%s - Transfer ended before entire file was retrieved pos %"PRId64", size %"PRId64, __FUNCTION__, m_filePos, m_fileSize);
+    return 0;
+  }
+
+  return 0;
+}
+
+/* use to attempt to fill the read buffer up to requested number of bytes */
+bool CCurlFile::CReadState::FillBuffer(unsigned int want)
+{
+  int retry=0;
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+
+  if (m_parallel)
+    return FillBufferParallel(want);
+
+  // only attempt to fill buffer if transactions still running and buffer
+  // doesnt exceed required size already
+  while ((unsigned int)m_buffer.getMaxReadSize() < want && m_buffer.getMaxWriteSize() > 0 )
+  {
+    if (m_cancelled)
+      return false;
+
+    /* if there is data in overflow buffer, try to use that first */
+    if (m_overflowSize)
+    {
+      FlushOverflow();
+      continue;
+    }
+
+    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &m_stillRunning);
+
+    // We've finished out first loop, also when it ended the transfer
+    if(m_bFirstLoop && m_buffer.getMaxReadSize() > 0)
+      m_bFirstLoop = false;
+
+    if (!m_stillRunning)
+    {
+      if (result == CURLM_OK)
+      {
+        /* if we still have stuff in buffer, we are fine */
+        if (m_buffer.getMaxReadSize())
+          return true;
+
+        /* verify that we are actually okey */
+        int msgs;
+        CURLcode CURLresult = CURLE_OK;
+        CURLMsg* msg;
+        while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
+        {
+          if (msg->msg == CURLMSG_DONE)
+          {
+            if (msg->data.result == CURLE_OK)
+              return true;
+
+            CLog::Log(LOGWARNING, "%s: curl failed with code %i", __FUNCTION__, msg->data.result);
+
+            // We need to check the data.result here as we don't want to retry on every error
+            if ( (msg->data.result == CURLE_OPERATION_TIMEDOUT ||
+                  msg->data.result == CURLE_PARTIAL_FILE       ||
+                  msg->data.result == CURLE_RECV_ERROR)        &&
+                  !m_bFirstLoop)
+              CURLresult=msg->data.result;
+            else
+              return false;
+          }
+        }
+
+        // Don't retry, when we didn't "see" any error
+        if (CURLresult == CURLE_OK)
+          return false;
+
+        // Close handle
+        if (m_multiHandle && m_easyHandle)
+          g_curlInterface.multi_remove_handle(m_multiHandle, m_easyHandle);
+
+        // Reset all the stuff like we would in Disconnect()
+        m_buffer.Clear();
+        free(m_overflowBuffer);
+        m_overflowBuffer = NULL;
+        m_overflowSize = 0;
+
+        // If we got here something is wrong
+        if (++retry > g_advancedSettings.m_curlretries)
+        {
+          CLog::Log(LOGWARNING, "%s: Reconnect failed!", __FUNCTION__);
+          // Reset the rest of the variables like we would in Disconnect()
+          m_filePos = 0;
+          m_fileSize = 0;
+          m_bufferSize = 0;
+
+          return false;
+        }
+
+        CLog::Log(LOGDEBUG, "%s: Reconnect, (re)try %i", __FUNCTION__, retry);
+
+        // Connect + seek to current position (again)
+        m_fillPos = m_filePos;
+        RequestPrimary(m_filePos, 0);
+
+        // Return to the beginning of the loop:
+        continue;
+      }
+      return false;
+    }
+
+    switch (result)
+    {
+      case CURLM_OK:
+      {
+        int maxfd = -1;
+        FD_ZERO(&fdread);
+        FD_ZERO(&fdwrite);
+        FD_ZERO(&fdexcep);
+
+        // get file descriptors from the transfers
+        g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+        long timeout = 0;
+        if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1)
+          timeout = 200;
+
+        struct timeval t = { timeout / 1000, (timeout % 1000) * 1000 };
+
+        /* Wait until data is available or a timeout occurs.
+           We call dllselect(maxfd + 1, ...), specially in case of (maxfd == -1),
+           we call dllselect(0, ...), which is basically equal to sleep. */
+        if (SOCKET_ERROR == dllselect(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t))
+        {
+          CLog::Log(LOGERROR, "%s - curl failed with socket error", __FUNCTION__);
+          return false;
+        }
+      }
+      break;
+      case CURLM_CALL_MULTI_PERFORM:
+      {
+        // we don't keep calling here as that can easily overwrite our buffer which we want to avoid
+        // docs says we should call it soon after, but aslong as we are reading data somewhere
+        // this aught to be soon enough. should stay in socket otherwise
+        continue;
+      }
+      break;
+      default:
+      {
+        CLog::Log(LOGERROR, "%s - curl multi perform failed with code %d, aborting", __FUNCTION__, result);
+        return false;
+      }
+      break;
+    }
+  }
+  return true;
+}
+
+void CCurlFile::CReadState::FlushOverflow()
+{
+  unsigned amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), m_overflowSize);
+  m_buffer.WriteData(m_overflowBuffer, amount);
+
+  if (amount < m_overflowSize)
+    memmove(m_overflowBuffer, m_overflowBuffer+amount,m_overflowSize-amount);
+
+  m_overflowSize -= amount;
+  m_overflowBuffer = (char*)realloc_simple(m_overflowBuffer, m_overflowSize);
+}
+
+void CCurlFile::CReadState::EnableParallel(unsigned int connections, unsigned int chunkSize, unsigned int maxBuffered)
+{
+  // the primary connection serves the range it was opened with,
+  // the ranges after it are requested over connections added as needed
+  m_parallel = true;
+  m_primaryDone = false;
+  m_primaryRetries = 0;
+  m_primaryEnd = XMIN(m_rangeEnd, m_fileSize);
+  m_nextChunk = m_primaryEnd;
+  m_chunkSize = chunkSize;
+  m_maxBuffered = maxBuffered;
+  m_maxConnections = connections;
+  m_connections = XMIN(2, connections);
+  m_rateBytes = 0;
+  m_rateTime = 0;
+  m_rateLast = 0.0;
+  m_rateLimited = false;
+}
+
+void CCurlFile::CReadState::DisableParallel()
+{
+  while (!m_chunks.empty())
+  {
+    ReleaseChunk(m_chunks.front());
+    m_chunks.pop_front();
+  }
+  m_parallel = false;
+}
+
+void CCurlFile::CReadState::ReleaseChunk(SChunk* chunk)
+{
+  if (chunk->m_easyHandle)
+  {
+    if (chunk->m_running)
+      g_curlInterface.multi_remove_handle(m_multiHandle, chunk->m_easyHandle);
+
+    // keep the handle, and so its connection, for the next range
+    m_idleHandles.push_back(chunk->m_easyHandle);
+  }
+  free(chunk->m_data);
+  delete chunk;
+}
+
+bool CCurlFile::CReadState::StartChunk()
+{
+  if (m_nextChunk >= m_fileSize)
+    return false;
+
+  unsigned int running = m_primaryDone ? 0 : 1;
+  for (std::deque<SChunk*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+  {
+    if ((*it)->m_running)
+      running++;
+  }
+  if (running >= m_connections)
+    return false;
+
+  // don't let completed ranges pile up while the reader is slower than the link,
+  // every range holds a buffer of its full length until the reader is past it
+  unsigned int length = (unsigned int)XMIN((int64_t)m_chunkSize, m_fileSize - m_nextChunk);
+  uint64_t buffered = length;
+  for (std::deque<SChunk*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    buffered += (*it)->m_length;
+  if (!m_chunks.empty() && buffered > m_maxBuffered)
+  {
+    m_rateLimited = true;
+    return false;
+  }
+
+  CURL_HANDLE* easy = NULL;
+  if (!m_idleHandles.empty())
+  {
+    easy = m_idleHandles.back();
+    m_idleHandles.pop_back();
+  }
+  else
+  {
+    g_curlInterface.easy_duplicate(m_easyHandle, NULL, &easy, NULL);
+    if (!easy)
+      return false;
+
+    g_curlInterface.easy_setopt(easy, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+    g_curlInterface.easy_setopt(easy, CURLOPT_WRITEFUNCTION, chunk_write_callback);
+    g_curlInterface.easy_setopt(easy, CURLOPT_HEADERFUNCTION, chunk_header_callback);
+  }
+
+  SChunk* chunk = new SChunk();
+  chunk->m_easyHandle = easy;
+  chunk->m_state = this;
+  chunk->m_start = m_nextChunk;
+  chunk->m_length = length;
+  chunk->m_data = (char*)malloc(chunk->m_length);
+  if (!chunk->m_data)
+  {
+    CLog::Log(LOGERROR, "%s - Failed to allocate %u bytes for range", __FUNCTION__, chunk->m_length);
+    m_idleHandles.push_back(easy);
+    delete chunk;
+    return false;
+  }
+
+  m_nextChunk += chunk->m_length;
+  m_chunks.push_back(chunk);
+  StartTransfer(chunk);
+  return true;
+}
+
+void CCurlFile::CReadState::StartTransfer(SChunk* chunk)
+{
+  CStdString range;
+  range.Format("%"PRId64"-%"PRId64, chunk->m_start + chunk->m_received, chunk->m_start + chunk->m_length - 1);
+
+  g_curlInterface.easy_setopt(chunk->m_easyHandle, CURLOPT_WRITEDATA, chunk);
+  g_curlInterface.easy_setopt(chunk->m_easyHandle, CURLOPT_RANGE, range.c_str());
+  g_curlInterface.multi_add_handle(m_multiHandle, chunk->m_easyHandle);
+  chunk->m_checked = false;
+  chunk->m_running = true;
+}
+
+bool CCurlFile::CReadState::ProcessTransfers()
+{
+  int msgs;
+  CURLMsg* msg;
+  while ((msg = g_curlInterface.multi_info_read(m_multiHandle, &msgs)))
+  {
+    if (msg->msg != CURLMSG_DONE)
+      continue;
+
+    // the message doesn't survive the removal of its handle
+    CURL_HANDLE* easy = msg->easy_handle;
+    CURLcode result = msg->data.result;
+    g_curlInterface.multi_remove_handle(m_multiHandle, easy);
+
+    if (easy == m_easyHandle)
+    {
+      if (m_fillPos >= m_primaryEnd)
+      {
+        m_primaryDone = true;
+        continue;
+      }
+
+      if (++m_primaryRetries > g_advancedSettings.m_curlretries)
+      {
+        CLog::Log(LOGWARNING, "%s - curl failed with code %i", __FUNCTION__, result);
+        return false;
+      }
+
+      CLog::Log(LOGDEBUG, "%s - Reconnect, (re)try %i", __FUNCTION__, m_primaryRetries);
+      RequestPrimary(m_fillPos, m_primaryEnd);
+      continue;
+    }
+
+    for (std::deque<SChunk*>::iterator it = m_chunks.begin(); it != m_chunks.end(); ++it)
+    {
+      SChunk* chunk = *it;
+      if (chunk->m_easyHandle != easy)
+        continue;
+
+      chunk->m_running = false;
+      if (chunk->m_received == chunk->m_length)
+      {
+        // the range now only waits for the reader, its handle can serve the next one
+        m_idleHandles.push_back(chunk->m_easyHandle);
+        chunk->m_easyHandle = NULL;
+        break;
+      }
+
+      if (chunk->m_unranged)
+      {
+        CLog::Log(LOGWARNING, "%s - server doesn't honour range requests, continuing over a single connection", __FUNCTION__);
+        DisableParallel();
+
+        // resuming can fail the same way, but it is all that is left
+        RequestPrimary(m_fillPos, 0);
+        return true;
+      }
+
+      if (++chunk->m_retries > g_advancedSettings.m_curlretries)
+      {
+        CLog::Log(LOGWARNING, "%s - curl failed with code %i for range at %"PRId64, __FUNCTION__, result, chunk->m_start);
+        return false;
+      }
+
+      CLog::Log(LOGDEBUG, "%s - Reconnect range at %"PRId64", (re)try %i", __FUNCTION__, chunk->m_start, chunk->m_retries);
+      StartTransfer(chunk);
+      break;
+    }
+  }
+  return true;
+}
+
+void CCurlFile::CReadState::AdaptConnections()
+{
+  if (m_rateTime < 2000)
+    return;
+
+  // keep adding connections while they raise the throughput, and drop one
+  // when it falls. a period where the reader held the transfers back tells
+  // nothing about the link.
+  if (!m_rateLimited)
+  {
+    double rate = m_rateBytes * 1000.0 / m_rateTime;
+    unsigned int connections = m_connections;
+    if (rate > m_rateLast * 1.1 && m_connections < m_maxConnections)
+      m_connections++;
+    else if (rate < m_rateLast * 0.9 && m_connections > 1)
+      m_connections--;
+
+    if (connections != m_connections)
+      CLog::Log(LOGDEBUG, "%s - %.0f kB/s, using %u connections", __FUNCTION__, rate / 1024, m_connections);
+    m_rateLast = rate;
+  }
+
+  m_rateBytes = 0;
+  m_rateTime = 0;
+  m_rateLimited = false;
+}
+
+bool CCurlFile::CReadState::FillBufferParallel(unsigned int want)
+{
+  fd_set fdread;
+  fd_set fdwrite;
+  fd_set fdexcep;
+
+  m_rateTick = XbmcThreads::SystemClockMillis();
+  for (;;)
+  {
+    if (m_cancelled)
+      return false;
+
+    while (StartChunk())
+      ;
+
+    // transfers progress only in here, so drive them on every call
+    int running;
+    CURLMcode result = g_curlInterface.multi_perform(m_multiHandle, &running);
+    if (result != CURLM_OK && result != CURLM_CALL_MULTI_PERFORM)
+    {
+      CLog::Log(LOGERROR, "%s - curl multi perform failed with code %d, aborting", __FUNCTION__, result);
+      return false;
+    }
+
+    if (!ProcessTransfers())
+      return false;
+
+    if (!m_parallel)
+      return FillBuffer(want);
+
+    unsigned int now = XbmcThreads::SystemClockMillis();
+    m_rateTime += now - m_rateTick;
+    m_rateTick = now;
+    AdaptConnections();
+
+    // data of the primary connection first, then the ranges in order
+    if (m_overflowSize)
+      FlushOverflow();
+
+    while (m_primaryDone && !m_chunks.empty() && m_overflowSize == 0)
+    {
+      SChunk* chunk = m_chunks.front();
+      unsigned int amount = XMIN((unsigned int)m_buffer.getMaxWriteSize(), chunk->m_received - chunk->m_consumed);
+      if (amount == 0)
+        break;
+
+      m_buffer.WriteData(chunk->m_data + chunk->m_consumed, amount);
+      chunk->m_consumed += amount;
+      m_fillPos += amount;
+      if (chunk->m_consumed < chunk->m_length)
+        break;
+
+      m_chunks.pop_front();
+      ReleaseChunk(chunk);
+    }
+
+    if ((unsigned int)m_buffer.getMaxReadSize() >= want || m_buffer.getMaxWriteSize() == 0)
+      break;
+
+    if (m_primaryDone && m_chunks.empty() && m_nextChunk >= m_fileSize)
+    {
+      m_stillRunning = 0;
+      return m_buffer.getMaxReadSize() > 0;
+    }
+
+    if (result == CURLM_CALL_MULTI_PERFORM)
+      continue;
+
+    int maxfd = -1;
+    FD_ZERO(&fdread);
+    FD_ZERO(&fdwrite);
+    FD_ZERO(&fdexcep);
+
+    // get file descriptors from the transfers
+    g_curlInterface.multi_fdset(m_multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+
+    long timeout = 0;
+    if (CURLM_OK != g_curlInterface.multi_timeout(m_multiHandle, &timeout) || timeout == -1)
+      timeout = 200;
+
+    struct timeval t = { timeout / 1000, (timeout % 1000) * 1000 };
+    if (SOCKET_ERROR == dllselect(maxfd + 1, &fdread, &fdwrite, &fdexcep, &t))
+    {
+      CLog::Log(LOGERROR, "%s - curl failed with socket error", __FUNCTION__);
+      return false;
+    }
+  }
+
+  m_stillRunning = 1;
+  return true;
+}
@@ -25,6 +25,7 @@
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
+#include "settings/AdvancedSettings.h"
 
 #include <assert.h>
 
@@ -36,6 +37,23 @@ static long g_curlReferences = 0;
 static unsigned int g_curlTimeout = 0;
 #endif
 
+/* curl calls these routines to guard the data shared between handles */
+extern "C" void share_lock_callback(CURL_HANDLE *handle, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+  ((DllLibCurlGlobal*)userptr)->m_shareLocks[data].lock();
+}
+
+extern "C" void share_unlock_callback(CURL_HANDLE *handle, curl_lock_data data, void *userptr)
+{
+  ((DllLibCurlGlobal*)userptr)->m_shareLocks[data].unlock();
+}
+
+DllLibCurlGlobal::DllLibCurlGlobal()
+{
+  m_share = NULL;
+  memset(&m_stats, 0, sizeof(m_stats));
+}
+
 bool DllLibCurlGlobal::Load()
 {
   CSingleLock lock(m_critSection);
@@ -57,6 +75,19 @@ bool DllLibCurlGlobal::Load()
     return false;
   }
 
+  /* let every handle use the name lookups and tls sessions of the others, */
+  /* so a new connection to a known host skips the dns query and does an   */
+  /* abbreviated handshake                                                 */
+  m_share = share_init();
+  if (m_share)
+  {
+    share_setopt(m_share, CURLSHOPT_LOCKFUNC, share_lock_callback);
+    share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, share_unlock_callback);
+    share_setopt(m_share, CURLSHOPT_USERDATA, this);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  }
+
   /* check idle will clean up the last one */
   g_curlReferences = 2;
 
@@ -71,6 +102,12 @@ void DllLibCurlGlobal::Unload()
     if (!IsLoaded())
       return;
 
+    if (m_share)
+    {
+      share_cleanup(m_share);
+      m_share = NULL;
+    }
+
     // close libcurl
     global_cleanup();
 
@@ -91,31 +128,31 @@ void DllLibCurlGlobal::CheckIdle()
     return;
 
   CSingleLock lock(m_critSection);
-  /* 20 seconds idle time before closing handle */
-  const unsigned int idletime = 30000;
+  /* idle time before closing handle */
+  const unsigned int idletime = g_advancedSettings.m_curlidletime * 1000;
 
+  bool closed = false;
   VEC_CURLSESSIONS::iterator it = m_sessions.begin();
   while(it != m_sessions.end())
   {
     if( !it->m_busy && (XbmcThreads::SystemClockMillis() - it->m_idletimestamp) > idletime )
     {
-      CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
-
-      // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
-      // code accesses stuff in the easy's structure.
-      if(it->m_multi)
-        multi_cleanup(it->m_multi);
-      if(it->m_easy)
-        easy_cleanup(it->m_easy);
-
-      Unload();
-
-      it = m_sessions.erase(it);
+      it = CloseSession(it);
+      closed = true;
       continue;
     }
     it++;
   }
 
+  if (closed && m_stats.m_transfers)
+  {
+    CLog::Log(LOGDEBUG, "%s - %u transfers, %u%% over open connections, %u of %u sessions reused, connect %.1f ms, tls handshake %.1f ms on average",
+              __FUNCTION__, m_stats.m_transfers, 100 - 100 * m_stats.m_connects / m_stats.m_transfers,
+              m_stats.m_reused, m_stats.m_reused + m_stats.m_created,
+              m_stats.m_connects ? 1000.0 * m_stats.m_connectTime / m_stats.m_connects : 0.0,
+              m_stats.m_handshakes ? 1000.0 * m_stats.m_handshakeTime / m_stats.m_handshakes : 0.0);
+  }
+
   /* check if we should unload the dll */
 #if(0) // we never unload libcurl, since libssl can break when python unloads then
   if(g_curlReferences == 1 && XbmcThreads::SystemClockMillis() - g_curlTimeout > idletime)
@@ -139,10 +176,11 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
       if( it->m_protocol.compare(protocol) == 0 && it->m_hostname.compare(hostname) == 0)
       {
         it->m_busy = true;
+        m_stats.m_reused++;
         if(easy_handle)
         {
           if(!it->m_easy)
-            it->m_easy = easy_init();
+            it->m_easy = CreateEasy();
 
           *easy_handle = it->m_easy;
         }
@@ -167,10 +205,11 @@ void DllLibCurlGlobal::easy_aquire(const char *protocol, const char *hostname, C
 
   /* count up global interface counter */
   Load();
+  m_stats.m_created++;
 
   if(easy_handle)
   {
-    session.m_easy = easy_init();
+    session.m_easy = CreateEasy();
     *easy_handle = session.m_easy;
   }
 
@@ -213,16 +252,105 @@ void DllLibCurlGlobal::easy_release(CURL_HANDLE** easy_handle, CURLM** multi_han
   {
     if( it->m_easy == easy && (multi == NULL || it->m_multi == multi) )
     {
+      UpdateStats(easy);
+
       /* reset session so next caller doesn't reuse options, only connections */
       /* will reset verbose too so it won't print that it closed connections on cleanup*/
       easy_reset(easy);
       it->m_busy = false;
       it->m_idletimestamp = XbmcThreads::SystemClockMillis();
+
+      CStdString protocol = it->m_protocol;
+      CStdString hostname = it->m_hostname;
+      LimitIdle(protocol, hostname);
       return;
     }
   }
 }
 
+void DllLibCurlGlobal::easy_reset(CURL_HANDLE* easy_handle)
+{
+  DllLibCurl::easy_reset(easy_handle);
+  if (m_share)
+    easy_setopt(easy_handle, CURLOPT_SHARE, m_share);
+}
+
+CURL_HANDLE* DllLibCurlGlobal::CreateEasy()
+{
+  CURL_HANDLE* easy = easy_init();
+  if (easy && m_share)
+    easy_setopt(easy, CURLOPT_SHARE, m_share);
+  return easy;
+}
+
+DllLibCurlGlobal::VEC_CURLSESSIONS::iterator DllLibCurlGlobal::CloseSession(VEC_CURLSESSIONS::iterator it)
+{
+  CLog::Log(LOGINFO, "%s - Closing session to %s://%s (easy=%p, multi=%p)\n", __FUNCTION__, it->m_protocol.c_str(), it->m_hostname.c_str(), (void*)it->m_easy, (void*)it->m_multi);
+
+  // It's important to clean up multi *before* cleaning up easy, because the multi cleanup
+  // code accesses stuff in the easy's structure.
+  if(it->m_multi)
+    multi_cleanup(it->m_multi);
+  if(it->m_easy)
+    easy_cleanup(it->m_easy);
+
+  Unload();
+
+  return m_sessions.erase(it);
+}
+
+void DllLibCurlGlobal::LimitIdle(const CStdString& protocol, const CStdString& hostname)
+{
+  /* close the longest idle sessions to a host beyond the allowed number, */
+  /* sessions in use are not limited, every caller gets one of its own    */
+  unsigned int now = XbmcThreads::SystemClockMillis();
+  while (true)
+  {
+    int idle = 0;
+    VEC_CURLSESSIONS::iterator oldest = m_sessions.end();
+    for (VEC_CURLSESSIONS::iterator it = m_sessions.begin(); it != m_sessions.end(); it++)
+    {
+      if (it->m_busy || it->m_protocol != protocol || it->m_hostname != hostname)
+        continue;
+
+      idle++;
+      if (oldest == m_sessions.end() || now - it->m_idletimestamp > now - oldest->m_idletimestamp)
+        oldest = it;
+    }
+
+    if (idle <= g_advancedSettings.m_curlidlesessions)
+      return;
+
+    CloseSession(oldest);
+  }
+}
+
+void DllLibCurlGlobal::UpdateStats(CURL_HANDLE* easy_handle)
+{
+  /* only the last transfer since the handle was handed out is known */
+  long request = 0;
+  if (easy_getinfo(easy_handle, CURLINFO_REQUEST_SIZE, &request) != CURLE_OK || request <= 0)
+    return;
+
+  m_stats.m_transfers++;
+
+  long connects = 0;
+  if (easy_getinfo(easy_handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK || connects <= 0)
+    return;
+
+  double connect = 0.0, handshake = 0.0;
+  easy_getinfo(easy_handle, CURLINFO_CONNECT_TIME, &connect);
+  easy_getinfo(easy_handle, CURLINFO_APPCONNECT_TIME, &handshake);
+
+  m_stats.m_connects++;
+  m_stats.m_connectTime += connect;
+  if (handshake > connect)
+  {
+    m_stats.m_handshakes++;
+    m_stats.m_handshakeTime += handshake - connect;
+  }
+}
+
 CURL_HANDLE* DllLibCurlGlobal::easy_duphandle(CURL_HANDLE* easy_handle)
 {
   CSingleLock lock(m_critSection);
@@ -235,6 +363,7 @@ CURL_HANDLE* DllLibCurlGlobal::easy_duphandle(CURL_HANDLE* easy_handle)
       SSession session = *it;
       session.m_easy = DllLibCurl::easy_duphandle(easy_handle);
       Load();
+      m_stats.m_created++;
       m_sessions.push_back(session);
       return session.m_easy;
     }
@@ -269,6 +398,7 @@ void DllLibCurlGlobal::easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HAND
         session.m_multi = NULL;
 
       Load();
+      m_stats.m_created++;
       m_sessions.push_back(session);
       return;
     }
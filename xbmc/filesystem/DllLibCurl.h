@@ -51,6 +51,9 @@ namespace XCURL
     virtual CURLMcode multi_timeout(CURLM *multi_handle, long *timeout)=0;
     virtual CURLMsg*  multi_info_read(CURLM *multi_handle, int *msgs_in_queue)=0;
     virtual void multi_cleanup(CURL_HANDLE * handle )=0;
+    virtual CURLSH * share_init(void)=0;
+    //virtual CURLSHcode share_setopt(CURLSH *share, CURLSHoption option, ...)=0;
+    virtual CURLSHcode share_cleanup(CURLSH *share)=0;
     virtual struct curl_slist* slist_append(struct curl_slist *, const char *)=0;
     virtual void  slist_free_all(struct curl_slist *)=0;
   };
@@ -75,6 +78,9 @@ namespace XCURL
     DEFINE_METHOD2(CURLMcode, multi_timeout, (CURLM *p1, long *p2))
     DEFINE_METHOD2(CURLMsg*,  multi_info_read, (CURLM *p1, int *p2))
     DEFINE_METHOD1(void, multi_cleanup, (CURLM *p1))
+    DEFINE_METHOD0(CURLSH *, share_init)
+    DEFINE_METHOD_FP(CURLSHcode, share_setopt, (CURLSH *p1, CURLSHoption p2, ...))
+    DEFINE_METHOD1(CURLSHcode, share_cleanup, (CURLSH *p1))
     DEFINE_METHOD2(struct curl_slist*, slist_append, (struct curl_slist * p1, const char * p2))
     DEFINE_METHOD1(void, slist_free_all, (struct curl_slist * p1))
     BEGIN_METHOD_RESOLVE()
@@ -95,6 +101,9 @@ namespace XCURL
       RESOLVE_METHOD_RENAME(curl_multi_timeout, multi_timeout)
       RESOLVE_METHOD_RENAME(curl_multi_info_read, multi_info_read)
       RESOLVE_METHOD_RENAME(curl_multi_cleanup, multi_cleanup)
+      RESOLVE_METHOD_RENAME(curl_share_init, share_init)
+      RESOLVE_METHOD_RENAME_FP(curl_share_setopt, share_setopt)
+      RESOLVE_METHOD_RENAME(curl_share_cleanup, share_cleanup)
       RESOLVE_METHOD_RENAME(curl_slist_append, slist_append)
       RESOLVE_METHOD_RENAME(curl_slist_free_all, slist_free_all)
     END_METHOD_RESOLVE()
@@ -104,11 +113,15 @@ namespace XCURL
   class DllLibCurlGlobal : public DllLibCurl
   {
   public:
+    DllLibCurlGlobal();
+
     /* extend interface with buffered functions */
     void easy_aquire(const char *protocol, const char *hostname, CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_release(CURL_HANDLE** easy_handle, CURLM** multi_handle);
     void easy_duplicate(CURL_HANDLE* easy, CURLM* multi, CURL_HANDLE** easy_out, CURLM** multi_out);
     CURL_HANDLE* easy_duphandle(CURL_HANDLE* easy_handle);
+    /* reset keeping the handle on the shared dns and tls session caches */
+    virtual void easy_reset(CURL_HANDLE* easy_handle);
     void CheckIdle();
 
     /* overloaded load and unload with reference counter */
@@ -128,8 +141,30 @@ namespace XCURL
 
     typedef std::vector<SSession> VEC_CURLSESSIONS;
 
+    /* structure holding counters of the session pool */
+    typedef struct SStats
+    {
+      unsigned int  m_created;        // sessions opened as none was free
+      unsigned int  m_reused;         // sessions handed out again
+      unsigned int  m_transfers;      // transfers done by released sessions
+      unsigned int  m_connects;       // transfers which had to open a connection
+      unsigned int  m_handshakes;     // connections which did a tls handshake
+      double        m_connectTime;    // seconds spent opening connections
+      double        m_handshakeTime;  // seconds spent in tls handshakes
+    } SStats;
+
     VEC_CURLSESSIONS m_sessions;
     CCriticalSection m_critSection;
+
+    CURLSH*          m_share;
+    CCriticalSection m_shareLocks[CURL_LOCK_DATA_LAST];
+    SStats           m_stats;
+
+  protected:
+    CURL_HANDLE* CreateEasy();
+    VEC_CURLSESSIONS::iterator CloseSession(VEC_CURLSESSIONS::iterator it);
+    void LimitIdle(const CStdString& protocol, const CStdString& hostname);
+    void UpdateStats(CURL_HANDLE* easy_handle);
   };
 }
 
@@ -27,6 +27,7 @@
 #include "URL.h"
 
 #include "CircularCache.h"
+#include "RangeCache.h"
 #include "threads/SingleLock.h"
 #include "utils/log.h"
 #include "utils/TimeUtils.h"
@@ -36,6 +37,7 @@ using namespace AUTOPTR;
 using namespace XFILE;
 
 #define READ_CACHE_CHUNK_SIZE (64*1024)
+#define READ_RATE_INTERVAL    1000
 
 class CWriteRate
 {
@@ -88,11 +90,18 @@ CFileCache::CFileCache() : CThread("CFileCache")
    m_writePos = 0;
    if (g_advancedSettings.m_cacheMemBufferSize == 0)
      m_pCache = new CSimpleFileCache();
+   else if (g_advancedSettings.m_cacheDiskBufferSize > 0)
+     m_pCache = new CRangeCache(g_advancedSettings.m_cacheMemBufferSize
+                              , (uint64_t)g_advancedSettings.m_cacheDiskBufferSize);
    else
      m_pCache = new CCircularCache(g_advancedSettings.m_cacheMemBufferSize
                                  , std::max<unsigned int>( g_advancedSettings.m_cacheMemBufferSize / 4, 1024 * 1024));
    m_seekPossible = 0;
    m_cacheFull = false;
+   m_cacheHits = 0;
+   m_cacheMisses = 0;
+   m_readRate = 0;
+   m_stalls = 0;
 }
 
 CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("CFileCache")
@@ -104,6 +113,10 @@ CFileCache::CFileCache(CCacheStrategy *pCache, bool bDeleteCache) : CThread("CFi
   m_writePos = 0;
   m_nSeekResult = 0;
   m_chunkSize = 0;
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+  m_readRate = 0;
+  m_stalls = 0;
 }
 
 CFileCache::~CFileCache()
@@ -171,6 +184,15 @@ bool CFileCache::Open(const CURL& url)
   m_writeRate = 1024 * 1024;
   m_writeRateActual = 0;
   m_cacheFull = false;
+  m_cacheHits = 0;
+  m_cacheMisses = 0;
+  m_readRate = 0;
+  m_readBytes = 0;
+  m_readRateBytes = 0;
+  m_readRateStamp = XbmcThreads::SystemClockMillis();
+  m_stalls = 0;
+  m_stallPossible = false;
+  m_slowSource = false;
   m_seekEvent.Reset();
   m_seekEnded.Reset();
 
@@ -219,30 +241,61 @@ void CFileCache::Process()
         m_writePos = m_seekPos;
         m_readPos = m_seekPos;
         m_cacheFull = false;
+        m_slowSource = false;
       }
 
       m_seekEnded.Set();
     }
 
-    while (m_writeRate)
+    // read ahead a fixed time of the stream. up to half of it is read as fast
+    // as the source goes, beyond that the source is only read a bit faster than
+    // the stream is played and once it's all there the source is left alone.
+    while (!m_bStop)
     {
-      if (m_writePos - m_readPos < m_writeRate)
+      unsigned readRate = UpdateReadRate();
+      unsigned rate    = readRate ? readRate : m_writeRate;
+      int64_t  forward = m_pCache->WaitForData(0, 0);
+      int64_t  target  = (int64_t)rate * g_advancedSettings.m_cacheReadAheadTime;
+
+      if (target == 0 || forward < target / 2)
       {
+        if (!m_slowSource && forward < target / 4 && m_writeRateActual && m_writeRateActual < readRate)
+        {
+          CLog::Log(LOGWARNING, "%s - source delivers %u kB/s, stream is read at %u kB/s with %.1f sec buffered"
+                              , __FUNCTION__, m_writeRateActual / 1024, readRate / 1024, (double)forward / rate);
+          m_slowSource = true;
+        }
         limiter.Reset(m_writePos);
         break;
       }
 
-      if (limiter.Rate(m_writePos) < m_writeRate)
+      if (forward < target && limiter.Rate(m_writePos) < rate + rate / 2)
         break;
 
-      if (m_seekEvent.WaitMSec(100))
+      average.Pause();
+      bool seek = m_seekEvent.WaitMSec(100);
+      average.Resume();
+      if (seek)
       {
         m_seekEvent.Set();
         break;
       }
     }
 
-    int iRead = m_source.Read(buffer.get(), m_chunkSize);
+    // have the source read straight into the cache if it can lend the space
+    char *pWrite = NULL;
+    int iRead;
+    if (m_pCache->BorrowWrite(pWrite, m_chunkSize) > 0)
+    {
+      iRead = m_source.Read(pWrite, m_chunkSize);
+      m_pCache->CommitWrite(iRead > 0 ? iRead : 0);
+    }
+    else
+    {
+      pWrite = NULL;
+      iRead = m_source.Read(buffer.get(), m_chunkSize);
+    }
+
     if (iRead == 0)
     {
       CLog::Log(LOGINFO, "CFileCache::Process - Hit eof.");
@@ -261,6 +314,12 @@ void CFileCache::Process()
       m_bStop = true;
 
     int iTotalWrite=0;
+    if (pWrite && iRead > 0)
+    {
+      iTotalWrite = iRead;
+      m_cacheFull = false;
+    }
+
     while (!m_bStop && (iTotalWrite < iRead))
     {
       int iWrite = 0;
@@ -302,6 +361,26 @@ void CFileCache::Process()
   }
 }
 
+unsigned CFileCache::UpdateReadRate()
+{
+  CSingleLock lock(m_rateSection);
+  unsigned now = XbmcThreads::SystemClockMillis();
+  if (now - m_readRateStamp < READ_RATE_INTERVAL)
+    return m_readRate;
+
+  // intervals the stream wasn't read in at all, e.g. while paused, say nothing about its rate
+  int64_t bytes = m_readBytes - m_readRateBytes;
+  if (bytes > 0)
+  {
+    unsigned sample = (unsigned)(1000 * bytes / (now - m_readRateStamp));
+    m_readRate = m_readRate ? (3 * m_readRate + sample) / 4 : sample;
+  }
+
+  m_readRateBytes = m_readBytes;
+  m_readRateStamp = now;
+  return m_readRate;
+}
+
 void CFileCache::OnExit()
 {
   m_bStop = true;
@@ -335,16 +414,50 @@ unsigned int CFileCache::Read(void* lpBuf, int64_t uiBufSize)
   int64_t iRc;
 
 retry:
-  // attempt to read
-  iRc = m_pCache->ReadFromCache((char *)lpBuf, (size_t)uiBufSize);
+  // attempt to read. if the cache lends its data it's copied without holding its lock
+  if (m_pCache->CanBorrow())
+  {
+    const char *pData = NULL;
+    iRc = m_pCache->BorrowRead(pData, (size_t)uiBufSize);
+    if (iRc > 0)
+    {
+      memcpy(lpBuf, pData, (size_t)iRc);
+      m_pCache->ReleaseRead((size_t)iRc);
+    }
+  }
+  else
+    iRc = m_pCache->ReadFromCache((char *)lpBuf, (size_t)uiBufSize);
+
   if (iRc > 0)
   {
     m_readPos += iRc;
+    {
+      CSingleLock rateLock(m_rateSection);
+      m_readBytes += iRc;
+    }
+    m_stallPossible = true;
     return (int)iRc;
   }
 
   if (iRc == CACHE_RC_WOULD_BLOCK)
   {
+    // the cache may hold other ranges than the one being filled, move the source here first
+    if (m_seekPossible && !m_pCache->IsCachedPosition(m_readPos))
+    {
+      m_cacheMisses++;
+      m_stallPossible = false;
+      if (!SeekSource(m_readPos))
+        return 0;
+      m_seekEvent.Reset();
+    }
+
+    // running dry in the middle of a stream rather than after opening or seeking it
+    if (m_stallPossible && !m_pCache->IsEndOfInput())
+    {
+      m_stalls++;
+      m_stallPossible = false;
+    }
+
     // just wait for some data to show up
     iRc = m_pCache->WaitForData(1, 10000);
     if (iRc > 0)
@@ -392,15 +505,12 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
     if (m_seekPossible == 0)
       return m_nSeekResult;
 
-    /* never request closer to end than 2k, speeds up tag reading */
-    m_seekPos = std::min(iTarget, std::max((int64_t)0, m_source.GetLength() - m_chunkSize));
+    m_cacheMisses++;
+    m_stallPossible = false;
 
-    m_seekEvent.Set();
-    if (!m_seekEnded.Wait())
-    {
-      CLog::Log(LOGWARNING,"%s - seek to %"PRId64" failed.", __FUNCTION__, m_seekPos);
+    /* never request closer to end than 2k, speeds up tag reading */
+    if (!SeekSource(std::min(iTarget, std::max((int64_t)0, m_source.GetLength() - m_chunkSize))))
       return -1;
-    }
 
     /* wait for any remainin data */
     if(m_seekPos < iTarget)
@@ -417,11 +527,27 @@ int64_t CFileCache::Seek(int64_t iFilePosition, int iWhence)
     m_seekEvent.Reset();
   }
   else
+  {
+    m_cacheHits++;
     m_readPos = iTarget;
+  }
 
   return m_nSeekResult;
 }
 
+bool CFileCache::SeekSource(int64_t iFilePosition)
+{
+  m_seekPos = iFilePosition;
+
+  m_seekEvent.Set();
+  if (!m_seekEnded.Wait())
+  {
+    CLog::Log(LOGWARNING,"%s - seek to %"PRId64" failed.", __FUNCTION__, m_seekPos);
+    return false;
+  }
+  return true;
+}
+
 void CFileCache::Close()
 {
   StopThread();
@@ -468,6 +594,13 @@ int CFileCache::IoControl(EIoControl request, void* param)
     status->maxrate = m_writeRate;
     status->currate = m_writeRateActual;
     status->full    = m_cacheFull;
+    status->hits    = m_cacheHits;
+    status->misses  = m_cacheMisses;
+    {
+      CSingleLock lock(m_rateSection);
+      status->readrate = m_readRate;
+    }
+    status->stalls  = m_stalls;
     return 0;
   }
 
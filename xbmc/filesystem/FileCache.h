@@ -62,6 +62,9 @@ namespace XFILE
     virtual CStdString GetContent();
 
   private:
+    bool SeekSource(int64_t iFilePosition);
+    unsigned UpdateReadRate();
+
     CCacheStrategy *m_pCache;
     bool      m_bDeleteCache;
     int        m_seekPossible;
@@ -77,7 +80,17 @@ namespace XFILE
     unsigned     m_writeRate;
     unsigned     m_writeRateActual;
     bool         m_cacheFull;
+    unsigned     m_cacheHits;
+    unsigned     m_cacheMisses;
+    unsigned     m_readRate;      // estimated bytes per second the stream is read at, guarded by m_rateSection
+    int64_t      m_readBytes;     // bytes read by the consumer since open, guarded by m_rateSection
+    int64_t      m_readRateBytes;
+    unsigned     m_readRateStamp;
+    unsigned     m_stalls;        // reads that had to wait for the source
+    bool         m_stallPossible;
+    bool         m_slowSource;
     CCriticalSection m_sync;
+    CCriticalSection m_rateSection; // the reader holds m_sync while it waits for the cache thread
   };
 
 }
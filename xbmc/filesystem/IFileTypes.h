@@ -33,16 +33,20 @@ struct SNativeIoControl
 struct SCacheStatus
 {
   uint64_t forward;  /**< number of bytes cached forward of current position */
-  unsigned maxrate;  /**< maximum number of bytes per second cache is allowed to fill */
+  unsigned maxrate;  /**< expected number of bytes per second the stream is read at */
   unsigned currate;  /**< average read rate from source file since last position change */
   bool     full;     /**< is the cache full */
+  unsigned hits;     /**< number of seeks served from the cache */
+  unsigned misses;   /**< number of times the source had to be repositioned */
+  unsigned readrate; /**< measured number of bytes per second the stream is read at, 0 if unknown */
+  unsigned stalls;   /**< number of times reading had to wait for the source */
 };
 
 typedef enum {
   IOCTRL_NATIVE        = 1, /**< SNativeIoControl structure, containing what should be passed to native ioctrl */
   IOCTRL_SEEK_POSSIBLE = 2, /**< return 0 if known not to work, 1 if it should work */
   IOCTRL_CACHE_STATUS  = 3, /**< SCacheStatus structure */
-  IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with speed limit for caching in bytes per second */
+  IOCTRL_CACHE_SETRATE = 4, /**< unsigned int with the expected read rate of the stream in bytes per second */
 } EIoControl;
 
 }
@@ -0,0 +1,411 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/SystemClock.h"
+#include "RangeCache.h"
+#ifdef _LINUX
+#include "PlatformInclude.h"
+#endif
+#include "Util.h"
+#include "utils/log.h"
+#include "threads/SingleLock.h"
+#include "SpecialProtocol.h"
+
+#include <algorithm>
+
+using namespace XFILE;
+
+#define RANGE_CACHE_BLOCK_SIZE (256 * 1024)
+
+CRangeCache::CRangeCache(size_t memSize, uint64_t diskSize)
+ : CCacheStrategy()
+ , m_cur(0)
+ , m_write(0)
+ , m_memSize(std::max<size_t>(memSize / RANGE_CACHE_BLOCK_SIZE, 2) * RANGE_CACHE_BLOCK_SIZE)
+ , m_diskSize(diskSize - diskSize % RANGE_CACHE_BLOCK_SIZE)
+ , m_forward(m_memSize)
+ , m_buf(NULL)
+ , m_file(INVALID_HANDLE_VALUE)
+ , m_clock(0)
+{
+}
+
+CRangeCache::~CRangeCache()
+{
+  Close();
+}
+
+int CRangeCache::Open()
+{
+  Close();
+
+  CSingleLock lock(m_sync);
+
+  m_buf = new uint8_t[m_memSize];
+  if (m_buf == NULL)
+    return CACHE_RC_ERROR;
+
+  for (unsigned slot = m_memSize / RANGE_CACHE_BLOCK_SIZE; slot > 0; slot--)
+    m_freeMem.push_back(slot - 1);
+
+  if (m_diskSize > 0)
+  {
+    CStdString fileName = CSpecialProtocol::TranslatePath(CUtil::GetNextFilename("special://temp/filecache%03d.cache", 999));
+    if (!fileName.empty())
+      m_file = CreateFile(fileName.c_str()
+                        , GENERIC_READ | GENERIC_WRITE, 0
+                        , NULL
+                        , CREATE_ALWAYS
+                        , FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE
+                        , NULL);
+
+    // the memory tier works on its own, so carry on without the disk
+    if (m_file == INVALID_HANDLE_VALUE)
+      CLog::Log(LOGWARNING, "%s - failed to create disk cache <%s>, caching in memory only", __FUNCTION__, fileName.c_str());
+    else
+    {
+      for (unsigned slot = (unsigned)(m_diskSize / RANGE_CACHE_BLOCK_SIZE); slot > 0; slot--)
+        m_freeDisk.push_back(slot - 1);
+    }
+  }
+
+  m_cur = 0;
+  m_write = 0;
+  m_clock = 0;
+  return CACHE_RC_OK;
+}
+
+void CRangeCache::Close()
+{
+  CSingleLock lock(m_sync);
+
+  if (m_file != INVALID_HANDLE_VALUE)
+    CloseHandle(m_file);
+  m_file = INVALID_HANDLE_VALUE;
+
+  delete[] m_buf;
+  m_buf = NULL;
+
+  m_blocks.clear();
+  m_freeMem.clear();
+  m_freeDisk.clear();
+}
+
+/**
+ * Writes at m_write, at most up to the end of the block it falls in.
+ *
+ * Data is only accepted while the writer fills the range being read and is
+ * at most m_forward ahead of the reader. When the reader moved to another
+ * cached range the writer stalls until it either catches up or the source
+ * is repositioned with Reset().
+ *
+ * Multiple calls may be needed to write the buffer completely.
+ */
+int CRangeCache::WriteToCache(const char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  if (m_write < m_cur || m_write - m_cur >= m_forward)
+    return 0;
+
+  uint64_t index  = m_write / RANGE_CACHE_BLOCK_SIZE;
+  unsigned offset = (unsigned)(m_write % RANGE_CACHE_BLOCK_SIZE);
+
+  // limit to the block and the max forward size
+  len = std::min(len, (size_t)(RANGE_CACHE_BLOCK_SIZE - offset));
+  len = std::min(len, (size_t)(m_cur + m_forward - m_write));
+
+  BlockMap::iterator it = m_blocks.find(index);
+  if (it == m_blocks.end())
+  {
+    CBlock block;
+    if (!AllocateBlock(block))
+      return 0;
+    block.beg = block.end = offset;
+    it = m_blocks.insert(std::make_pair(index, block)).first;
+  }
+
+  CBlock &block = it->second;
+  if (!WriteBlock(block, offset, (const uint8_t*)buf, len))
+    return CACHE_RC_ERROR;
+
+  // extend what the block holds if the new data touches it, otherwise replace it
+  if (offset <= block.end && offset + len >= block.beg)
+  {
+    block.beg = std::min(block.beg, offset);
+    block.end = std::max(block.end, (unsigned)(offset + len));
+  }
+  else
+  {
+    block.beg = offset;
+    block.end = offset + len;
+  }
+  block.lastUsed = ++m_clock;
+
+  m_write += len;
+  m_written.Set();
+
+  return len;
+}
+
+/**
+ * Reads data from cache. Will only read up till the end of the
+ * block at m_cur, so multiple calls may be needed.
+ */
+int CRangeCache::ReadFromCache(char *buf, size_t len)
+{
+  CSingleLock lock(m_sync);
+
+  CBlock *block = GetBlock(m_cur);
+  if (block == NULL)
+  {
+    if (IsEndOfInput() && m_cur == m_write)
+      return 0;
+    else
+      return CACHE_RC_WOULD_BLOCK;
+  }
+
+  unsigned offset = (unsigned)(m_cur % RANGE_CACHE_BLOCK_SIZE);
+  len = std::min(len, (size_t)(block->end - offset));
+
+  if (!ReadBlock(*block, offset, (uint8_t*)buf, len))
+    return CACHE_RC_ERROR;
+  block->lastUsed = ++m_clock;
+  m_cur += len;
+
+  m_space.Set();
+
+  return len;
+}
+
+int64_t CRangeCache::WaitForData(unsigned int minimum, unsigned int millis)
+{
+  CSingleLock lock(m_sync);
+  uint64_t avail = GetCachedEnd(m_cur) - m_cur;
+
+  if (millis == 0 || IsEndOfInput())
+    return avail;
+
+  if (minimum > m_forward)
+    minimum = m_forward;
+
+  // more data only arrives if the writer is at the end of the range being read
+  XbmcThreads::EndTime endtime(millis);
+  while (!IsEndOfInput() && avail < minimum && m_cur + avail == m_write && !endtime.IsTimePast())
+  {
+    lock.Leave();
+    m_written.WaitMSec(50); // may miss the deadline. shouldn't be a problem.
+    lock.Enter();
+    avail = GetCachedEnd(m_cur) - m_cur;
+  }
+
+  return avail;
+}
+
+int64_t CRangeCache::Seek(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+
+  // if seek is a bit over what the writer has, try to wait a few seconds for the data to be available.
+  // we try to avoid a (heavy) seek on the source
+  if ((uint64_t)pos >= m_write && (uint64_t)pos < m_write + 100000 && GetCachedEnd(m_cur) == m_write)
+  {
+    lock.Leave();
+    WaitForData((unsigned int)(pos - m_cur), 5000);
+    lock.Enter();
+  }
+
+  if ((uint64_t)pos == m_write || GetBlock(pos))
+  {
+    m_cur = pos;
+    m_space.Set();
+    return pos;
+  }
+
+  return CACHE_RC_ERROR;
+}
+
+void CRangeCache::Reset(int64_t pos)
+{
+  // the source moved, whatever is cached elsewhere stays valid
+  CSingleLock lock(m_sync);
+  m_write = pos;
+  m_cur = pos;
+}
+
+bool CRangeCache::IsCachedPosition(int64_t pos)
+{
+  CSingleLock lock(m_sync);
+  return (uint64_t)pos == m_write || GetBlock(pos) != NULL;
+}
+
+CRangeCache::CBlock *CRangeCache::GetBlock(uint64_t pos)
+{
+  BlockMap::iterator it = m_blocks.find(pos / RANGE_CACHE_BLOCK_SIZE);
+  if (it == m_blocks.end())
+    return NULL;
+
+  unsigned offset = (unsigned)(pos % RANGE_CACHE_BLOCK_SIZE);
+  if (offset < it->second.beg || offset >= it->second.end)
+    return NULL;
+
+  return &it->second;
+}
+
+uint64_t CRangeCache::GetCachedEnd(uint64_t pos)
+{
+  CBlock *block;
+  while ((block = GetBlock(pos)) != NULL)
+  {
+    pos += block->end - pos % RANGE_CACHE_BLOCK_SIZE;
+    if (block->end < RANGE_CACHE_BLOCK_SIZE)
+      break;
+  }
+  return pos;
+}
+
+bool CRangeCache::IsProtected(uint64_t index) const
+{
+  // blocks between the reader and the writer filling ahead of it
+  if (m_write < m_cur || m_write - m_cur > m_forward)
+    return false;
+  return index >= m_cur / RANGE_CACHE_BLOCK_SIZE
+      && index <= m_write / RANGE_CACHE_BLOCK_SIZE;
+}
+
+CRangeCache::BlockMap::iterator CRangeCache::FindOldest(bool disk)
+{
+  BlockMap::iterator oldest = m_blocks.end();
+  for (BlockMap::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+  {
+    if (it->second.disk != disk || IsProtected(it->first))
+      continue;
+    if (oldest == m_blocks.end() || it->second.lastUsed < oldest->second.lastUsed)
+      oldest = it;
+  }
+  return oldest;
+}
+
+/**
+ * Finds room for a new block. Memory is preferred, when it's full the least
+ * recently used block in memory is moved to disk to make room for it. Only
+ * when all of memory holds data ahead of the reader the block goes to disk.
+ */
+bool CRangeCache::AllocateBlock(CBlock &block)
+{
+  block.disk = false;
+  block.lastUsed = m_clock;
+
+  if (!m_freeMem.empty())
+  {
+    block.slot = m_freeMem.back();
+    m_freeMem.pop_back();
+    return true;
+  }
+
+  BlockMap::iterator it = FindOldest(false);
+  if (it != m_blocks.end())
+  {
+    block.slot = it->second.slot;
+
+    unsigned slot;
+    if (AllocateDiskSlot(slot))
+    {
+      CBlock spilled = it->second;
+      spilled.disk = true;
+      spilled.slot = slot;
+      if (WriteBlock(spilled, spilled.beg, m_buf + (size_t)block.slot * RANGE_CACHE_BLOCK_SIZE + spilled.beg, spilled.end - spilled.beg))
+      {
+        it->second = spilled;
+        return true;
+      }
+      m_freeDisk.push_back(slot);
+    }
+    m_blocks.erase(it);
+    return true;
+  }
+
+  block.disk = true;
+  return AllocateDiskSlot(block.slot);
+}
+
+bool CRangeCache::AllocateDiskSlot(unsigned &slot)
+{
+  if (m_file == INVALID_HANDLE_VALUE)
+    return false;
+
+  if (!m_freeDisk.empty())
+  {
+    slot = m_freeDisk.back();
+    m_freeDisk.pop_back();
+    return true;
+  }
+
+  BlockMap::iterator it = FindOldest(true);
+  if (it == m_blocks.end())
+    return false;
+
+  slot = it->second.slot;
+  m_blocks.erase(it);
+  return true;
+}
+
+bool CRangeCache::ReadBlock(const CBlock &block, unsigned offset, uint8_t *buf, unsigned len)
+{
+  if (!block.disk)
+  {
+    memcpy(buf, m_buf + (size_t)block.slot * RANGE_CACHE_BLOCK_SIZE + offset, len);
+    return true;
+  }
+
+  LARGE_INTEGER pos;
+  pos.QuadPart = (int64_t)block.slot * RANGE_CACHE_BLOCK_SIZE + offset;
+
+  DWORD iRead = 0;
+  if (!SetFilePointerEx(m_file, pos, NULL, FILE_BEGIN)
+  ||  !ReadFile(m_file, buf, len, &iRead, NULL) || iRead != len)
+  {
+    CLog::Log(LOGERROR, "%s - failed to read %u bytes from disk cache. err: %u", __FUNCTION__, len, GetLastError());
+    return false;
+  }
+  return true;
+}
+
+bool CRangeCache::WriteBlock(const CBlock &block, unsigned offset, const uint8_t *buf, unsigned len)
+{
+  if (!block.disk)
+  {
+    memcpy(m_buf + (size_t)block.slot * RANGE_CACHE_BLOCK_SIZE + offset, buf, len);
+    return true;
+  }
+
+  LARGE_INTEGER pos;
+  pos.QuadPart = (int64_t)block.slot * RANGE_CACHE_BLOCK_SIZE + offset;
+
+  DWORD iWritten = 0;
+  if (!SetFilePointerEx(m_file, pos, NULL, FILE_BEGIN)
+  ||  !WriteFile(m_file, buf, len, &iWritten, NULL) || iWritten != len)
+  {
+    CLog::Log(LOGERROR, "%s - failed to write %u bytes to disk cache. err: %u", __FUNCTION__, len, GetLastError());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,95 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "CacheStrategy.h"
+#include "threads/CriticalSection.h"
+#include "threads/Event.h"
+
+#include <map>
+#include <vector>
+
+namespace XFILE {
+
+/**
+ * Cache strategy keeping several ranges of the file at once.
+ *
+ * The file is split in fixed size blocks which are held in memory and, when
+ * memory runs out, spilled to a temporary file on disk. Blocks are dropped
+ * least recently used first, except for the ones between the read position
+ * and the data being written ahead of it. A seek back to a range that was
+ * read earlier, or forth to one read ahead, is served without touching the
+ * source again.
+ */
+class CRangeCache : public CCacheStrategy
+{
+public:
+  CRangeCache(size_t memSize, uint64_t diskSize);
+  virtual ~CRangeCache();
+
+  virtual int Open();
+  virtual void Close();
+
+  virtual int WriteToCache(const char *buf, size_t len);
+  virtual int ReadFromCache(char *buf, size_t len);
+  virtual int64_t WaitForData(unsigned int minimum, unsigned int millis);
+
+  virtual int64_t Seek(int64_t pos);
+  virtual void Reset(int64_t pos);
+
+  virtual bool IsCachedPosition(int64_t pos);
+
+protected:
+  struct CBlock
+  {
+    unsigned slot;     /**< slot in memory or in the disk file holding the block */
+    bool     disk;     /**< is the block spilled to disk */
+    unsigned beg;      /**< offset of the start of valid data in the block */
+    unsigned end;      /**< offset of the end of valid data in the block */
+    unsigned lastUsed; /**< value of m_clock when the block was last accessed */
+  };
+  typedef std::map<uint64_t, CBlock> BlockMap;
+
+  CBlock *GetBlock(uint64_t pos);
+  uint64_t GetCachedEnd(uint64_t pos);
+  bool IsProtected(uint64_t index) const;
+  bool AllocateBlock(CBlock &block);
+  bool AllocateDiskSlot(unsigned &slot);
+  BlockMap::iterator FindOldest(bool disk);
+  bool ReadBlock(const CBlock &block, unsigned offset, uint8_t *buf, unsigned len);
+  bool WriteBlock(const CBlock &block, unsigned offset, const uint8_t *buf, unsigned len);
+
+  BlockMap              m_blocks;
+  uint64_t              m_cur;       /**< current reading index in file */
+  uint64_t              m_write;     /**< index in file the next write goes to */
+  size_t                m_memSize;   /**< size of the memory tier */
+  uint64_t              m_diskSize;  /**< size of the disk tier */
+  size_t                m_forward;   /**< maximum amount of data written ahead of the read position */
+  uint8_t              *m_buf;       /**< memory tier */
+  std::vector<unsigned> m_freeMem;   /**< unused memory slots */
+  std::vector<unsigned> m_freeDisk;  /**< unused disk slots */
+  HANDLE                m_file;      /**< disk tier */
+  unsigned              m_clock;
+  CCriticalSection      m_sync;
+  CEvent                m_written;
+};
+
+} // namespace XFILE
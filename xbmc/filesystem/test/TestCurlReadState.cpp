@@ -0,0 +1,244 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "filesystem/CurlFile.h"
+#include "filesystem/DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
+#include "TestHelpers.h"
+#include "TestHttpServer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace XFILE;
+using namespace XCURL;
+
+// what CCurlFile connects with, and its ranges scaled down to the test files
+#define BUFFER_SIZE   32768
+#define CHUNK_SIZE    262144
+#define MAX_BUFFERED  1048576
+
+extern "C" size_t write_callback(char *buffer, size_t size, size_t nitems, void *userp);
+extern "C" size_t header_callback(void *ptr, size_t size, size_t nmemb, void *stream);
+
+// a CReadState set up and (re)connected the way CCurlFile::Open and Seek do it
+class CTestReader
+{
+public:
+  CTestReader(const std::string &url, unsigned int connections)
+    : m_connections(connections), m_maxBuffered(0)
+  {
+    g_curlInterface.easy_aquire("http", "127.0.0.1", &m_state.m_easyHandle, &m_state.m_multiHandle);
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_URL, url.c_str());
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_WRITEFUNCTION, write_callback);
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_WRITEDATA, &m_state);
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_HEADERFUNCTION, header_callback);
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_WRITEHEADER, &m_state);
+    g_curlInterface.easy_setopt(m_state.m_easyHandle, CURLOPT_FAILONERROR, 1);
+  }
+
+  long Open(int64_t pos)
+  {
+    m_state.Disconnect();
+    m_state.m_filePos = pos;
+    m_state.m_rangeEnd = m_connections > 1 ? pos + CHUNK_SIZE : 0;
+    long response = m_state.Connect(BUFFER_SIZE);
+    if (m_state.m_rangeEnd > 0 && m_state.m_fileSize > 0)
+      m_state.EnableParallel(m_connections, CHUNK_SIZE, MAX_BUFFERED);
+    return response;
+  }
+
+  bool Seek(int64_t pos)
+  {
+    if (m_state.Seek(pos))
+      return true;
+    long response = Open(pos);
+    return response == 200 || response == 206;
+  }
+
+  // reads size bytes in pieces of random length, returns how many of them match data
+  int64_t ReadAndCompare(const std::string &data, int64_t size, CTestRandom &random, unsigned int pause = 0)
+  {
+    char buffer[65536];
+    int64_t matched = 0;
+    while (matched < size)
+    {
+      int64_t pos = m_state.m_filePos;
+      unsigned int want = (unsigned int)std::min((int64_t)random.NextRange(1, sizeof(buffer)), size - matched);
+      unsigned int got = m_state.Read(buffer, want);
+      if (got == 0 || pos + got > (int64_t)data.size())
+        break;
+      if (memcmp(buffer, data.c_str() + pos, got) != 0)
+      {
+        printf("data read at %"PRId64" differs from the file\n", pos);
+        break;
+      }
+      matched += got;
+
+      unsigned int buffered = 0;
+      for (size_t i = 0; i < m_state.m_chunks.size(); i++)
+        buffered += m_state.m_chunks[i]->m_length;
+      m_maxBuffered = std::max(m_maxBuffered, buffered);
+
+      if (pause)
+        usleep(pause * 1000);
+    }
+    return matched;
+  }
+
+  // most bytes held in ranges at any point of the reads
+  unsigned int GetMaxBuffered() const { return m_maxBuffered; }
+
+  CCurlFile::CReadState m_state;
+
+private:
+  unsigned int m_connections;
+  unsigned int m_maxBuffered;
+};
+
+TEST(CurlReadSingleConnection)
+{
+  std::string data = MakeTestData(3000000);
+  CTestHttpServer server(data, CTestHttpServer::RANGES);
+  CHECK(server.Start());
+
+  CTestRandom random;
+  CTestReader reader(server.GetUrl(), 1);
+  CHECK_EQUAL(200, reader.Open(0));
+  CHECK_EQUAL((int64_t)data.size(), reader.m_state.m_fileSize);
+  CHECK_EQUAL((int64_t)data.size(), reader.ReadAndCompare(data, data.size(), random));
+
+  char last;
+  CHECK_EQUAL(0u, reader.m_state.Read(&last, 1));
+  CHECK_EQUAL(0u, server.GetRangeRequests());
+}
+
+TEST(CurlReadParallel)
+{
+  std::string data = MakeTestData(6000000, 2);
+  CTestHttpServer server(data, CTestHttpServer::RANGES);
+  CHECK(server.Start());
+
+  CTestRandom random(2);
+  CTestReader reader(server.GetUrl(), 4);
+  CHECK_EQUAL(206, reader.Open(0));
+  CHECK(reader.m_state.m_parallel);
+  CHECK_EQUAL((int64_t)data.size(), reader.m_state.m_fileSize);
+  CHECK_EQUAL((int64_t)data.size(), reader.ReadAndCompare(data, data.size(), random));
+
+  char last;
+  CHECK_EQUAL(0u, reader.m_state.Read(&last, 1));
+  CHECK(server.GetRangeRequests() > 0);
+
+  // the first connection ends its range cleanly and serves later ones
+  CHECK(server.GetConnections() <= 4);
+}
+
+TEST(CurlReadParallelFromPosition)
+{
+  std::string data = MakeTestData(3000000, 3);
+  CTestHttpServer server(data, CTestHttpServer::RANGES);
+  CHECK(server.Start());
+
+  CTestRandom random(3);
+  CTestReader reader(server.GetUrl(), 4);
+  CHECK_EQUAL(206, reader.Open(1234567));
+  CHECK_EQUAL((int64_t)data.size(), reader.m_state.m_fileSize);
+  CHECK_EQUAL((int64_t)data.size() - 1234567, reader.ReadAndCompare(data, data.size() - 1234567, random));
+}
+
+TEST(CurlReadSeek)
+{
+  std::string data = MakeTestData(4000000, 4);
+  CTestHttpServer server(data, CTestHttpServer::RANGES);
+  CHECK(server.Start());
+
+  CTestRandom random(4);
+  CTestReader reader(server.GetUrl(), 4);
+  CHECK_EQUAL(206, reader.Open(0));
+  CHECK_EQUAL(100000, reader.ReadAndCompare(data, 100000, random));
+
+  // within the buffer, past it, backwards, and up to the very end
+  int64_t positions[] = { 100000 + 1000, 100000 + BUFFER_SIZE, 2500000, 700000, 3999000, 12345, 0 };
+  for (size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); i++)
+  {
+    int64_t length = std::min((int64_t)200000, (int64_t)data.size() - positions[i]);
+    CHECK(reader.Seek(positions[i]));
+    CHECK_EQUAL(positions[i], reader.m_state.m_filePos);
+    CHECK_EQUAL(length, reader.ReadAndCompare(data, length, random));
+  }
+}
+
+TEST(CurlReadDroppedConnections)
+{
+  int retries = g_advancedSettings.m_curlretries;
+  g_advancedSettings.m_curlretries = 5;
+
+  std::string data = MakeTestData(3000000, 5);
+  unsigned int connections[] = { 1, 4 };
+  for (size_t i = 0; i < sizeof(connections) / sizeof(connections[0]); i++)
+  {
+    CTestHttpServer server(data, CTestHttpServer::DROP_CONNECTIONS);
+    CHECK(server.Start());
+
+    CTestRandom random(5);
+    CTestReader reader(server.GetUrl(), connections[i]);
+    CHECK_EQUAL(connections[i] > 1 ? 206 : 200, reader.Open(0));
+    CHECK_EQUAL((int64_t)data.size(), reader.ReadAndCompare(data, data.size(), random));
+    CHECK(server.GetDroppedResponses() > 0);
+  }
+
+  g_advancedSettings.m_curlretries = retries;
+}
+
+TEST(CurlReadIgnoredRanges)
+{
+  // the answer to the first range already tells, the file is read on one connection
+  std::string data = MakeTestData(2000000, 6);
+  CTestHttpServer server(data, CTestHttpServer::IGNORE_RANGES);
+  CHECK(server.Start());
+
+  CTestRandom random(6);
+  CTestReader reader(server.GetUrl(), 4);
+  CHECK_EQUAL(200, reader.Open(0));
+  CHECK(!reader.m_state.m_parallel);
+  CHECK_EQUAL((int64_t)data.size(), reader.m_state.m_fileSize);
+  CHECK_EQUAL((int64_t)data.size(), reader.ReadAndCompare(data, data.size(), random));
+  CHECK_EQUAL(1u, server.GetConnections());
+}
+
+TEST(CurlReadBufferedBytes)
+{
+  // a reader much slower than the connections together, the ranges waiting
+  // for it must stay within the limit
+  std::string data = MakeTestData(3000000, 7);
+  CTestHttpServer server(data, CTestHttpServer::RANGES, 4000000);
+  CHECK(server.Start());
+
+  CTestRandom random(7);
+  CTestReader reader(server.GetUrl(), 4);
+  CHECK_EQUAL(206, reader.Open(0));
+  CHECK_EQUAL((int64_t)data.size(), reader.ReadAndCompare(data, data.size(), random, 5));
+  CHECK(reader.GetMaxBuffered() > 0);
+  CHECK(reader.GetMaxBuffered() <= MAX_BUFFERED);
+}
@@ -0,0 +1,148 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "filesystem/DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
+#include "threads/SingleLock.h"
+#include "TestHelpers.h"
+#include "TestHttpServer.h"
+
+#include <unistd.h>
+#include <vector>
+
+using namespace XCURL;
+
+// the pool is keyed on the names given to it, each test uses its own
+// so sessions left idle by the others don't count
+static unsigned int CountSessions(const char *hostname)
+{
+  CSingleLock lock(g_curlInterface.m_critSection);
+  unsigned int count = 0;
+  for (size_t i = 0; i < g_curlInterface.m_sessions.size(); i++)
+  {
+    if (g_curlInterface.m_sessions[i].m_hostname == hostname)
+      count++;
+  }
+  return count;
+}
+
+static bool HasSession(CURL_HANDLE *easy)
+{
+  CSingleLock lock(g_curlInterface.m_critSection);
+  for (size_t i = 0; i < g_curlInterface.m_sessions.size(); i++)
+  {
+    if (g_curlInterface.m_sessions[i].m_easy == easy)
+      return true;
+  }
+  return false;
+}
+
+extern "C" size_t discard_callback(char *buffer, size_t size, size_t nitems, void *userp)
+{
+  return size * nitems;
+}
+
+static CURLcode Fetch(CURL_HANDLE *easy, const std::string &url)
+{
+  g_curlInterface.easy_setopt(easy, CURLOPT_URL, url.c_str());
+  g_curlInterface.easy_setopt(easy, CURLOPT_WRITEFUNCTION, discard_callback);
+  return g_curlInterface.easy_perform(easy);
+}
+
+TEST(CurlSessionReuse)
+{
+  CTestHttpServer server(MakeTestData(10000, 8), CTestHttpServer::RANGES);
+  CHECK(server.Start());
+
+  DllLibCurlGlobal::SStats before = g_curlInterface.m_stats;
+
+  CURL_HANDLE *first = NULL;
+  CURLM *multi = NULL;
+  g_curlInterface.easy_aquire("http", "sessions.reuse", &first, &multi);
+  CHECK(first != NULL);
+  CHECK_EQUAL(CURLE_OK, Fetch(first, server.GetUrl()));
+  g_curlInterface.easy_release(&first, &multi);
+
+  // the released session, with its connection, is the one handed out again
+  CURL_HANDLE *second = NULL;
+  g_curlInterface.easy_aquire("http", "sessions.reuse", &second, &multi);
+  CHECK(second != NULL);
+  CHECK_EQUAL(1u, CountSessions("sessions.reuse"));
+  CHECK_EQUAL(CURLE_OK, Fetch(second, server.GetUrl()));
+
+  long connects = -1;
+  g_curlInterface.easy_getinfo(second, CURLINFO_NUM_CONNECTS, &connects);
+  CHECK_EQUAL(0, connects);
+  g_curlInterface.easy_release(&second, &multi);
+
+  DllLibCurlGlobal::SStats after = g_curlInterface.m_stats;
+  CHECK_EQUAL(1u, after.m_created - before.m_created);
+  CHECK_EQUAL(1u, after.m_reused - before.m_reused);
+  CHECK_EQUAL(2u, after.m_transfers - before.m_transfers);
+  CHECK_EQUAL(1u, after.m_connects - before.m_connects);
+  CHECK_EQUAL(1u, server.GetConnections());
+}
+
+TEST(CurlSessionIdleLimit)
+{
+  // as many busy sessions as asked for, only the most recently released stay idle
+  const unsigned int sessions = g_advancedSettings.m_curlidlesessions + 2;
+  std::vector<CURL_HANDLE*> easy(sessions, (CURL_HANDLE*)NULL);
+  std::vector<CURLM*> multi(sessions, (CURLM*)NULL);
+  for (unsigned int i = 0; i < sessions; i++)
+  {
+    g_curlInterface.easy_aquire("http", "sessions.limit", &easy[i], &multi[i]);
+    CHECK(easy[i] != NULL);
+  }
+  CHECK_EQUAL(sessions, CountSessions("sessions.limit"));
+
+  std::vector<CURL_HANDLE*> released(easy);
+  for (unsigned int i = 0; i < sessions; i++)
+  {
+    g_curlInterface.easy_release(&easy[i], &multi[i]);
+    usleep(2000);
+  }
+  CHECK_EQUAL((unsigned int)g_advancedSettings.m_curlidlesessions, CountSessions("sessions.limit"));
+  CHECK(!HasSession(released[0]));
+  CHECK(!HasSession(released[1]));
+  for (unsigned int i = 2; i < sessions; i++)
+    CHECK(HasSession(released[i]));
+}
+
+TEST(CurlSessionIdleTimeout)
+{
+  int idletime = g_advancedSettings.m_curlidletime;
+  g_advancedSettings.m_curlidletime = 1;
+
+  CURL_HANDLE *easy = NULL;
+  CURLM *multi = NULL;
+  g_curlInterface.easy_aquire("http", "sessions.timeout", &easy, &multi);
+  g_curlInterface.easy_release(&easy, &multi);
+
+  g_curlInterface.CheckIdle();
+  CHECK_EQUAL(1u, CountSessions("sessions.timeout"));
+
+  usleep(1100 * 1000);
+  g_curlInterface.CheckIdle();
+  CHECK_EQUAL(0u, CountSessions("sessions.timeout"));
+
+  g_advancedSettings.m_curlidletime = idletime;
+}
@@ -0,0 +1,39 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include "test/TestUtils.h"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+#include <string>
+
+// random file contents, so a range delivered to the wrong place can't go unnoticed
+inline std::string MakeTestData(size_t size, uint32_t seed = 1)
+{
+  CTestRandom random(seed);
+  std::string data(size, '\0');
+  for (size_t i = 0; i < size; i++)
+    data[i] = (char)(random.Next() >> 24);
+  return data;
+}
@@ -0,0 +1,301 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "TestHttpServer.h"
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+// pieces the body is sent in, and the pause between them when throttled
+#define SEND_PIECE     16384
+#define SEND_INTERVAL  20 /* ms */
+
+struct SConnection
+{
+  CTestHttpServer* server;
+  int              fd;
+};
+
+CTestHttpServer::CTestHttpServer(const std::string &data, Mode mode, unsigned int rate)
+  : m_data(data), m_mode(mode), m_rate(rate), m_listen(-1), m_port(0), m_stop(false),
+    m_responses(0), m_rangeRequests(0), m_dropped(0)
+{
+  pthread_mutex_init(&m_lock, NULL);
+}
+
+CTestHttpServer::~CTestHttpServer()
+{
+  if (m_listen >= 0)
+  {
+    pthread_mutex_lock(&m_lock);
+    m_stop = true;
+    pthread_mutex_unlock(&m_lock);
+
+    // wakes the accept, and any connection waiting on its client
+    shutdown(m_listen, SHUT_RDWR);
+    pthread_join(m_acceptThread, NULL);
+    close(m_listen);
+
+    pthread_mutex_lock(&m_lock);
+    for (size_t i = 0; i < m_connections.size(); i++)
+      shutdown(m_connections[i], SHUT_RDWR);
+    pthread_mutex_unlock(&m_lock);
+
+    // nothing is added once the accept thread is gone
+    for (size_t i = 0; i < m_threads.size(); i++)
+      pthread_join(m_threads[i], NULL);
+    for (size_t i = 0; i < m_connections.size(); i++)
+      close(m_connections[i]);
+  }
+  pthread_mutex_destroy(&m_lock);
+}
+
+bool CTestHttpServer::Start()
+{
+  m_listen = socket(AF_INET, SOCK_STREAM, 0);
+  if (m_listen < 0)
+    return false;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = 0;
+
+  socklen_t len = sizeof(addr);
+  if (bind(m_listen, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      listen(m_listen, 16) < 0 ||
+      getsockname(m_listen, (struct sockaddr*)&addr, &len) < 0 ||
+      pthread_create(&m_acceptThread, NULL, AcceptThread, this) != 0)
+  {
+    close(m_listen);
+    m_listen = -1;
+    return false;
+  }
+
+  m_port = ntohs(addr.sin_port);
+  return true;
+}
+
+std::string CTestHttpServer::GetUrl() const
+{
+  char url[64];
+  sprintf(url, "http://127.0.0.1:%d/test.bin", m_port);
+  return url;
+}
+
+unsigned int CTestHttpServer::GetRangeRequests()
+{
+  pthread_mutex_lock(&m_lock);
+  unsigned int requests = m_rangeRequests;
+  pthread_mutex_unlock(&m_lock);
+  return requests;
+}
+
+unsigned int CTestHttpServer::GetDroppedResponses()
+{
+  pthread_mutex_lock(&m_lock);
+  unsigned int dropped = m_dropped;
+  pthread_mutex_unlock(&m_lock);
+  return dropped;
+}
+
+unsigned int CTestHttpServer::GetConnections()
+{
+  pthread_mutex_lock(&m_lock);
+  unsigned int connections = m_connections.size();
+  pthread_mutex_unlock(&m_lock);
+  return connections;
+}
+
+void *CTestHttpServer::AcceptThread(void *param)
+{
+  CTestHttpServer *server = (CTestHttpServer*)param;
+  for (;;)
+  {
+    int fd = accept(server->m_listen, NULL, NULL);
+
+    pthread_mutex_lock(&server->m_lock);
+    if (server->m_stop)
+    {
+      pthread_mutex_unlock(&server->m_lock);
+      if (fd >= 0)
+        close(fd);
+      break;
+    }
+    if (fd >= 0)
+    {
+      SConnection *connection = new SConnection;
+      connection->server = server;
+      connection->fd     = fd;
+
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, ConnectionThread, connection) == 0)
+      {
+        server->m_threads.push_back(thread);
+        server->m_connections.push_back(fd);
+      }
+      else
+      {
+        delete connection;
+        close(fd);
+      }
+    }
+    pthread_mutex_unlock(&server->m_lock);
+  }
+  return NULL;
+}
+
+void *CTestHttpServer::ConnectionThread(void *param)
+{
+  SConnection *connection = (SConnection*)param;
+  connection->server->Serve(connection->fd);
+  delete connection;
+  return NULL;
+}
+
+void CTestHttpServer::Serve(int fd)
+{
+  std::string received;
+  char buffer[4096];
+  for (;;)
+  {
+    size_t end = received.find("\r\n\r\n");
+    if (end != std::string::npos)
+    {
+      std::string request = received.substr(0, end + 2);
+      received.erase(0, end + 4);
+      if (!SendResponse(fd, request))
+        break;
+      continue;
+    }
+
+    ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+    if (got <= 0)
+      break;
+    received.append(buffer, got);
+  }
+
+  // the descriptor is closed by the destructor, so it can't be reused meanwhile
+  shutdown(fd, SHUT_RDWR);
+}
+
+static bool SendAll(int fd, const char *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+    if (sent <= 0)
+      return false;
+    data += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool CTestHttpServer::SendResponse(int fd, const std::string &request)
+{
+  int64_t size  = m_data.size();
+  int64_t start = 0;
+  int64_t end   = size - 1;
+  bool    range = false;
+
+  size_t header = request.find("\r\nRange: bytes=");
+  if (header != std::string::npos)
+  {
+    const char *spec = request.c_str() + header + 15;
+    char *next;
+    start = strtoll(spec, &next, 10);
+    if (*next == '-' && next[1] >= '0' && next[1] <= '9')
+      end = strtoll(next + 1, NULL, 10);
+    if (end > size - 1)
+      end = size - 1;
+    range = true;
+  }
+
+  bool drop;
+  pthread_mutex_lock(&m_lock);
+  if (range)
+    m_rangeRequests++;
+  drop = m_mode == DROP_CONNECTIONS && m_responses++ % 3 == 0;
+  if (drop)
+    m_dropped++;
+  pthread_mutex_unlock(&m_lock);
+
+  if (m_mode == IGNORE_RANGES)
+  {
+    start = 0;
+    end   = size - 1;
+    range = false;
+  }
+
+  char headers[256];
+  if (range && start > end)
+  {
+    sprintf(headers, "HTTP/1.1 416 Requested Range Not Satisfiable\r\n"
+                     "Content-Range: bytes */%"PRId64"\r\n"
+                     "Content-Length: 0\r\n\r\n", size);
+    return SendAll(fd, headers, strlen(headers));
+  }
+
+  // a server ignoring ranges usually claims to support them all the same
+  if (range)
+    sprintf(headers, "HTTP/1.1 206 Partial Content\r\n"
+                     "Accept-Ranges: bytes\r\n"
+                     "Content-Range: bytes %"PRId64"-%"PRId64"/%"PRId64"\r\n"
+                     "Content-Length: %"PRId64"\r\n\r\n", start, end, size, end - start + 1);
+  else
+    sprintf(headers, "HTTP/1.1 200 OK\r\n"
+                     "Accept-Ranges: bytes\r\n"
+                     "Content-Length: %"PRId64"\r\n\r\n", size);
+
+  if (!SendAll(fd, headers, strlen(headers)))
+    return false;
+
+  // a dropped response ends halfway through its body
+  int64_t last = drop ? start + (end - start + 1) / 2 : end + 1;
+  size_t  piece = SEND_PIECE;
+  if (m_rate)
+    piece = m_rate * SEND_INTERVAL / 1000 + 1;
+
+  for (int64_t pos = start; pos < last; pos += piece)
+  {
+    pthread_mutex_lock(&m_lock);
+    bool stop = m_stop;
+    pthread_mutex_unlock(&m_lock);
+    if (stop)
+      return false;
+
+    size_t amount = (size_t)std::min((int64_t)piece, last - pos);
+    if (!SendAll(fd, m_data.c_str() + pos, amount))
+      return false;
+    if (m_rate)
+      usleep(SEND_INTERVAL * 1000);
+  }
+  return !drop;
+}
@@ -0,0 +1,75 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+/*
+ * A minimal HTTP/1.1 server on the loopback interface for the curl tests. It
+ * serves a single file on keep-alive connections, can throttle each
+ * connection, and can misbehave the way real servers do.
+ */
+class CTestHttpServer
+{
+public:
+  enum Mode
+  {
+    RANGES,           // honour range requests
+    IGNORE_RANGES,    // always answer with the whole file
+    DROP_CONNECTIONS  // cut the first and every third response short, closing the connection
+  };
+
+  /*! \brief Create a server for the given file contents
+   \param rate bytes per second sent on each connection, 0 for no limit
+   */
+  CTestHttpServer(const std::string &data, Mode mode, unsigned int rate = 0);
+  ~CTestHttpServer();
+
+  bool        Start();
+  std::string GetUrl() const;
+
+  unsigned int GetRangeRequests();
+  unsigned int GetDroppedResponses();
+  unsigned int GetConnections();
+
+private:
+  static void *AcceptThread(void *param);
+  static void *ConnectionThread(void *param);
+  void         Serve(int fd);
+  bool         SendResponse(int fd, const std::string &request);
+
+  std::string            m_data;
+  Mode                   m_mode;
+  unsigned int           m_rate;
+  int                    m_listen;
+  int                    m_port;
+  bool                   m_stop;
+  pthread_t              m_acceptThread;
+  pthread_mutex_t        m_lock;
+  std::vector<pthread_t> m_threads;
+  std::vector<int>       m_connections;
+  unsigned int           m_responses;
+  unsigned int           m_rangeRequests;
+  unsigned int           m_dropped;
+};
@@ -0,0 +1,123 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * The settings and the library loading the read side of CCurlFile needs on
+ * top of the common stubs in test/TestStubs.cpp
+ */
+
+#include "DynamicDll.h"
+#include "cores/DllLoader/LibraryLoader.h"
+#include "filesystem/DllLibCurl.h"
+#include "settings/AdvancedSettings.h"
+#include "utils/log.h"
+
+#include <dlfcn.h>
+
+// only the settings the curl code reads
+CAdvancedSettings::CAdvancedSettings()
+{
+  m_logLevel           = LOG_LEVEL_NONE;
+  m_curlretries        = 2;
+  m_curlconnections    = 4;
+  m_curlchunksize      = 1048576;
+  m_curlbuffersize     = 8388608;
+  m_curlidlesessions   = 4;
+  m_curlidletime       = 5;
+}
+
+XCURL::DllLibCurlGlobal g_curlInterface;
+
+// the system libcurl, opened by the name xbmc would load it by
+class CTestLoader : public LibraryLoader
+{
+public:
+  CTestLoader(const char *file) : LibraryLoader(file), m_handle(NULL) {}
+  virtual ~CTestLoader() { Unload(); }
+
+  virtual bool Load()
+  {
+    m_handle = dlopen(GetFileName(), RTLD_NOW | RTLD_LOCAL);
+    return m_handle != NULL;
+  }
+
+  virtual void Unload()
+  {
+    if (m_handle)
+      dlclose(m_handle);
+    m_handle = NULL;
+  }
+
+  virtual int ResolveExport(const char* symbol, void** ptr, bool logging = true)
+  {
+    *ptr = m_handle ? dlsym(m_handle, symbol) : NULL;
+    return *ptr != NULL;
+  }
+
+  virtual bool    IsSystemDll() { return true; }
+  virtual HMODULE GetHModule()  { return (HMODULE)m_handle; }
+  virtual bool    HasSymbols()  { return false; }
+
+private:
+  void *m_handle;
+};
+
+DllDynamic::DllDynamic(const CStdString& strDllName)
+{
+  m_strDllName = strDllName;
+  m_dll = NULL;
+  m_DelayUnload = true;
+}
+
+DllDynamic::~DllDynamic()
+{
+  Unload();
+}
+
+bool DllDynamic::Load()
+{
+  if (m_dll)
+    return true;
+
+  CTestLoader *loader = new CTestLoader(m_strDllName.c_str());
+  m_dll = loader;
+  if (!loader->Load() || !ResolveExports())
+  {
+    Unload();
+    return false;
+  }
+  return true;
+}
+
+void DllDynamic::Unload()
+{
+  delete m_dll;
+  m_dll = NULL;
+}
+
+bool DllDynamic::EnableDelayedUnload(bool bOnOff)
+{
+  if (m_dll)
+    return false;
+
+  m_DelayUnload = bOnOff;
+  return true;
+}
@@ -24,9 +24,14 @@
 #include "libsquish/squish.h"
 #include "utils/log.h"
 #include <string.h>
+#include <vector>
 
 #ifndef NO_XBMC_FILESYSTEM
 #include "filesystem/File.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "utils/CPUInfo.h"
+#include "utils/JobManager.h"
 using namespace XFILE;
 #else
 #include "SimpleFS.h"
@@ -34,6 +39,123 @@ using namespace XFILE;
 
 using namespace std;
 
+// smallest band of 4 pixel block rows worth handing to another thread
+#define DXT_MIN_BAND_ROWS 16
+
+/*! \brief A band of block rows of an image, compressed and measured on its own
+ */
+class CDXTBand
+{
+public:
+  CDXTBand(unsigned char const *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *dxt, int flags)
+    : m_argb(argb), m_width(width), m_height(height), m_pitch(pitch), m_dxt(dxt), m_flags(flags), m_colorMSE(0), m_alphaMSE(0)
+  {
+  }
+
+  void Run()
+  {
+    squish::CompressImage(m_argb, m_width, m_height, m_pitch, m_dxt, m_flags);
+    squish::ComputeMSE(m_argb, m_width, m_height, m_pitch, m_dxt, m_flags, m_colorMSE, m_alphaMSE);
+  }
+
+  unsigned char const *m_argb;
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_pitch;
+  unsigned char *m_dxt;
+  int m_flags;
+  double m_colorMSE;
+  double m_alphaMSE;
+};
+
+#ifndef NO_XBMC_FILESYSTEM
+/*! \brief The bands of an image, compressed by whichever thread takes them first
+ The thread compressing the image takes bands as well, so it never waits on a job
+ that hasn't started yet. Jobs starting late find no band left, they keep the
+ set alive by reference until then.
+ */
+class CDXTBandSet
+{
+public:
+  CDXTBandSet(const std::vector<CDXTBand> &bands) : m_bands(bands), m_next(0), m_done(0), m_refs(1) {}
+
+  void Acquire() { AtomicIncrement(&m_refs); }
+  void Release()
+  {
+    if (AtomicDecrement(&m_refs) == 0)
+      delete this;
+  }
+
+  void Run()
+  {
+    long band;
+    while ((band = AtomicIncrement(&m_next) - 1) < (long)m_bands.size())
+    {
+      m_bands[band].Run();
+      if (AtomicIncrement(&m_done) == (long)m_bands.size())
+        m_finished.Set();
+    }
+  }
+
+  void Wait() { m_finished.Wait(); }
+
+  std::vector<CDXTBand> m_bands;
+
+private:
+  volatile long m_next;
+  volatile long m_done;
+  volatile long m_refs;
+  CEvent        m_finished;
+};
+
+class CDXTBandJob : public CJob
+{
+public:
+  CDXTBandJob(CDXTBandSet *set) : m_set(set) { m_set->Acquire(); }
+  virtual ~CDXTBandJob() { m_set->Release(); }
+
+  virtual bool DoWork()
+  {
+    m_set->Run();
+    return true;
+  }
+
+  virtual const char *GetType() const { return "ddsbands"; }
+
+private:
+  CDXTBandSet *m_set;
+};
+#endif
+
+/*! \brief Compress the bands of an image, in parallel on the job workers when there are several
+ */
+static void CompressBands(std::vector<CDXTBand> &bands)
+{
+#ifndef NO_XBMC_FILESYSTEM
+  if (bands.size() > 1)
+  {
+    CDXTBandSet *set = new CDXTBandSet(bands);
+    std::vector<unsigned int> jobs;
+    for (unsigned int i = 1; i < bands.size(); i++)
+      jobs.push_back(CJobManager::GetInstance().AddJob(new CDXTBandJob(set), NULL, CJob::PRIORITY_NORMAL));
+
+    set->Run();
+    set->Wait();
+
+    // the jobs still queued have nothing left to do
+    for (unsigned int i = 0; i < jobs.size(); i++)
+      CJobManager::GetInstance().CancelJob(jobs[i]);
+
+    bands = set->m_bands;
+    set->Release();
+    return;
+  }
+#endif
+
+  for (unsigned int i = 0; i < bands.size(); i++)
+    bands[i].Run();
+}
+
 CDDSImage::CDDSImage()
 {
   m_data = NULL;
@@ -118,9 +240,9 @@ bool CDDSImage::ReadFile(const std::string &inputFile)
   return true;
 }
 
-bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+bool CDDSImage::Create(const std::string &outputFile, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE, bool fast)
 {
-  if (!Compress(width, height, pitch, brga, maxMSE))
+  if (!Compress(width, height, pitch, brga, maxMSE, fast))
   { // use ARGB
     Allocate(width, height, XB_FMT_A8R8G8B8);
     for (unsigned int i = 0; i < height; i++)
@@ -160,16 +282,17 @@ unsigned int CDDSImage::GetStorageRequirements(unsigned int width, unsigned int
   }
 }
 
-bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE)
+bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *brga, double maxMSE, bool fast)
 {
+  int quality = fast ? squish::kColourRangeFit : squish::kColourClusterFit;
+
   // first try DXT1, which is only 4bits/pixel
   Allocate(width, height, XB_FMT_DXT1);
 
-  squish::CompressImage(brga, width, height, pitch, m_data, squish::kDxt1 | squish::kSourceBGRA);
+  double colorMSE, alphaMSE;
+  CompressImage(brga, width, height, pitch, m_data, squish::kDxt1 | squish::kSourceBGRA | quality, colorMSE, alphaMSE);
   const char *fourCC = NULL;
 
-  double colorMSE, alphaMSE;
-  squish::ComputeMSE(brga, width, height, pitch, m_data, squish::kDxt1 | squish::kSourceBGRA, colorMSE, alphaMSE);
   if (!maxMSE || (colorMSE < maxMSE && alphaMSE < maxMSE))
     fourCC = "DXT1";
   else
@@ -188,14 +311,12 @@ bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int p
     if (alphaMSE > 0)
     { // try DXT3 and DXT5 - use whichever is better (color is the same as DXT1, but alpha will be different)
       Allocate(width, height, XB_FMT_DXT3);
-      squish::CompressImage(brga, width, height, pitch, m_data, squish::kDxt3 | squish::kSourceBGRA);
-      squish::ComputeMSE(brga, width, height, pitch, m_data, squish::kDxt3 | squish::kSourceBGRA, colorMSE, alphaMSE);
+      CompressImage(brga, width, height, pitch, m_data, squish::kDxt3 | squish::kSourceBGRA | quality, colorMSE, alphaMSE);
       if (colorMSE < maxMSE)
       { // color is fine, test DXT5 as well
         double dxt5MSE;
         unsigned char *data2 = new unsigned char[GetStorageRequirements(width, height, XB_FMT_DXT5)];
-        squish::CompressImage(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA);
-        squish::ComputeMSE(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA, colorMSE, dxt5MSE);
+        CompressImage(brga, width, height, pitch, data2, squish::kDxt5 | squish::kSourceBGRA | quality, colorMSE, dxt5MSE);
         if (alphaMSE < maxMSE && alphaMSE < dxt5MSE)
           fourCC = "DXT3";
         else if (dxt5MSE < maxMSE)
@@ -218,6 +339,41 @@ bool CDDSImage::Compress(unsigned int width, unsigned int height, unsigned int p
   return false;
 }
 
+void CDDSImage::CompressImage(unsigned char const *brga, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *dxt, int flags, double &colorMSE, double &alphaMSE)
+{
+  unsigned int blockRows = (height + 3) / 4;
+  unsigned int bytesPerRow = ((width + 3) / 4) * ((flags & squish::kDxt1) ? 8 : 16);
+
+  unsigned int numBands = 1;
+#ifndef NO_XBMC_FILESYSTEM
+  numBands = std::max(1u, std::min((unsigned int)g_cpuInfo.getCPUCount(), blockRows / DXT_MIN_BAND_ROWS));
+#endif
+
+  // split the block rows evenly, blocks never straddle two bands
+  std::vector<CDXTBand> bands;
+  bands.reserve(numBands);
+  unsigned int row = 0;
+  for (unsigned int i = 0; i < numBands; i++)
+  {
+    unsigned int rows = blockRows / numBands + (i < blockRows % numBands ? 1 : 0);
+    unsigned int y = row * 4;
+    bands.push_back(CDXTBand(brga + y * pitch, width, std::min(rows * 4, height - y), pitch, dxt + row * bytesPerRow, flags));
+    row += rows;
+  }
+
+  CompressBands(bands);
+
+  // the error of each band is averaged over its own pixels
+  colorMSE = alphaMSE = 0;
+  for (unsigned int i = 0; i < numBands; i++)
+  {
+    colorMSE += bands[i].m_colorMSE * bands[i].m_height;
+    alphaMSE += bands[i].m_alphaMSE * bands[i].m_height;
+  }
+  colorMSE /= height;
+  alphaMSE /= height;
+}
+
 bool CDDSImage::Decompress(unsigned char *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *dxt, unsigned int format)
 {
   if (!argb || !dxt || !(format & XB_FMT_DXT_MASK))
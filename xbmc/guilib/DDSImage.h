@@ -46,9 +46,10 @@ public:
    \param pitch pitch of the pixel buffer
    \param argb pixel buffer
    \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \param fast use the fast but lower quality colour compressor, for bulk conversions
    \return true on successful image creation, false otherwise
    */
-  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  bool Create(const std::string &file, unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0, bool fast = false);
   
   /*! \brief Decompress a DXT1/3/5 image to the given buffer
    Assumes the buffer has been allocated to at least width*height*4
@@ -73,9 +74,24 @@ private:
    \param pitch pitch of the pixel buffer
    \param argb pixel buffer
    \param maxMSE maximum mean square error to allow, ignored if 0 (the default)
+   \param fast use the fast but lower quality colour compressor
    \return true on successful compression within the given maxMSE, false otherwise
    */
-  bool Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0);
+  bool Compress(unsigned int width, unsigned int height, unsigned int pitch, unsigned char const *argb, double maxMSE = 0, bool fast = false);
+
+  /*! \brief Compress an ARGB buffer with the given squish flags and compute the error of the result
+   The image is split into bands of block rows, one per CPU, which are compressed
+   in parallel by this thread and by jobs of the job manager.
+   \param argb pixel buffer
+   \param width width of the pixel buffer
+   \param height height of the pixel buffer
+   \param pitch pitch of the pixel buffer
+   \param dxt buffer for the compressed data
+   \param flags squish compression flags
+   \param colorMSE [out] mean square error of the colour channels
+   \param alphaMSE [out] mean square error of the alpha channel
+   */
+  static void CompressImage(unsigned char const *argb, unsigned int width, unsigned int height, unsigned int pitch, unsigned char *dxt, int flags, double &colorMSE, double &alphaMSE);
 
   unsigned int GetStorageRequirements(unsigned int width, unsigned int height, unsigned int format) const;
   enum {
@@ -29,6 +29,7 @@
 #include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
 #include "GUIStaticItem.h"
+#include "GUITexture.h"
 #include "Key.h"
 #include "utils/MathUtils.h"
 #include "utils/XBMCTinyXML.h"
@@ -196,6 +197,9 @@ void CGUIBaseContainer::Render()
 
   if (g_graphicsContext.SetClipRegion(m_posX, m_posY, m_width, m_height))
   {
+    // items tend to repeat the same images, so draw those that follow each other together
+    CGUITexture::BeginBatch();
+
     CPoint origin = CPoint(m_posX, m_posY) + m_renderOffset;
     float pos = (m_orientation == VERTICAL) ? origin.y : origin.x;
     float end = (m_orientation == VERTICAL) ? m_posY + m_height : m_posX + m_width;
@@ -247,6 +251,7 @@ void CGUIBaseContainer::Render()
         RenderItem(focusedPos, origin.y, focusedItem.get(), true);
     }
 
+    CGUITexture::EndBatch();
     g_graphicsContext.RestoreClipRegion();
   }
 
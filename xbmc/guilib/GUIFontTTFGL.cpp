@@ -24,6 +24,7 @@
 #include "GUIFontTTFGL.h"
 #include "GUIFontManager.h"
 #include "Texture.h"
+#include "GUITexture.h"
 #include "GraphicContext.h"
 #include "gui3d.h"
 #include "utils/log.h"
@@ -56,6 +57,8 @@ void CGUIFontTTFGL::Begin()
 {
   if (m_nestedBeginCount == 0)
   {
+    CGUITexture::FlushBatch();
+
     if (!m_bTextureLoaded)
     {
       // Have OpenGL generate a texture object handle for us
@@ -83,6 +83,7 @@ CGUITextureBase::CGUITextureBase(float posX, float posY, float width, float heig
 
   m_allocateDynamically = false;
   m_isAllocated = NO;
+  m_largeWidth = m_largeHeight = 0;
   m_invalid = true;
 }
 
@@ -119,6 +120,7 @@ CGUITextureBase::CGUITextureBase(const CGUITextureBase &right)
   m_currentLoop = 0;
 
   m_isAllocated = NO;
+  m_largeWidth = m_largeHeight = 0;
   m_invalid = true;
 }
 
@@ -312,8 +314,13 @@ bool CGUITextureBase::AllocResources()
     }
     if (m_isAllocated != NORMAL)
     { // use our large image background loader
+      if (!IsAllocated())
+      { // request the image at the size we render it, rounded up so similar sized controls share it
+        m_largeWidth = ((unsigned int)(m_width * g_graphicsContext.GetGUIScaleX()) + 63) & ~63;
+        m_largeHeight = ((unsigned int)(m_height * g_graphicsContext.GetGUIScaleY()) + 63) & ~63;
+      }
       CTextureArray texture;
-      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated()))
+      if (g_largeTextureManager.GetImage(m_info.filename, texture, !IsAllocated(), m_largeWidth, m_largeHeight))
       {
         m_isAllocated = LARGE;
 
@@ -456,7 +463,7 @@ bool CGUITextureBase::CalculateSize()
 void CGUITextureBase::FreeResources(bool immediately /* = false */)
 {
   if (m_isAllocated == LARGE || m_isAllocated == LARGE_FAILED)
-    g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED));
+    g_largeTextureManager.ReleaseImage(m_info.filename, immediately || (m_isAllocated == LARGE_FAILED), m_largeWidth, m_largeHeight);
   else if (m_isAllocated == NORMAL && m_texture.size())
     g_TextureManager.ReleaseTexture(m_info.filename);
 
@@ -475,6 +482,7 @@ void CGUITextureBase::FreeResources(bool immediately /* = false */)
   Free();
 
   m_isAllocated = NO;
+  m_largeWidth = m_largeHeight = 0;
 }
 
 void CGUITextureBase::DynamicResourceAlloc(bool allocateDynamically)
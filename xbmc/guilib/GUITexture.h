@@ -120,6 +120,22 @@ public:
   bool IsAllocated() const { return m_isAllocated != NO; };
   bool FailedToAlloc() const { return m_isAllocated == NORMAL_FAILED || m_isAllocated == LARGE_FAILED; };
   bool ReadyToRender() const;
+
+  /*! \brief Batch the textures rendered until EndBatch()
+   Consecutive textures using the same images are then drawn with a single draw call once the images
+   change, the batch ends or FlushBatch() is called.  Anything rendering other than through a texture
+   within a batch must call FlushBatch() first.  Batches may be nested.  Renderers that don't batch
+   implement these as no-ops.
+   */
+  static void BeginBatch() {};
+  static void EndBatch() {};
+  static void FlushBatch() {};
+  /*! \brief Draw anything pending and start counting draw calls for the next frame
+   */
+  static void EndFrame() {};
+  /*! \brief Retrieve the number of texture draw calls and quads of the last frame
+   */
+  static void GetDrawStats(unsigned int &drawCalls, unsigned int &quads) { drawCalls = quads = 0; };
 protected:
   bool CalculateSize();
   void LoadDiffuseImage();
@@ -163,6 +179,7 @@ protected:
   bool m_allocateDynamically;
   enum ALLOCATE_TYPE { NO = 0, NORMAL, LARGE, NORMAL_FAILED, LARGE_FAILED };
   ALLOCATE_TYPE m_isAllocated;
+  unsigned int m_largeWidth, m_largeHeight; // size the texture was requested at from the large texture manager
 
   CTextureInfo m_info;
   CAspectRatio m_aspect;
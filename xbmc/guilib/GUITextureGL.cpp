@@ -29,6 +29,15 @@
 
 #if defined(HAS_GL)
 
+std::vector<CGUITextureGL::PackedVertex> CGUITextureGL::m_batchVertices;
+CBaseTexture *CGUITextureGL::m_batchTexture = NULL;
+CBaseTexture *CGUITextureGL::m_batchDiffuse = NULL;
+int CGUITextureGL::m_batchNesting = 0;
+unsigned int CGUITextureGL::m_drawCalls = 0;
+unsigned int CGUITextureGL::m_quads = 0;
+unsigned int CGUITextureGL::m_lastDrawCalls = 0;
+unsigned int CGUITextureGL::m_lastQuads = 0;
+
 CGUITextureGL::CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo &texture)
 : CGUITextureBase(posX, posY, width, height, texture)
 {
@@ -42,9 +51,20 @@ void CGUITextureGL::Begin(color_t color)
   m_col[3] = (GLubyte)GET_A(color);
 
   CBaseTexture* texture = m_texture.m_textures[m_currentFrame];
+  CBaseTexture* diffuse = m_diffuse.size() ? m_diffuse.m_textures[0] : NULL;
+
+  // keep adding to the pending quads if they use the same textures. Uploads rebind
+  // the texture units, so they can't happen while quads are pending either.
+  if (texture != m_batchTexture || diffuse != m_batchDiffuse ||
+      texture->GetPixels() || (diffuse && diffuse->GetPixels()))
+    FlushBatch();
+
+  if (!m_batchVertices.empty())
+    return;
+
   texture->LoadToGPU();
-  if (m_diffuse.size())
-    m_diffuse.m_textures[0]->LoadToGPU();
+  if (diffuse)
+    diffuse->LoadToGPU();
 
   texture->BindToUnit(0);
 
@@ -61,9 +81,9 @@ void CGUITextureGL::Begin(color_t color)
   glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
   VerifyGLState();
 
-  if (m_diffuse.size())
+  if (diffuse)
   {
-    m_diffuse.m_textures[0]->BindToUnit(1);
+    diffuse->BindToUnit(1);
     glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
     glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
     glTexEnvf(GL_TEXTURE_ENV, GL_SOURCE0_RGB, GL_TEXTURE1);
@@ -72,71 +92,128 @@ void CGUITextureGL::Begin(color_t color)
     glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND1_RGB, GL_SRC_COLOR);
     VerifyGLState();
   }
-  //glDisable(GL_TEXTURE_2D); // uncomment these 2 lines to switch to wireframe rendering
-  //glBegin(GL_LINE_LOOP);
-  glBegin(GL_QUADS);
+
+  m_batchTexture = texture;
+  m_batchDiffuse = diffuse;
 }
 
 void CGUITextureGL::End()
 {
-  glEnd();
-  if (m_diffuse.size())
-  {
-    glDisable(GL_TEXTURE_2D);
-    glActiveTextureARB(GL_TEXTURE0_ARB);
-  }
-  glDisable(GL_TEXTURE_2D);
+  if (!m_batchNesting)
+    FlushBatch();
 }
 
 void CGUITextureGL::Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation)
 {
+  PackedVertex vertices[4];
+  for (int i = 0; i < 4; i++)
+  {
+    vertices[i].x = x[i];
+    vertices[i].y = y[i];
+    vertices[i].z = z[i];
+    vertices[i].r = m_col[0];
+    vertices[i].g = m_col[1];
+    vertices[i].b = m_col[2];
+    vertices[i].a = m_col[3];
+  }
+
   // Top-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y1);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y1);
-  glVertex3f(x[0], y[0], z[0]);
+  vertices[0].u1 = texture.x1;
+  vertices[0].v1 = texture.y1;
+  vertices[0].u2 = diffuse.x1;
+  vertices[0].v2 = diffuse.y1;
 
   // Top-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  if (m_diffuse.size())
-  {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-  }
-  glVertex3f(x[1], y[1], z[1]);
+  vertices[1].u1 = (orientation & 4) ? texture.x1 : texture.x2;
+  vertices[1].v1 = (orientation & 4) ? texture.y2 : texture.y1;
+  vertices[1].u2 = (m_info.orientation & 4) ? diffuse.x1 : diffuse.x2;
+  vertices[1].v2 = (m_info.orientation & 4) ? diffuse.y2 : diffuse.y1;
 
   // Bottom-right vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y2);
-  if (m_diffuse.size())
-    glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y2);
-  glVertex3f(x[2], y[2], z[2]);
+  vertices[2].u1 = texture.x2;
+  vertices[2].v1 = texture.y2;
+  vertices[2].u2 = diffuse.x2;
+  vertices[2].v2 = diffuse.y2;
 
   // Bottom-left vertex (corner)
-  glColor4ub(m_col[0], m_col[1], m_col[2], m_col[3]);
-  if (orientation & 4)
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x2, texture.y1);
-  else
-    glMultiTexCoord2fARB(GL_TEXTURE0_ARB, texture.x1, texture.y2);
-  if (m_diffuse.size())
+  vertices[3].u1 = (orientation & 4) ? texture.x2 : texture.x1;
+  vertices[3].v1 = (orientation & 4) ? texture.y1 : texture.y2;
+  vertices[3].u2 = (m_info.orientation & 4) ? diffuse.x2 : diffuse.x1;
+  vertices[3].v2 = (m_info.orientation & 4) ? diffuse.y1 : diffuse.y2;
+
+  m_batchVertices.insert(m_batchVertices.end(), vertices, vertices + 4);
+}
+
+void CGUITextureGL::BeginBatch()
+{
+  m_batchNesting++;
+}
+
+void CGUITextureGL::EndBatch()
+{
+  if (m_batchNesting > 0 && --m_batchNesting == 0)
+    FlushBatch();
+}
+
+void CGUITextureGL::FlushBatch()
+{
+  if (m_batchVertices.empty())
+    return;
+
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+  PackedVertex *vertices = &m_batchVertices[0];
+  glVertexPointer(3, GL_FLOAT, sizeof(PackedVertex), (char*)vertices + offsetof(PackedVertex, x));
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PackedVertex), (char*)vertices + offsetof(PackedVertex, r));
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glClientActiveTextureARB(GL_TEXTURE0_ARB);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), (char*)vertices + offsetof(PackedVertex, u1));
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  if (m_batchDiffuse)
   {
-    if (m_info.orientation & 4)
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x2, diffuse.y1);
-    else
-      glMultiTexCoord2fARB(GL_TEXTURE1_ARB, diffuse.x1, diffuse.y2);
+    glClientActiveTextureARB(GL_TEXTURE1_ARB);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(PackedVertex), (char*)vertices + offsetof(PackedVertex, u2));
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
   }
-  glVertex3f(x[3], y[3], z[3]);
+  glDrawArrays(GL_QUADS, 0, m_batchVertices.size());
+
+  glPopClientAttrib();
+  glClientActiveTextureARB(GL_TEXTURE0_ARB);
+
+  if (m_batchDiffuse)
+  {
+    glDisable(GL_TEXTURE_2D);
+    glActiveTextureARB(GL_TEXTURE0_ARB);
+  }
+  glDisable(GL_TEXTURE_2D);
+
+  m_drawCalls++;
+  m_quads += m_batchVertices.size() / 4;
+  m_batchVertices.clear();
+  m_batchTexture = NULL;
+  m_batchDiffuse = NULL;
+}
+
+void CGUITextureGL::EndFrame()
+{
+  FlushBatch();
+  m_lastDrawCalls = m_drawCalls;
+  m_lastQuads = m_quads;
+  m_drawCalls = 0;
+  m_quads = 0;
+}
+
+void CGUITextureGL::GetDrawStats(unsigned int &drawCalls, unsigned int &quads)
+{
+  drawCalls = m_lastDrawCalls;
+  quads = m_lastQuads;
 }
 
 void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *texture, const CRect *texCoords)
 {
+  FlushBatch();
+
   if (texture)
   {
     texture->LoadToGPU();
@@ -181,6 +258,9 @@ void CGUITextureGL::DrawQuad(const CRect &rect, color_t color, CBaseTexture *tex
   glEnd();
   if (texture)
     glDisable(GL_TEXTURE_2D);
+
+  m_drawCalls++;
+  m_quads++;
 }
 
 #endif
@@ -31,6 +31,8 @@
 
 #include "GUITexture.h"
 
+#include <vector>
+
 #include "system_gl.h"
 
 class CGUITextureGL : public CGUITextureBase
@@ -38,12 +40,38 @@ class CGUITextureGL : public CGUITextureBase
 public:
   CGUITextureGL(float posX, float posY, float width, float height, const CTextureInfo& texture);
   static void DrawQuad(const CRect &coords, color_t color, CBaseTexture *texture = NULL, const CRect *texCoords = NULL);
+
+  static void BeginBatch();
+  static void EndBatch();
+  static void FlushBatch();
+  static void EndFrame();
+  static void GetDrawStats(unsigned int &drawCalls, unsigned int &quads);
 protected:
   void Begin(color_t color);
   void Draw(float *x, float *y, float *z, const CRect &texture, const CRect &diffuse, int orientation);
   void End();
 private:
   GLubyte m_col[4];
+
+  struct PackedVertex
+  {
+    float x, y, z;
+    GLubyte r, g, b, a;
+    float u1, v1;
+    float u2, v2;
+  };
+
+  // quads waiting to be drawn, all sharing the same textures
+  static std::vector<PackedVertex> m_batchVertices;
+  static CBaseTexture *m_batchTexture;
+  static CBaseTexture *m_batchDiffuse;
+  static int m_batchNesting;
+
+  // draw calls and quads of the current and last frame
+  static unsigned int m_drawCalls;
+  static unsigned int m_quads;
+  static unsigned int m_lastDrawCalls;
+  static unsigned int m_lastQuads;
 };
 
 #endif
@@ -27,6 +27,7 @@
 #include "GUIControlFactory.h"
 #include "GUIControlGroup.h"
 #include "GUIControlProfiler.h"
+#include "TextureManager.h"
 #include "settings/Settings.h"
 #ifdef PRE_SKIN_VERSION_9_10_COMPATIBILITY
 #include "GUIEditControl.h"
@@ -48,6 +49,8 @@
 #include "utils/PerformanceSample.h"
 #endif
 
+#include <algorithm>
+
 using namespace std;
 
 CGUIWindow::CGUIWindow(int id, const CStdString &xmlFile)
@@ -126,6 +129,22 @@ bool CGUIWindow::LoadXML(const CStdString &strPath, const CStdString &strLowerPa
   return Load(xmlDoc);
 }
 
+// collect the textures named anywhere below the given element
+static void GetTextures(const TiXmlElement *element, std::vector<CStdString> &textures)
+{
+  for (const TiXmlElement *child = element->FirstChildElement(); child; child = child->NextSiblingElement())
+  {
+    if (strstr(child->Value(), "texture") && child->FirstChild())
+    {
+      CStdString texture = child->FirstChild()->Value();
+      if (!texture.IsEmpty() && texture.Find('$') < 0) // skip info labels
+        textures.push_back(texture);
+    }
+    else
+      GetTextures(child, textures);
+  }
+}
+
 bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
 {
   TiXmlElement* pRootElement = xmlDoc.RootElement();
@@ -141,6 +160,11 @@ bool CGUIWindow::Load(CXBMCTinyXML &xmlDoc)
 
   // Resolve any includes that may be present
   g_SkinInfo->ResolveIncludes(pRootElement);
+
+  m_textures.clear();
+  GetTextures(pRootElement, m_textures);
+  std::sort(m_textures.begin(), m_textures.end());
+  m_textures.erase(std::unique(m_textures.begin(), m_textures.end()), m_textures.end());
   // now load in the skin file
   SetDefaults();
 
@@ -689,6 +713,9 @@ void CGUIWindow::AllocResources(bool forceLoad /*= FALSE */)
   int64_t slend;
   slend = CurrentHostCounter();
 
+  // have the textures read from disk while the first ones are being loaded
+  g_TextureManager.PreloadTextures(m_textures);
+
   // and now allocate resources
   CGUIControlGroup::AllocResources();
 
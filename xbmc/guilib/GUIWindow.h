@@ -252,6 +252,7 @@ protected:
    */
   virtual CPoint GetPosition() const;
   std::vector<COrigin> m_origins;  // positions of dialogs depending on base window
+  std::vector<CStdString> m_textures; // textures named by the controls, read ahead of allocating them
 
   // control states
   int m_lastControlID;
@@ -33,6 +33,7 @@
 #include "settings/AdvancedSettings.h"
 #include "addons/Skin.h"
 #include "GUITexture.h"
+#include "GUILargeTextureManager.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/Variant.h"
 
@@ -495,6 +496,9 @@ void CGUIWindowManager::Process(unsigned int currentTime)
   assert(g_application.IsCurrentThread());
   CSingleLock lock(g_graphicsContext);
 
+  // make loaded images available to the controls processed below
+  g_largeTextureManager.UploadImages();
+
   CDirtyRegionList dirtyregions;
 
   CGUIWindow* pWindow = GetWindow(GetActiveWindow());
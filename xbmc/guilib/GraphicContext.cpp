@@ -30,6 +30,7 @@
 #include "cores/VideoRenderers/RenderManager.h"
 #include "windowing/WindowingFactory.h"
 #include "TextureManager.h"
+#include "GUITexture.h"
 #include "input/MouseStat.h"
 #include "GUIWindowManager.h"
 #include "utils/JobManager.h"
@@ -154,6 +155,8 @@ void CGraphicContext::ClipRect(CRect &vertex, CRect &texture, CRect *texture2)
 
 bool CGraphicContext::SetViewPort(float fx, float fy, float fwidth, float fheight, bool intersectPrevious /* = false */)
 {
+  // textures batched so far must be drawn with the render state they were batched under
+  CGUITexture::FlushBatch();
   CRect oldviewport;
   g_Windowing.GetViewPort(oldviewport);
 
@@ -226,6 +229,7 @@ bool CGraphicContext::SetViewPort(float fx, float fy, float fwidth, float fheigh
 
 void CGraphicContext::RestoreViewPort()
 {
+  CGUITexture::FlushBatch();
   if (!m_viewStack.size()) return;
 
   CRect oldviewport = m_viewStack.top();
@@ -238,6 +242,7 @@ void CGraphicContext::RestoreViewPort()
 
 void CGraphicContext::SetScissors(const CRect &rect)
 {
+  CGUITexture::FlushBatch();
   m_scissors = rect;
   m_scissors.Intersect(CRect(0,0,(float)m_iScreenWidth, (float)m_iScreenHeight));
   g_Windowing.SetScissors(m_scissors);
@@ -245,6 +250,7 @@ void CGraphicContext::SetScissors(const CRect &rect)
 
 void CGraphicContext::ResetScissors()
 {
+  CGUITexture::FlushBatch();
   m_scissors.SetRect(0, 0, (float)m_iScreenWidth, (float)m_iScreenHeight);
   g_Windowing.ResetScissors(); // SetScissors(m_scissors) instead?
 }
@@ -545,16 +551,19 @@ float CGraphicContext::GetPixelRatio(RESOLUTION iRes) const
 
 void CGraphicContext::Clear(color_t color)
 {
+  CGUITexture::FlushBatch();
   g_Windowing.ClearBuffers(color);
 }
 
 void CGraphicContext::CaptureStateBlock()
 {
+  CGUITexture::FlushBatch();
   g_Windowing.CaptureStateBlock();
 }
 
 void CGraphicContext::ApplyStateBlock()
 {
+  CGUITexture::FlushBatch();
   g_Windowing.ApplyStateBlock();
 }
 
@@ -726,6 +735,7 @@ CRect CGraphicContext::generateAABB(const CRect &rect) const
 //       to cut down on one setting)
 void CGraphicContext::UpdateCameraPosition(const CPoint &camera)
 {
+  CGUITexture::FlushBatch();
   g_Windowing.SetCameraPosition(camera, m_iScreenWidth, m_iScreenHeight);
 }
 
@@ -808,16 +818,19 @@ void CGraphicContext::SetMediaDir(const CStdString &strMediaDir)
 
 void CGraphicContext::Flip(const CDirtyRegionList& dirty)
 {
+  CGUITexture::EndFrame();
   g_Windowing.PresentRender(dirty);
 }
 
 void CGraphicContext::ApplyHardwareTransform()
 {
+  CGUITexture::FlushBatch();
   g_Windowing.ApplyHardwareTransform(m_finalTransform);
 }
 
 void CGraphicContext::RestoreHardwareTransform()
 {
+  CGUITexture::FlushBatch();
   g_Windowing.RestoreHardwareTransform();
 }
 
@@ -233,6 +233,8 @@ CJpegIO::CJpegIO()
 {
   m_width  = 0;
   m_height = 0;
+  m_originalWidth  = 0;
+  m_originalHeight = 0;
   m_orientation = 0;
   m_inputBuffSize = 0;
   m_inputBuff = NULL;
@@ -257,12 +259,23 @@ bool CJpegIO::Open(const CStdString &texturePath, unsigned int minx, unsigned in
   XFILE::CFile file;
   if (file.Open(m_texturePath.c_str(), 0))
   {
+    // check for the JPEG start of image marker before reading the rest, so
+    // other images are handed back without being read in full first
+    unsigned char magic[3];
     imgsize = (unsigned int)file.GetLength();
+    if (imgsize < sizeof(magic) || file.Read(magic, sizeof(magic)) != sizeof(magic) ||
+        magic[0] != 0xFF || magic[1] != 0xD8 || magic[2] != 0xFF)
+    {
+      file.Close();
+      return false;
+    }
+
     m_inputBuff = new unsigned char[imgsize];
-    m_inputBuffSize = file.Read(m_inputBuff, imgsize);
+    memcpy(m_inputBuff, magic, sizeof(magic));
+    m_inputBuffSize = sizeof(magic) + file.Read(m_inputBuff + sizeof(magic), imgsize - sizeof(magic));
     file.Close();
 
-    if ((imgsize != m_inputBuffSize) || (m_inputBuffSize == 0))
+    if (imgsize != m_inputBuffSize)
       return false;
   }
   else
@@ -301,6 +314,8 @@ bool CJpegIO::Read(unsigned char* buffer, unsigned int bufSize, unsigned int min
   {
     jpeg_save_markers (&m_cinfo, JPEG_APP0 + 1, 0xFFFF);
     jpeg_read_header(&m_cinfo, true);
+    m_originalWidth  = m_cinfo.image_width;
+    m_originalHeight = m_cinfo.image_height;
 
     /*  libjpeg can scale the image for us if it is too big. It must be in the format
     num/denom, where (for our purposes) that is [1-8]/8 where 8/8 is the unscaled image.
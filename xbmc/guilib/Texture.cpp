@@ -27,6 +27,8 @@
 #include "DDSImage.h"
 #include "filesystem/SpecialProtocol.h"
 #include "JpegIO.h"
+#include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #if defined(TARGET_DARWIN_IOS)
 #include <ImageIO/ImageIO.h>
 #include "filesystem/File.h"
@@ -36,6 +38,12 @@
 #include "URL.h"
 #include "filesystem/AndroidAppFile.h"
 #endif
+static CCriticalSection decodeStatsSection;
+static unsigned int decodeImages = 0;
+static unsigned int decodeTime = 0;
+static uint64_t decodeSourcePixels = 0;
+static uint64_t decodePixels = 0;
+
 /************************************************************************/
 /*                                                                      */
 /************************************************************************/
@@ -241,8 +249,12 @@ bool CBaseTexture::LoadFromFile(const CStdString& texturePath, unsigned int maxW
     return false;
   }
 
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
   //ImageLib is sooo sloow for jpegs. Try our own decoder first. If it fails, fall back to ImageLib.
-  if (URIUtils::GetExtension(texturePath).Equals(".jpg") || URIUtils::GetExtension(texturePath).Equals(".tbn"))
+  //Files without an extension are only decoded here if they start with a JPEG marker.
+  CStdString extension = URIUtils::GetExtension(texturePath);
+  if (extension.Equals(".jpg") || extension.Equals(".jpeg") || extension.Equals(".tbn") || extension.IsEmpty())
   {
     CJpegIO jpegfile;
     if (jpegfile.Open(texturePath, maxWidth, maxHeight))
@@ -254,8 +266,13 @@ bool CBaseTexture::LoadFromFile(const CStdString& texturePath, unsigned int maxW
         {
           if (autoRotate && jpegfile.Orientation())
             m_orientation = jpegfile.Orientation() - 1;
+          if (originalWidth)
+            *originalWidth = jpegfile.OriginalWidth();
+          if (originalHeight)
+            *originalHeight = jpegfile.OriginalHeight();
           m_hasAlpha=false;
           ClampToEdge();
+          AddDecodeStats(XbmcThreads::SystemClockMillis() - start, jpegfile.OriginalWidth(), jpegfile.OriginalHeight());
           return true;
         }
       }
@@ -287,6 +304,7 @@ bool CBaseTexture::LoadFromFile(const CStdString& texturePath, unsigned int maxW
   LoadFromImage(image, autoRotate);
   dll.ReleaseImage(&image);
 
+  AddDecodeStats(XbmcThreads::SystemClockMillis() - start, image.originalwidth, image.originalheight);
   return true;
 }
 
@@ -295,8 +313,10 @@ bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const s
   if (!buffer || !size)
     return false;
 
+  unsigned int start = XbmcThreads::SystemClockMillis();
+
   //ImageLib is sooo sloow for jpegs. Try our own decoder first. If it fails, fall back to ImageLib.
-  if (mimeType == "image/jpeg")
+  if (mimeType == "image/jpeg" || mimeType == "image/jpg")
   {
     CJpegIO jpegfile;
     if (jpegfile.Read(buffer, size, maxWidth, maxHeight))
@@ -308,6 +328,7 @@ bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const s
         {
           m_hasAlpha=false;
           ClampToEdge();
+          AddDecodeStats(XbmcThreads::SystemClockMillis() - start, jpegfile.OriginalWidth(), jpegfile.OriginalHeight());
           return true;
         }
       }
@@ -336,9 +357,27 @@ bool CBaseTexture::LoadFromFileInMem(unsigned char* buffer, size_t size, const s
   LoadFromImage(image);
   dll.ReleaseImage(&image);
 
+  AddDecodeStats(XbmcThreads::SystemClockMillis() - start, image.originalwidth, image.originalheight);
   return true;
 }
 
+void CBaseTexture::AddDecodeStats(unsigned int time, unsigned int sourceWidth, unsigned int sourceHeight)
+{
+  CSingleLock lock(decodeStatsSection);
+  decodeImages++;
+  decodeTime += time;
+  decodeSourcePixels += (uint64_t)std::max(sourceWidth, m_imageWidth) * std::max(sourceHeight, m_imageHeight);
+  decodePixels += (uint64_t)m_imageWidth * m_imageHeight;
+}
+
+void CBaseTexture::GetDecodeStats(unsigned int &images, unsigned int &milliseconds, float &decodedShare)
+{
+  CSingleLock lock(decodeStatsSection);
+  images = decodeImages;
+  milliseconds = decodeTime;
+  decodedShare = decodeSourcePixels ? (float)decodePixels / decodeSourcePixels : 1.0f;
+}
+
 void CBaseTexture::LoadFromImage(ImageInfo &image, bool autoRotate)
 {
   m_hasAlpha = NULL != image.alpha;
@@ -387,7 +426,7 @@ void CBaseTexture::LoadFromImage(ImageInfo &image, bool autoRotate)
   ClampToEdge();
 }
 
-bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels)
+bool CBaseTexture::LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels)
 {
   m_imageWidth = width;
   m_imageHeight = height;
@@ -75,7 +75,7 @@ public:
 
   bool LoadFromFile(const CStdString& texturePath, unsigned int maxWidth, unsigned int maxHeight,
                     bool autoRotate, unsigned int *originalWidth, unsigned int *originalHeight);
-  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, unsigned char* pixels);
+  bool LoadFromMemory(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, bool hasAlpha, const unsigned char* pixels);
   bool LoadPaletted(unsigned int width, unsigned int height, unsigned int pitch, unsigned int format, const unsigned char *pixels, const COLOR *palette);
 
   bool HasAlpha() const;
@@ -99,6 +99,13 @@ public:
   void Allocate(unsigned int width, unsigned int height, unsigned int format);
   void ClampToEdge();
 
+  /*! \brief Retrieve statistics of the images decoded from files
+   \param images [out] number of images decoded
+   \param milliseconds [out] total time spent decoding them
+   \param decodedShare [out] number of pixels decoded relative to the number of pixels in the source images
+   */
+  static void GetDecodeStats(unsigned int &images, unsigned int &milliseconds, float &decodedShare);
+
   static unsigned int PadPow2(unsigned int x);
   bool SwapBlueRed(unsigned char *pixels, unsigned int height, unsigned int pitch, unsigned int elements = 4, unsigned int offset=0);
 
@@ -106,6 +113,7 @@ protected:
   bool LoadFromFileInMem(unsigned char* buffer, size_t size, const std::string& mimeType,
                          unsigned int maxWidth, unsigned int maxHeight);
   void LoadFromImage(ImageInfo &image, bool autoRotate = false);
+  void AddDecodeStats(unsigned int time, unsigned int sourceWidth, unsigned int sourceHeight);
   // helpers for computation of texture parameters for compressed textures
   unsigned int GetPitch(unsigned int width) const;
   unsigned int GetRows(unsigned int height) const;
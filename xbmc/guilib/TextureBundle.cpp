@@ -104,6 +104,12 @@ int CTextureBundle::LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextu
   }
 }
 
+void CTextureBundle::Prefetch(const CStdString& Filename)
+{
+  if (m_useXBT)
+    m_tbXBT.Prefetch(Filename);
+}
+
 void CTextureBundle::Cleanup()
 {
   m_tbXBT.Cleanup();
@@ -45,6 +45,11 @@ public:
   int LoadAnim(const CStdString& Filename, CBaseTexture*** ppTextures,
                 int &width, int &height, int& nLoops, int** ppDelays);
 
+  /*! \brief Start reading the given texture in the background so a later load doesn't wait on the disk
+   \param Filename the texture to prefetch
+   */
+  void Prefetch(const CStdString& Filename);
+
 private:
   bool OpenBundle();
   bool ConvertFrameToTexture(const CStdString& name, CXBTFFrame& frame, CBaseTexture** ppTexture);
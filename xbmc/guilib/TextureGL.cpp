@@ -21,6 +21,7 @@
 
 #include "system.h"
 #include "TextureGL.h"
+#include "GUITexture.h"
 #include "windowing/WindowingFactory.h"
 #include "utils/log.h"
 #include "utils/GLUtils.h"
@@ -51,7 +52,10 @@ void CGLTexture::CreateTextureObject()
 void CGLTexture::DestroyTextureObject()
 {
   if (m_texture)
+  {
+    CGUITexture::FlushBatch(); // may still be in use by batched quads
     glDeleteTextures(1, (GLuint*) &m_texture);
+  }
 }
 
 void CGLTexture::LoadToGPU()
@@ -292,6 +292,23 @@ bool CGUITextureManager::HasTexture(const CStdString &textureName, CStdString *p
   return !fullPath.IsEmpty();
 }
 
+void CGUITextureManager::PreloadTextures(const std::vector<CStdString> &textures)
+{
+  CSingleLock lock(g_graphicsContext);
+  for (std::vector<CStdString>::const_iterator i = textures.begin(); i != textures.end(); ++i)
+  {
+    CStdString bundledName = CTextureBundle::Normalize(*i);
+    for (int j = 0; j < 2; j++)
+    {
+      if (m_TexBundle[j].HasFile(bundledName))
+      {
+        m_TexBundle[j].Prefetch(bundledName);
+        break;
+      }
+    }
+  }
+}
+
 int CGUITextureManager::Load(const CStdString& strTextureName, bool checkBundleOnly /*= false */)
 {
   CStdString strPath;
@@ -119,6 +119,11 @@ public:
   CStdString GetTexturePath(const CStdString& textureName, bool directory = false);
   void GetBundledTexturesFromPath(const CStdString& texturePath, std::vector<CStdString> &items);
 
+  /*! \brief Start reading bundled textures in the background ahead of them being loaded
+   \param textures names of the textures, those not in a bundle are ignored
+   */
+  void PreloadTextures(const std::vector<CStdString> &textures);
+
   void AddTexturePath(const CStdString &texturePath);    ///< Add a new path to the paths to check when loading media
   void SetTexturePath(const CStdString &texturePath);    ///< Set a single path as the path to check when loading media (clear then add)
   void RemoveTexturePath(const CStdString &texturePath); ///< Remove a path from the paths to check when loading media
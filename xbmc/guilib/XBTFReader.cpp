@@ -20,6 +20,11 @@
  */
 
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
 #include "XBTFReader.h"
 #include "utils/EndianSwap.h"
 #include "utils/CharsetConverter.h"
@@ -44,9 +49,28 @@
     return false; \
   i = Endian_SwapLE64(i);
 
+// orders positions in a list of files by the path of the file at that position
+class CXBTFPathOrder
+{
+public:
+  CXBTFPathOrder(std::vector<CXBTFFile>& files) : m_files(files) {}
+  bool operator()(size_t left, size_t right) const { return strcmp(m_files[left].GetPath(), m_files[right].GetPath()) < 0; }
+  bool operator()(size_t left, const char *right) const { return strcmp(m_files[left].GetPath(), right) < 0; }
+private:
+  std::vector<CXBTFFile>& m_files;
+};
+
 CXBTFReader::CXBTFReader()
 {
   m_file = NULL;
+  m_map = NULL;
+  m_mapSize = 0;
+  m_mapTime = 0;
+}
+
+CXBTFReader::~CXBTFReader()
+{
+  Close();
 }
 
 bool CXBTFReader::IsOpen() const
@@ -56,6 +80,8 @@ bool CXBTFReader::IsOpen() const
 
 bool CXBTFReader::Open(const CStdString& fileName)
 {
+  // reopening drops the old map, the bundle may have been rewritten since
+  Close();
   m_fileName = fileName;
 
 #ifdef _WIN32
@@ -69,6 +95,8 @@ bool CXBTFReader::Open(const CStdString& fileName)
   {
     return false;
   }
+  // the header is parsed in many small reads
+  setvbuf(m_file, NULL, _IOFBF, 65536);
 
   char magic[4];
   READ_STR(magic, 4, m_file);
@@ -88,6 +116,7 @@ bool CXBTFReader::Open(const CStdString& fileName)
 
   unsigned int nofFiles;
   READ_U32(nofFiles, m_file);
+  m_xbtf.GetFiles().reserve(nofFiles);
   for (unsigned int i = 0; i < nofFiles; i++)
   {
     CXBTFFile file;
@@ -100,6 +129,7 @@ bool CXBTFReader::Open(const CStdString& fileName)
 
     unsigned int nofFrames;
     READ_U32(nofFrames, m_file);
+    file.GetFrames().reserve(nofFrames);
 
     for (unsigned int j = 0; j < nofFrames; j++)
     {
@@ -124,8 +154,6 @@ bool CXBTFReader::Open(const CStdString& fileName)
     }
 
     m_xbtf.GetFiles().push_back(file);
-
-    m_filesMap[file.GetPath()] = file;
   }
 
   // Sanity check
@@ -136,11 +164,42 @@ bool CXBTFReader::Open(const CStdString& fileName)
     return false;
   }
 
+  std::vector<CXBTFFile>& files = m_xbtf.GetFiles();
+  m_index.resize(files.size());
+  for (size_t i = 0; i < files.size(); i++)
+    m_index[i] = i;
+  std::sort(m_index.begin(), m_index.end(), CXBTFPathOrder(files));
+
+#ifndef _WIN32
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == 0 && fileStat.st_size > 0)
+  {
+    // the map follows the file: a bundle rewritten in place changes frames under
+    // us, and one truncated turns reads past its new end into SIGBUS. A bundle
+    // replaced by a new file is safe, the map keeps the old one. See MapValid().
+    void *map = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileno(m_file), 0);
+    if (map != MAP_FAILED)
+    {
+      m_map = (unsigned char *)map;
+      m_mapSize = (size_t)fileStat.st_size;
+      m_mapTime = fileStat.st_mtime;
+    }
+  }
+#endif
+
   return true;
 }
 
 void CXBTFReader::Close()
 {
+#ifndef _WIN32
+  if (m_map)
+    munmap(m_map, m_mapSize);
+#endif
+  m_map = NULL;
+  m_mapSize = 0;
+  m_mapTime = 0;
+
   if (m_file)
   {
     fclose(m_file);
@@ -148,7 +207,7 @@ void CXBTFReader::Close()
   }
 
   m_xbtf.GetFiles().clear();
-  m_filesMap.clear();
+  m_index.clear();
 }
 
 time_t CXBTFReader::GetLastModificationTimestamp()
@@ -158,8 +217,13 @@ time_t CXBTFReader::GetLastModificationTimestamp()
     return 0;
   }
 
+  // by name, so a bundle replaced by a new file is noticed as well
   struct stat fileStat;
+#ifdef _WIN32
   if (fstat(fileno(m_file), &fileStat) == -1)
+#else
+  if (stat(m_fileName.c_str(), &fileStat) == -1)
+#endif
   {
     return 0;
   }
@@ -174,13 +238,59 @@ bool CXBTFReader::Exists(const CStdString& name)
 
 CXBTFFile* CXBTFReader::Find(const CStdString& name)
 {
-  std::map<CStdString, CXBTFFile>::iterator iter = m_filesMap.find(name);
-  if (iter == m_filesMap.end())
+  std::vector<CXBTFFile>& files = m_xbtf.GetFiles();
+  std::vector<size_t>::const_iterator iter = std::lower_bound(m_index.begin(), m_index.end(), name.c_str(), CXBTFPathOrder(files));
+  if (iter == m_index.end() || strcmp(files[*iter].GetPath(), name.c_str()) != 0)
   {
     return NULL;
   }
 
-  return &(iter->second);
+  return &files[*iter];
+}
+
+bool CXBTFReader::InRange(const CXBTFFrame& frame) const
+{
+  return frame.GetOffset() <= m_mapSize && frame.GetPackedSize() <= m_mapSize - frame.GetOffset();
+}
+
+bool CXBTFReader::MapValid() const
+{
+#ifndef _WIN32
+  // the file we mapped, not the one now at its path. This only narrows the window,
+  // a file truncated between the check and the read still faults.
+  struct stat fileStat;
+  if (fstat(fileno(m_file), &fileStat) == -1 ||
+      (size_t)fileStat.st_size != m_mapSize || fileStat.st_mtime != m_mapTime)
+  {
+    return false;
+  }
+#endif
+  return true;
+}
+
+const unsigned char* CXBTFReader::GetData(const CXBTFFrame& frame) const
+{
+  if (!m_map || !InRange(frame) || !MapValid())
+  {
+    return NULL;
+  }
+
+  return m_map + frame.GetOffset();
+}
+
+void CXBTFReader::Prefetch(const CXBTFFrame& frame) const
+{
+#ifndef _WIN32
+  if (!m_map || !InRange(frame) || !MapValid())
+  {
+    return;
+  }
+
+  // madvise wants a page aligned start
+  static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+  size_t start = (size_t)frame.GetOffset() & ~(pageSize - 1);
+  madvise(m_map + start, (size_t)(frame.GetOffset() + frame.GetPackedSize()) - start, MADV_WILLNEED);
+#endif
 }
 
 bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
@@ -189,6 +299,13 @@ bool CXBTFReader::Load(const CXBTFFrame& frame, unsigned char* buffer)
   {
     return false;
   }
+
+  const unsigned char *data = GetData(frame);
+  if (data)
+  {
+    memcpy(buffer, data, (size_t)frame.GetPackedSize());
+    return true;
+  }
 #if defined(TARGET_DARWIN) || defined(__FreeBSD__) || defined(__ANDROID__)
     if (fseeko(m_file, (off_t)frame.GetOffset(), SEEK_SET) == -1)
 #else
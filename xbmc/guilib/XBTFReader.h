@@ -23,14 +23,19 @@
 #define XBTFREADER_H_
 
 #include <vector>
-#include <map>
 #include "utils/StdString.h"
 #include "XBTF.h"
 
+/*!
+ \brief Reader for XBT texture bundles
+ Where the platform allows it the bundle is memory mapped, so frames can be used in place
+ (see GetData) and read ahead by the OS (see Prefetch). Otherwise frames are read with Load().
+ */
 class CXBTFReader
 {
 public:
   CXBTFReader();
+  ~CXBTFReader();
   bool IsOpen() const;
   bool Open(const CStdString& fileName);
   void Close();
@@ -38,13 +43,38 @@ public:
   bool Exists(const CStdString& name);
   CXBTFFile* Find(const CStdString& name);
   bool Load(const CXBTFFrame& frame, unsigned char* buffer);
+
+  /*! \brief Get the (packed) data of a frame without copying it
+   \param frame the frame to get the data of
+   \return pointer to the data of the frame, valid until the bundle is closed. NULL if the
+   bundle isn't memory mapped or the file changed since, in which case the frame has to
+   be read with Load().
+   */
+  const unsigned char* GetData(const CXBTFFrame& frame) const;
+
+  /*! \brief Hint that a frame will be loaded soon
+   Starts reading the frame from disk in the background if the bundle is memory mapped.
+   \param frame the frame to prefetch
+   */
+  void Prefetch(const CXBTFFrame& frame) const;
+
   std::vector<CXBTFFile>&  GetFiles();
 
 private:
+  // owns the file and the map, so it can't be copied
+  CXBTFReader(const CXBTFReader&);
+  CXBTFReader& operator=(const CXBTFReader&);
+
+  bool InRange(const CXBTFFrame& frame) const;
+  bool MapValid() const;
+
   CXBTF      m_xbtf;
   CStdString m_fileName;
   FILE*      m_file;
-  std::map<CStdString, CXBTFFile> m_filesMap;
+  unsigned char* m_map;     ///< the bundle mapped into memory, NULL if not mapped
+  size_t     m_mapSize;
+  time_t     m_mapTime;     ///< modification time of the file when it was mapped
+  std::vector<size_t> m_index; ///< positions in m_xbtf.GetFiles(), sorted by path
 };
 
 #endif
@@ -0,0 +1,128 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Reports how many images a second CDDSImage compresses to DXT1 and the
+ * colour error of the result, against a single squish pass over the image,
+ * with the slow and the fast colour fit.
+ *
+ * usage: benchDDS [width height] [seconds per method]
+ */
+
+#include "guilib/DDSImage.h"
+#include "lib/libsquish/squish.h"
+#include "test/TestUtils.h"
+#include "utils/CPUInfo.h"
+#include "utils/TimeUtils.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+static unsigned int g_width   = 1920;
+static unsigned int g_height  = 1080;
+static double       g_seconds = 3.0;
+
+static double Now()
+{
+  return (double)CurrentHostCounter() / (double)CurrentHostFrequency();
+}
+
+// gradients, a few soft waves and some noise, roughly the mix fanart has
+static void CreateImage(std::vector<unsigned char> &image)
+{
+  CTestRandom random;
+  image.resize(g_width * g_height * 4);
+  for (unsigned int y = 0; y < g_height; y++)
+  {
+    for (unsigned int x = 0; x < g_width; x++)
+    {
+      unsigned char *pixel = &image[(y * g_width + x) * 4];
+      pixel[0] = (unsigned char)(x * 255 / g_width + (random.Next() >> 27));
+      pixel[1] = (unsigned char)(y * 255 / g_height);
+      pixel[2] = (unsigned char)(128 + 127 * sin(x * 0.02 + y * 0.01));
+      pixel[3] = 0xff;
+    }
+  }
+}
+
+// compress the image until the time is up, returns images per second
+static double Bench(bool dds, bool fast, const std::vector<unsigned char> &image, std::vector<unsigned char> &dxt, double &colorMSE)
+{
+  int flags = squish::kDxt1 | squish::kSourceBGRA | (fast ? squish::kColourRangeFit : squish::kColourClusterFit);
+  unsigned int count = 0;
+  double       start = Now();
+  double       elapsed;
+  do
+  {
+    if (dds)
+    {
+      // the file is written nowhere, see TestStubs.cpp
+      CDDSImage img;
+      img.Create("bench.dds", g_width, g_height, g_width * 4, &image[0], 0, fast);
+      memcpy(&dxt[0], img.GetData(), std::min((size_t)img.GetSize(), dxt.size()));
+    }
+    else
+      squish::CompressImage(&image[0], g_width, g_height, g_width * 4, &dxt[0], flags);
+    count++;
+    elapsed = Now() - start;
+  } while (elapsed < g_seconds);
+
+  double alphaMSE;
+  squish::ComputeMSE(&image[0], g_width, g_height, g_width * 4, &dxt[0], flags, colorMSE, alphaMSE);
+  return count / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 2)
+  {
+    g_width  = std::max(4, atoi(argv[1]));
+    g_height = std::max(4, atoi(argv[2]));
+  }
+  if (argc > 3)
+    g_seconds = std::max(0.01, atof(argv[3]));
+
+  std::vector<unsigned char> image;
+  CreateImage(image);
+
+  unsigned int size = squish::GetStorageRequirements(g_width, g_height, squish::kDxt1);
+  std::vector<unsigned char> single(size), dds(size);
+
+  printf("%ux%u DXT1, %u CPUs\n", g_width, g_height, (unsigned int)g_cpuInfo.getCPUCount());
+  printf("%-8s %-14s %10s %11s %10s\n", "fit", "method", "images/sec", "colour MSE", "output");
+
+  const char *fits[] = { "cluster", "range" };
+  for (int i = 0; i < 2; i++)
+  {
+    double singleMSE, ddsMSE;
+    double singleRate = Bench(false, i == 1, image, single, singleMSE);
+    double ddsRate    = Bench(true, i == 1, image, dds, ddsMSE);
+    printf("%-8s %-14s %10.2f %11.2f\n", fits[i], "single pass", singleRate, singleMSE);
+    printf("%-8s %-14s %10.2f %11.2f %10s\n", fits[i], "CDDSImage", ddsRate, ddsMSE,
+           memcmp(&single[0], &dds[0], size) == 0 ? "identical" : "DIFFERS");
+  }
+
+  return 0;
+}
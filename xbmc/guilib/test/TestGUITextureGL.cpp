@@ -0,0 +1,207 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "system.h"
+
+#if defined(HAS_GL)
+#include "guilib/GUITexture.h"
+#include "guilib/Texture.h"
+
+#include <unittest++/UnitTest++.h>
+
+// GL entry points CGUITextureGL calls, counting the draws instead of drawing
+static unsigned int s_drawCalls = 0;
+static unsigned int s_vertices = 0;
+
+void glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+  s_drawCalls++;
+  s_vertices += count;
+}
+
+void glBegin(GLenum mode)
+{
+  s_drawCalls++;
+}
+
+void glEnd() {}
+void glVertex3f(GLfloat x, GLfloat y, GLfloat z) { s_vertices++; }
+void glTexCoord2f(GLfloat s, GLfloat t) {}
+void glColor4ub(GLubyte red, GLubyte green, GLubyte blue, GLubyte alpha) {}
+void glBlendFunc(GLenum sfactor, GLenum dfactor) {}
+void glEnable(GLenum cap) {}
+void glDisable(GLenum cap) {}
+void glPolygonMode(GLenum face, GLenum mode) {}
+void glTexEnvf(GLenum target, GLenum pname, GLfloat param) {}
+void glPushClientAttrib(GLbitfield mask) {}
+void glPopClientAttrib() {}
+void glEnableClientState(GLenum cap) {}
+void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr) {}
+void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr) {}
+void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr) {}
+
+#if defined(GLEW_GET_FUN)
+static void GLAPIENTRY SelectTexture(GLenum texture) {}
+PFNGLACTIVETEXTUREARBPROC __glewActiveTextureARB = SelectTexture;
+PFNGLCLIENTACTIVETEXTUREARBPROC __glewClientActiveTextureARB = SelectTexture;
+#else
+void glActiveTextureARB(GLenum texture) {}
+void glClientActiveTextureARB(GLenum texture) {}
+#endif
+
+class CTestImage : public CBaseTexture
+{
+public:
+  virtual void CreateTextureObject() {}
+  virtual void DestroyTextureObject() {}
+  virtual void LoadToGPU() {}
+  virtual void BindToUnit(unsigned int unit) {}
+
+  // pixels waiting for their upload
+  void SetPending(bool pending) { m_pixels = pending ? m_pending : NULL; }
+
+private:
+  unsigned char m_pending[4];
+};
+
+// a texture showing the given images, drawn as a single quad
+class CTestTexture : public CGUITextureGL
+{
+public:
+  CTestTexture(CBaseTexture *texture, CBaseTexture *diffuse = NULL)
+    : CGUITextureGL(0, 0, 16, 16, CTextureInfo())
+  {
+    m_texture.m_textures.push_back(texture);
+    if (diffuse)
+      m_diffuse.m_textures.push_back(diffuse);
+  }
+
+  void RenderQuad()
+  {
+    float x[4] = { 0, 16, 16, 0 };
+    float y[4] = { 0, 0, 16, 16 };
+    float z[4] = { 0, 0, 0, 0 };
+    Begin(0xffffffff);
+    Draw(x, y, z, CRect(0, 0, 1, 1), CRect(0, 0, 1, 1), 0);
+    End();
+  }
+};
+
+static void ResetCounts()
+{
+  CGUITextureGL::EndFrame();
+  s_drawCalls = 0;
+  s_vertices = 0;
+}
+
+TEST(GUITextureUnbatchedDraws)
+{
+  ResetCounts();
+  CTestImage image;
+  CTestTexture texture(&image);
+  for (int i = 0; i < 5; i++)
+    texture.RenderQuad();
+  CHECK_EQUAL(5u, s_drawCalls);
+  CHECK_EQUAL(20u, s_vertices);
+}
+
+TEST(GUITextureBatchedDraws)
+{
+  // consecutive quads of the same images share a draw, a change of images starts another
+  ResetCounts();
+  CTestImage background, icon, mask;
+  CTestTexture item(&background), thumb(&icon), masked(&icon, &mask);
+
+  CGUITextureGL::BeginBatch();
+  for (int i = 0; i < 10; i++)
+    item.RenderQuad();
+  CHECK_EQUAL(0u, s_drawCalls);
+  thumb.RenderQuad();
+  thumb.RenderQuad();
+  masked.RenderQuad();
+  item.RenderQuad();
+  CGUITextureGL::EndBatch();
+
+  CHECK_EQUAL(4u, s_drawCalls);
+  CHECK_EQUAL(14u * 4, s_vertices);
+}
+
+TEST(GUITextureNestedBatches)
+{
+  // only the outermost batch draws what is pending, a flush draws it right away
+  ResetCounts();
+  CTestImage image;
+  CTestTexture texture(&image);
+
+  CGUITextureGL::BeginBatch();
+  texture.RenderQuad();
+  CGUITextureGL::BeginBatch();
+  texture.RenderQuad();
+  CGUITextureGL::EndBatch();
+  CHECK_EQUAL(0u, s_drawCalls);
+  texture.RenderQuad();
+  CGUITextureGL::FlushBatch();
+  CHECK_EQUAL(1u, s_drawCalls);
+  texture.RenderQuad();
+  CGUITextureGL::EndBatch();
+
+  CHECK_EQUAL(2u, s_drawCalls);
+  CHECK_EQUAL(16u, s_vertices);
+}
+
+TEST(GUITexturePendingUpload)
+{
+  // an image still to be uploaded rebinds the texture units, so it can't join a batch
+  ResetCounts();
+  CTestImage image;
+  CTestTexture texture(&image);
+
+  CGUITextureGL::BeginBatch();
+  texture.RenderQuad();
+  image.SetPending(true);
+  texture.RenderQuad();
+  image.SetPending(false);
+  CGUITextureGL::EndBatch();
+
+  CHECK_EQUAL(2u, s_drawCalls);
+}
+
+TEST(GUITextureDrawStats)
+{
+  ResetCounts();
+  CTestImage image;
+  CTestTexture texture(&image);
+
+  CGUITextureGL::BeginBatch();
+  for (int i = 0; i < 3; i++)
+    texture.RenderQuad();
+  CGUITextureGL::DrawQuad(CRect(0, 0, 8, 8), 0xffffffff);
+  texture.RenderQuad();
+  CGUITextureGL::EndBatch();
+  CGUITextureGL::EndFrame();
+
+  unsigned int drawCalls, quads;
+  CGUITextureGL::GetDrawStats(drawCalls, quads);
+  CHECK_EQUAL(3u, drawCalls);
+  CHECK_EQUAL(5u, quads);
+  CHECK_EQUAL(s_drawCalls, drawCalls);
+}
+#endif
@@ -0,0 +1,131 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * The files CDDSImage writes and the textures CGUITextureGL draws, the rest
+ * comes from the common stubs in test/TestStubs.cpp
+ */
+
+#include "system.h"
+#include "filesystem/File.h"
+#include "guilib/GUITexture.h"
+#include "guilib/Texture.h"
+
+using namespace XFILE;
+
+// the benchmark never reads DDS files, and writes them nowhere
+CFile::CFile()
+{
+}
+
+CFile::~CFile()
+{
+}
+
+bool CFile::Open(const CStdString& strFileName, unsigned int flags)
+{
+  return false;
+}
+
+bool CFile::OpenForWrite(const CStdString& strFileName, bool bOverWrite)
+{
+  return true;
+}
+
+unsigned int CFile::Read(void *lpBuf, int64_t uiBufSize)
+{
+  return 0;
+}
+
+int CFile::Write(const void* lpBuf, int64_t uiBufSize)
+{
+  return (int)uiBufSize;
+}
+
+void CFile::Close()
+{
+}
+
+#if defined(HAS_GL)
+// textures with nothing loaded, the tests hand CGUITextureGL the images to draw
+CBaseTexture::CBaseTexture(unsigned int width, unsigned int height, unsigned int format)
+{
+  m_imageWidth = m_textureWidth = width;
+  m_imageHeight = m_textureHeight = height;
+  m_pixels = NULL;
+  m_loadedToGPU = false;
+  m_format = format;
+  m_orientation = 0;
+  m_hasAlpha = true;
+}
+
+CBaseTexture::~CBaseTexture()
+{
+}
+
+CTextureArray::CTextureArray()
+{
+  m_width = m_height = m_loops = 0;
+  m_orientation = 0;
+  m_texWidth = m_texHeight = 0;
+  m_texCoordsArePixels = false;
+}
+
+CTextureArray::~CTextureArray()
+{
+}
+
+unsigned int CTextureArray::size() const
+{
+  return m_textures.size();
+}
+
+CTextureInfo::CTextureInfo()
+{
+  orientation = 0;
+  useLarge = false;
+}
+
+CTextureInfo& CTextureInfo::operator=(const CTextureInfo &right)
+{
+  border = right.border;
+  orientation = right.orientation;
+  diffuse = right.diffuse;
+  filename = right.filename;
+  useLarge = right.useLarge;
+  return *this;
+}
+
+// only what CGUITextureGL reads when drawing, there is no layout nor loading
+CGUITextureBase::CGUITextureBase(float posX, float posY, float width, float height, const CTextureInfo& texture)
+{
+  m_posX = posX;
+  m_posY = posY;
+  m_width = width;
+  m_height = height;
+  m_info = texture;
+  m_currentFrame = 0;
+}
+
+CGUITextureBase::~CGUITextureBase(void)
+{
+}
+#endif
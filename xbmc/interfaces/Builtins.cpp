@@ -50,6 +50,7 @@
 #include "storage/MediaManager.h"
 #include "utils/RssReader.h"
 #include "PartyModeManager.h"
+#include "TextureCache.h"
 #include "settings/Settings.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
@@ -168,6 +169,7 @@ const BUILT_IN commands[] = {
   { "UpdateLibrary",              true,   "Update the selected library (music or video)" },
   { "CleanLibrary",               true,   "Clean the video/music library" },
   { "ExportLibrary",              true,   "Export the video/music library" },
+  { "CacheArtwork",               true,   "Cache the artwork of a source or library path in the background, CacheArtwork(stop) stops it" },
   { "PageDown",                   true,   "Send a page down event to the pagecontrol with given id" },
   { "PageUp",                     true,   "Send a page up event to the pagecontrol with given id" },
   { "LastFM.Love",                false,  "Add the current playing last.fm radio track to the last.fm loved tracks" },
@@ -1245,6 +1247,13 @@ int CBuiltins::Execute(const CStdString& execString)
         g_application.StartVideoScan(params.size() > 1 ? params[1] : "");
     }
   }
+  else if (execute.Equals("cacheartwork") && params.size())
+  {
+    if (params[0].Equals("stop"))
+      CTextureCache::Get().StopPrecaching();
+    else
+      CTextureCache::Get().PrecacheArtwork(params[0]);
+  }
   else if (execute.Equals("cleanlibrary"))
   {
     if (!params.size() || params[0].Equals("video"))
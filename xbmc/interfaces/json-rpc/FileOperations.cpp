@@ -28,6 +28,7 @@
 #include "filesystem/File.h"
 #include "FileItem.h"
 #include "settings/AdvancedSettings.h"
+#include "TextureCache.h"
 #include "Util.h"
 #include "URL.h"
 
@@ -226,6 +227,12 @@ JSONRPC_STATUS CFileOperations::Download(const CStdString &method, ITransportLay
   return transport->Download(parameterObject["path"].asString().c_str(), result) ? OK : InvalidParams;
 }
 
+JSONRPC_STATUS CFileOperations::PrecacheArtwork(const CStdString &method, ITransportLayer *transport, IClient *client, const CVariant &parameterObject, CVariant &result)
+{
+  CTextureCache::Get().PrecacheArtwork(parameterObject["directory"].asString());
+  return ACK;
+}
+
 bool CFileOperations::FillFileItem(const CFileItemPtr &originalItem, CFileItem &item, CStdString media /* = "" */)
 {
   if (originalItem.get() == NULL)
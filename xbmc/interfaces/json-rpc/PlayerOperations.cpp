@@ -35,6 +35,7 @@
 #include "video/VideoDatabase.h"
 #include "AudioLibrary.h"
 #include "GUIInfoManager.h"
+#include "filesystem/IFileTypes.h"
 
 using namespace JSONRPC;
 using namespace PLAYLIST;
@@ -1325,6 +1326,31 @@ JSONRPC_STATUS CPlayerOperations::GetPropertyValue(PlayerType player, const CStd
         break;
     }
   }
+  else if (property.Equals("cache"))
+  {
+    XFILE::SCacheStatus status = XFILE::SCacheStatus();
+    switch (player)
+    {
+      case Video:
+      case Audio:
+        if (g_application.m_pPlayer)
+          g_application.m_pPlayer->GetCacheStatus(status);
+        break;
+
+      case Picture:
+      default:
+        break;
+    }
+
+    unsigned rate = status.readrate ? status.readrate : status.maxrate;
+    result = CVariant(CVariant::VariantTypeObject);
+    result["fill"] = rate ? (double)status.forward / rate : 0.0;
+    result["sourcerate"] = (int)(status.currate / 1024);
+    result["readrate"] = (int)(status.readrate / 1024);
+    result["stalls"] = (int)status.stalls;
+    result["hits"] = (int)status.hits;
+    result["misses"] = (int)status.misses;
+  }
   else
     return InvalidParams;
 
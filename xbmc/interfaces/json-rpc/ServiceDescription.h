@@ -23,7 +23,7 @@
 namespace JSONRPC
 {
   const char* const JSONRPC_SERVICE_ID          = "http://www.xbmc.org/jsonrpc/ServiceDescription.json";
-  const int         JSONRPC_SERVICE_VERSION     = 5;
+  const int         JSONRPC_SERVICE_VERSION     = 6;
   const char* const JSONRPC_SERVICE_DESCRIPTION = "JSON-RPC API of XBMC";
 
   const char* const JSONRPC_SERVICE_TYPES[] = {  
@@ -195,13 +195,24 @@ namespace JSONRPC
         "\"language\": { \"type\": \"string\", \"required\": true }"
       "}"
     "}",
+    "\"Player.Cache\": {"
+      "\"type\": \"object\","
+      "\"properties\": {"
+        "\"fill\": { \"type\": \"number\", \"minimum\": 0.0, \"required\": true, \"description\": \"Seconds of the stream read ahead of the play position\" },"
+        "\"sourcerate\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true, \"description\": \"kB/s received from the source\" },"
+        "\"readrate\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true, \"description\": \"kB/s the stream is played at, 0 if not known yet\" },"
+        "\"stalls\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true, \"description\": \"Number of times playback had to wait for the source\" },"
+        "\"hits\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true, \"description\": \"Number of seeks served from the cache\" },"
+        "\"misses\": { \"type\": \"integer\", \"minimum\": 0, \"required\": true, \"description\": \"Number of times the source had to be repositioned\" }"
+      "}"
+    "}",
     "\"Player.Property.Name\": {"
       "\"type\": \"string\","
       "\"enum\": [ \"type\", \"partymode\", \"speed\", \"time\", \"percentage\","
                 "\"totaltime\", \"playlistid\", \"position\", \"repeat\", \"shuffled\","
                 "\"canseek\", \"canchangespeed\", \"canmove\", \"canzoom\", \"canrotate\","
                 "\"canshuffle\", \"canrepeat\", \"currentaudiostream\", \"audiostreams\","
-                "\"subtitleenabled\", \"currentsubtitle\", \"subtitles\" ]"
+                "\"subtitleenabled\", \"currentsubtitle\", \"subtitles\", \"cache\" ]"
     "}",
     "\"Player.Property.Value\": {"
       "\"type\": \"object\","
@@ -227,7 +238,8 @@ namespace JSONRPC
         "\"audiostreams\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Audio.Stream\" } },"
         "\"subtitleenabled\": { \"type\": \"boolean\" },"
         "\"currentsubtitle\": { \"$ref\": \"Player.Subtitle\" },"
-        "\"subtitles\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Subtitle\" } }"
+        "\"subtitles\": { \"type\": \"array\", \"items\": { \"$ref\": \"Player.Subtitle\" } },"
+        "\"cache\": { \"$ref\": \"Player.Cache\" }"
       "}"
     "}",
     "\"Player.Notifications.Item.Type\": {"
@@ -1445,6 +1457,16 @@ namespace JSONRPC
         "}"
       "}"
     "}",
+    "\"Files.PrecacheArtwork\": {"
+      "\"type\": \"method\","
+      "\"description\": \"Caches the artwork of the given source or library directory in the background\","
+      "\"transport\": \"Response\","
+      "\"permission\": \"UpdateData\","
+      "\"params\": ["
+        "{ \"name\": \"directory\", \"type\": \"string\", \"required\": true, \"minLength\": 1 }"
+      "],"
+      "\"returns\": \"string\""
+    "}",
     "\"AudioLibrary.GetArtists\": {"
       "\"type\": \"method\","
       "\"description\": \"Retrieve all artists\","
@@ -302,6 +302,11 @@ int CMusicDatabase::AddSong(const CSong& song, bool bCheck, int idAlbum)
     }
 
     DWORD crc = ComputeCRC(song.strFileName);
+    CStdString strCRC;
+    strCRC.Format("%ul", crc);
+
+    dbiplus::field_value nullValue;
+    nullValue.set_isNull();
 
     bool bInsert = true;
     bool bHasKaraoke = false;
@@ -311,10 +316,13 @@ int CMusicDatabase::AddSong(const CSong& song, bool bCheck, int idAlbum)
 
     if (bCheck)
     {
-      strSQL=PrepareSQL("select * from song where idAlbum=%i and dwFileNameCRC='%ul' and strTitle='%s'",
-                    idAlbum, crc, song.strTitle.c_str());
+      strSQL = "select * from song where idAlbum=? and dwFileNameCRC=? and strTitle=?";
+      dbiplus::ParamValues params;
+      params.push_back(idAlbum);
+      params.push_back(strCRC.c_str());
+      params.push_back(song.strTitle.c_str());
 
-      if (!m_pDS->query(strSQL.c_str()))
+      if (!m_pDS->query_params(strSQL, params))
         return -1;
 
       if (m_pDS->num_rows() != 0)
@@ -326,39 +334,42 @@ int CMusicDatabase::AddSong(const CSong& song, bool bCheck, int idAlbum)
     }
     if (bInsert)
     {
-      CStdString strSQL1;
-
-      CStdString strIdSong;
+      dbiplus::ParamValues params;
       if (song.idSong < 0)
-        strIdSong = "NULL";
+        params.push_back(nullValue);
       else
-        strIdSong.Format("%d", song.idSong);
+        params.push_back(song.idSong);
+      params.push_back(idAlbum);
+      params.push_back(idPath);
+      params.push_back(StringUtils::Join(song.artist, g_advancedSettings.m_musicItemSeparator).c_str());
+      params.push_back(StringUtils::Join(song.genre, g_advancedSettings.m_musicItemSeparator).c_str());
+      params.push_back(song.strTitle.c_str());
+      params.push_back(song.iTrack);
+      params.push_back(song.iDuration);
+      params.push_back(song.iYear);
+      params.push_back(strCRC.c_str());
+      params.push_back(strFileName.c_str());
+      params.push_back(song.strMusicBrainzTrackID.c_str());
+      params.push_back(song.strMusicBrainzArtistID.c_str());
+      params.push_back(song.strMusicBrainzAlbumID.c_str());
+      params.push_back(song.strMusicBrainzAlbumArtistID.c_str());
+      params.push_back(song.strMusicBrainzTRMID.c_str());
+      params.push_back(song.iTimesPlayed);
+      params.push_back(song.iStartOffset);
+      params.push_back(song.iEndOffset);
+      if (song.lastPlayed.IsValid())
+        params.push_back(song.lastPlayed.GetAsDBDateTime().c_str());
+      else
+        params.push_back(nullValue);
+      params.push_back(song.rating);
+      params.push_back(song.strComment.c_str());
 
       // we use replace because it can handle both inserting a new song
       // and replacing an existing song's record if the given idSong already exists
-      strSQL=PrepareSQL("replace into song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,dwFileNameCRC,strFileName,strMusicBrainzTrackID,strMusicBrainzArtistID,strMusicBrainzAlbumID,strMusicBrainzAlbumArtistID,strMusicBrainzTRMID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) values (%s,%i,%i,'%s','%s','%s',%i,%i,%i,'%ul','%s','%s','%s','%s','%s','%s'",
-                    strIdSong.c_str(),
-                    idAlbum, idPath, 
-                    StringUtils::Join(song.artist, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    StringUtils::Join(song.genre, g_advancedSettings.m_musicItemSeparator).c_str(),
-                    song.strTitle.c_str(),
-                    song.iTrack, song.iDuration, song.iYear,
-                    crc, strFileName.c_str(),
-                    song.strMusicBrainzTrackID.c_str(),
-                    song.strMusicBrainzArtistID.c_str(),
-                    song.strMusicBrainzAlbumID.c_str(),
-                    song.strMusicBrainzAlbumArtistID.c_str(),
-                    song.strMusicBrainzTRMID.c_str());
+      strSQL = "replace into song (idSong,idAlbum,idPath,strArtists,strGenres,strTitle,iTrack,iDuration,iYear,dwFileNameCRC,strFileName,strMusicBrainzTrackID,strMusicBrainzArtistID,strMusicBrainzAlbumID,strMusicBrainzAlbumArtistID,strMusicBrainzTRMID,iTimesPlayed,iStartOffset,iEndOffset,lastplayed,rating,comment) "
+               "values (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)";
 
-      if (song.lastPlayed.IsValid())
-        strSQL1=PrepareSQL(",%i,%i,%i,'%s','%c','%s')",
-                      song.iTimesPlayed, song.iStartOffset, song.iEndOffset, song.lastPlayed.GetAsDBDateTime().c_str(), song.rating, song.strComment.c_str());
-      else
-        strSQL1=PrepareSQL(",%i,%i,%i,NULL,'%c','%s')",
-                      song.iTimesPlayed, song.iStartOffset, song.iEndOffset, song.rating, song.strComment.c_str());
-      strSQL+=strSQL1;
-
-      m_pDS->exec(strSQL.c_str());
+      m_pDS->exec_params(strSQL, params);
 
       if (song.idSong < 0)
         idSong = (int)m_pDS->lastinsertid();
@@ -26,7 +26,11 @@
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 #include "utils/Base64.h"
+#include "utils/StringUtils.h"
+#include "utils/TimeUtils.h"
 #include "threads/SingleLock.h"
+#include "threads/Atomics.h"
+#include "settings/AdvancedSettings.h"
 #include "XBDateTime.h"
 #include "URL.h"
 
@@ -34,8 +38,14 @@
 #pragma comment(lib, "libmicrohttpd.dll.lib")
 #endif
 
+#include <algorithm>
+
 #define MAX_POST_BUFFER_SIZE 2048
 
+#ifndef MHD_SIZE_UNKNOWN
+#define MHD_SIZE_UNKNOWN ((uint64_t) -1)
+#endif
+
 #define PAGE_FILE_NOT_FOUND "<html><head><title>File not found</title></head><body>File not found</body></html>"
 #define NOT_SUPPORTED       "<html><head><title>Not Supported</title></head><body>The method you are trying to use is not supported by this server</body></html>"
 
@@ -49,6 +59,8 @@ CWebServer::CWebServer()
 {
   m_running = false;
   m_daemon = NULL;
+  m_activeFileDownloads = 0;
+  m_maxFileDownloads = 0;
   m_needcredentials = true;
   m_Credentials64Encoded = "eGJtYzp4Ym1j"; // xbmc:xbmc
 }
@@ -267,6 +279,9 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   if (handler == NULL)
     return SendErrorResponse(request.connection, MHD_HTTP_INTERNAL_SERVER_ERROR, request.method);
 
+  int64_t start = CurrentHostCounter();
+  string handlerName = handler->GetName();
+
   int ret = handler->HandleHTTPRequest(request);
   if (ret == MHD_NO)
   {
@@ -275,6 +290,7 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   }
 
   struct MHD_Response *response = NULL;
+  int responseCode = handler->GetHTTPResonseCode();
   switch (handler->GetHTTPResponseType())
   {
     case HTTPNone:
@@ -286,7 +302,24 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
       break;
 
     case HTTPFileDownload:
-      ret = CreateFileDownloadResponse(request.connection, handler->GetHTTPResponseFile(), request.method, response);
+      // don't let file downloads occupy all the available worker threads,
+      // the slot is taken here and handed to the response that streams the file
+      if (request.method != HEAD && !request.webserver->ReserveFileDownload())
+      {
+        CLog::Log(LOGDEBUG, "WebServer: rejecting download of %s, too many active file downloads", handler->GetHTTPResponseFile().c_str());
+        delete handler;
+        request.webserver->UpdateStatistics(handlerName, CurrentHostCounter() - start, true);
+
+        ret = CreateErrorResponse(request.connection, MHD_HTTP_SERVICE_UNAVAILABLE, request.method, response);
+        if (ret == MHD_NO)
+          return MHD_NO;
+        MHD_add_response_header(response, "Retry-After", "1");
+        ret = MHD_queue_response(request.connection, MHD_HTTP_SERVICE_UNAVAILABLE, response);
+        MHD_destroy_response(response);
+        return ret;
+      }
+
+      ret = CreateFileDownloadResponse(request.webserver, request.connection, handler->GetHTTPResponseFile(), request.method, response, responseCode);
       break;
 
     case HTTPMemoryDownloadNoFreeNoCopy:
@@ -324,10 +357,12 @@ int CWebServer::HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &r
   for (multimap<string, string>::const_iterator it = header.begin(); it != header.end(); it++)
     MHD_add_response_header(response, it->first.c_str(), it->second.c_str());
 
-  MHD_queue_response(request.connection, handler->GetHTTPResonseCode(), response);
+  MHD_queue_response(request.connection, responseCode, response);
   MHD_destroy_response(response);
   delete handler;
 
+  request.webserver->UpdateStatistics(handlerName, CurrentHostCounter() - start, false);
+
   return MHD_YES;
 }
 
@@ -354,53 +389,293 @@ int CWebServer::CreateRedirect(struct MHD_Connection *connection, const string &
   return MHD_NO;
 }
 
-int CWebServer::CreateFileDownloadResponse(struct MHD_Connection *connection, const string &strURL, HTTPMethod methodType, struct MHD_Response *&response)
+int CWebServer::CreateFileDownloadResponse(CWebServer *server, struct MHD_Connection *connection, const string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode)
 {
   CFile *file = new CFile();
 
-  if (file->Open(strURL, READ_NO_CACHE))
+  if (!file->Open(strURL, READ_NO_CACHE))
   {
+    delete file;
     if (methodType != HEAD)
+      AtomicDecrement(&server->m_activeFileDownloads);
+    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
+    responseCode = MHD_HTTP_NOT_FOUND;
+    return CreateErrorResponse(connection, responseCode, methodType, response);
+  }
+
+  // sources of unknown size are streamed until they end, without range support
+  int64_t fileLength = file->GetLength();
+  bool lengthKnown = fileLength >= 0;
+  uint64_t totalLength = lengthKnown ? (uint64_t)fileLength : MHD_SIZE_UNKNOWN;
+
+  CStdString ext = URIUtils::GetExtension(strURL);
+  ext = ext.ToLower();
+  const char *mime = CreateMimeTypeFromExtension(ext.c_str());
+
+  // build the validators used for conditional range requests
+  string etag, lastModified;
+  struct __stat64 statBuffer;
+  if (lengthKnown && file->Stat(&statBuffer) == 0 && statBuffer.st_mtime > 0)
+  {
+    time_t mtime = (time_t)statBuffer.st_mtime;
+    lastModified = CDateTime(mtime).GetAsRFC1123DateTime();
+
+    CStdString strEtag;
+    strEtag.Format("\"%" PRIx64 "-%" PRIx64 "\"", totalLength, (uint64_t)mtime);
+    etag = strEtag;
+  }
+
+  // the context owns the download slot reserved by HandleRequest
+  HttpFileDownloadContext *context = new HttpFileDownloadContext();
+  context->server = methodType != HEAD ? server : NULL;
+  context->file = file;
+  context->length = 0;
+
+  // check if the client only wants (a) part(s) of the file
+  HttpRanges ranges;
+  bool isRangeRequest = false;
+  string rangeHeader = GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_RANGE);
+  if (!rangeHeader.empty() && lengthKnown && totalLength > 0 &&
+      IsRangeRequestApplicable(connection, etag, lastModified))
+  {
+    if (ParseRangeHeader(rangeHeader, totalLength, ranges))
     {
-      response = MHD_create_response_from_callback ( file->GetLength(),
-                                                     2048,
-                                                     &CWebServer::ContentReaderCallback, file,
-                                                     &CWebServer::ContentReaderFreeCallback);
-      if (response == NULL)
-        return MHD_NO;
+      if (ranges.empty())
+      {
+        // none of the requested ranges overlap the file
+        ContentReaderFreeCallback(context);
+
+        responseCode = MHD_HTTP_REQUESTED_RANGE_NOT_SATISFIABLE;
+        if (CreateErrorResponse(connection, responseCode, methodType, response) == MHD_NO)
+          return MHD_NO;
+
+        CStdString contentRange;
+        contentRange.Format("bytes */%" PRIu64, totalLength);
+        MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_RANGE, contentRange.c_str());
+        return MHD_YES;
+      }
+
+      isRangeRequest = true;
     }
-    else
+  }
+
+  if (!isRangeRequest)
+  {
+    HttpBodySegment segment;
+    segment.offset = 0;
+    segment.length = totalLength;
+    segment.fileOffset = 0;
+    context->segments.push_back(segment);
+    context->length = totalLength;
+  }
+  else if (ranges.size() == 1)
+  {
+    HttpBodySegment segment;
+    segment.offset = 0;
+    segment.length = ranges[0].second - ranges[0].first + 1;
+    segment.fileOffset = ranges[0].first;
+    context->segments.push_back(segment);
+    context->length = segment.length;
+  }
+  else
+  {
+    // multiple ranges are sent as a multipart/byteranges body
+    CStdString boundary = "XBMC-" + StringUtils::CreateUUID();
+    for (HttpRanges::const_iterator range = ranges.begin(); range != ranges.end(); ++range)
     {
-      CStdString contentLength;
-      contentLength.Format("%I64d", file->GetLength());
-      file->Close();
-      delete file;
-
-      response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
-      if (response == NULL)
-        return MHD_NO;
-      MHD_add_response_header(response, "Content-Length", contentLength);
+      HttpBodySegment header;
+      header.offset = context->length;
+      header.fileOffset = 0;
+      header.data = "\r\n--" + boundary + "\r\n";
+      if (mime)
+        header.data += string("Content-Type: ") + mime + "\r\n";
+
+      CStdString contentRange;
+      contentRange.Format("Content-Range: bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64 "\r\n\r\n", range->first, range->second, totalLength);
+      header.data += contentRange;
+      header.length = header.data.size();
+      context->segments.push_back(header);
+      context->length += header.length;
+
+      HttpBodySegment data;
+      data.offset = context->length;
+      data.length = range->second - range->first + 1;
+      data.fileOffset = range->first;
+      context->segments.push_back(data);
+      context->length += data.length;
     }
 
-    CStdString ext = URIUtils::GetExtension(strURL);
-    ext = ext.ToLower();
-    const char *mime = CreateMimeTypeFromExtension(ext.c_str());
-    if (mime)
-      MHD_add_response_header(response, "Content-Type", mime);
+    HttpBodySegment footer;
+    footer.offset = context->length;
+    footer.fileOffset = 0;
+    footer.data = "\r\n--" + boundary + "--\r\n";
+    footer.length = footer.data.size();
+    context->segments.push_back(footer);
+    context->length += footer.length;
 
-    CDateTime expiryTime = CDateTime::GetCurrentDateTime();
-    expiryTime += CDateTimeSpan(1, 0, 0, 0);
-    MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+    mime = NULL;
+    ext = "multipart/byteranges; boundary=" + boundary;
+  }
+
+  if (methodType != HEAD)
+  {
+    response = MHD_create_response_from_callback ( context->length,
+                                                   2048,
+                                                   &CWebServer::ContentReaderCallback, context,
+                                                   &CWebServer::ContentReaderFreeCallback);
+    if (response == NULL)
+    {
+      ContentReaderFreeCallback(context);
+      return MHD_NO;
+    }
   }
   else
   {
-    delete file;
-    CLog::Log(LOGERROR, "WebServer: Failed to open %s", strURL.c_str());
-    return SendErrorResponse(connection, MHD_HTTP_NOT_FOUND, GET); /* GET Assumed Temporarily */
+    CStdString contentLength;
+    contentLength.Format("%" PRIu64, context->length);
+    ContentReaderFreeCallback(context);
+    context = NULL;
+
+    response = MHD_create_response_from_data (0, NULL, MHD_NO, MHD_NO);
+    if (response == NULL)
+      return MHD_NO;
+    if (lengthKnown)
+      MHD_add_response_header(response, "Content-Length", contentLength);
+  }
+
+  if (isRangeRequest)
+  {
+    responseCode = MHD_HTTP_PARTIAL_CONTENT;
+    if (ranges.size() == 1)
+    {
+      CStdString contentRange;
+      contentRange.Format("bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64, ranges[0].first, ranges[0].second, totalLength);
+      MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_RANGE, contentRange.c_str());
+    }
+    else
+      MHD_add_response_header(response, "Content-Type", ext.c_str());
   }
+
+  if (mime)
+    MHD_add_response_header(response, "Content-Type", mime);
+
+  if (lengthKnown)
+    MHD_add_response_header(response, MHD_HTTP_HEADER_ACCEPT_RANGES, "bytes");
+  if (!etag.empty())
+    MHD_add_response_header(response, MHD_HTTP_HEADER_ETAG, etag.c_str());
+  if (!lastModified.empty())
+    MHD_add_response_header(response, MHD_HTTP_HEADER_LAST_MODIFIED, lastModified.c_str());
+
+  CDateTime expiryTime = CDateTime::GetCurrentDateTime();
+  expiryTime += CDateTimeSpan(1, 0, 0, 0);
+  MHD_add_response_header(response, "Expires", expiryTime.GetAsRFC1123DateTime());
+
   return MHD_YES;
 }
 
+bool CWebServer::ParseRangeHeader(const string &rangeHeader, uint64_t totalLength, HttpRanges &ranges)
+{
+  ranges.clear();
+  if (totalLength == 0)
+    return false;
+
+  // only byte ranges are supported, anything else means the header is ignored
+  CStdString header(rangeHeader);
+  header.Trim();
+  if (header.Left(6).CompareNoCase("bytes=") != 0)
+    return false;
+
+  vector<string> specs = StringUtils::Split(header.Mid(6), ",");
+  if (specs.empty())
+    return false;
+
+  // a header without a single range spec is ignored like an invalid one,
+  // only valid specs that all miss the file make the request unsatisfiable
+  bool hasSpec = false;
+  HttpRanges parsedRanges;
+  for (vector<string>::const_iterator it = specs.begin(); it != specs.end(); ++it)
+  {
+    CStdString spec(*it);
+    spec.Trim();
+    if (spec.empty())
+      continue;
+
+    size_t dash = spec.find('-');
+    if (dash == string::npos)
+      return false;
+
+    CStdString first = spec.Left(dash);
+    CStdString last = spec.Mid(dash + 1);
+    first.Trim();
+    last.Trim();
+
+    if ((!first.empty() && !StringUtils::IsNaturalNumber(first)) ||
+        (!last.empty() && !StringUtils::IsNaturalNumber(last)))
+      return false;
+
+    uint64_t start, end;
+    if (first.empty())
+    {
+      // suffix range: the last N bytes of the file
+      if (last.empty())
+        return false;
+      hasSpec = true;
+      uint64_t suffixLength = strtoull(last.c_str(), NULL, 10);
+      if (suffixLength == 0)
+        continue;
+      start = suffixLength >= totalLength ? 0 : totalLength - suffixLength;
+      end = totalLength - 1;
+    }
+    else
+    {
+      start = strtoull(first.c_str(), NULL, 10);
+      end = last.empty() ? totalLength - 1 : strtoull(last.c_str(), NULL, 10);
+      if (end < start)
+        return false;
+      hasSpec = true;
+      // unsatisfiable range
+      if (start >= totalLength)
+        continue;
+      if (end >= totalLength)
+        end = totalLength - 1;
+    }
+
+    parsedRanges.push_back(make_pair(start, end));
+  }
+
+  if (!hasSpec)
+    return false;
+
+  // coalesce overlapping and adjacent ranges
+  sort(parsedRanges.begin(), parsedRanges.end());
+  for (HttpRanges::const_iterator it = parsedRanges.begin(); it != parsedRanges.end(); ++it)
+  {
+    if (!ranges.empty() && it->first <= ranges.back().second + 1)
+    {
+      if (it->second > ranges.back().second)
+        ranges.back().second = it->second;
+    }
+    else
+      ranges.push_back(*it);
+  }
+
+  return true;
+}
+
+bool CWebServer::IsRangeRequestApplicable(struct MHD_Connection *connection, const string &etag, const string &lastModified)
+{
+  string ifRange = GetRequestHeaderValue(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_RANGE);
+  if (ifRange.empty())
+    return true;
+
+  // If-Range contains either an entity tag or a HTTP date and
+  // the range only applies if it matches the current representation
+  if (ifRange[0] == '"' || ifRange.compare(0, 2, "W/") == 0)
+    return !etag.empty() && ifRange == etag;
+
+  return !lastModified.empty() && ifRange == lastModified;
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response)
 {
   size_t payloadSize = 0;
@@ -462,31 +737,133 @@ int CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, int ma
 int CWebServer::ContentReaderCallback(void *cls, size_t pos, char *buf, int max)
 #endif
 {
-  CFile *file = (CFile *)cls;
-  if((unsigned int)pos != file->GetPosition())
-    file->Seek(pos);
-  unsigned res = file->Read(buf, max);
-  if(res == 0)
+  HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  if (context == NULL || pos >= context->length)
+    return -1;
+
+  // find the segment of the response body containing the requested position
+  vector<HttpBodySegment>::const_iterator segment = context->segments.begin();
+  while (segment != context->segments.end() && pos >= segment->offset + segment->length)
+    ++segment;
+  if (segment == context->segments.end())
+    return -1;
+
+  uint64_t segmentPos = pos - segment->offset;
+  uint64_t size = segment->length - segmentPos;
+  if (size > (uint64_t)max)
+    size = max;
+
+  if (!segment->data.empty())
+  {
+    memcpy(buf, segment->data.c_str() + segmentPos, (size_t)size);
+    return (int)size;
+  }
+
+  CFile *file = context->file;
+  int64_t filePos = (int64_t)(segment->fileOffset + segmentPos);
+  if (filePos != file->GetPosition() && file->Seek(filePos) != filePos)
+    return -1;
+
+  unsigned int res = file->Read(buf, (int64_t)size);
+  if (res == 0)
     return -1;
   return res;
 }
 
+bool CWebServer::ReserveFileDownload()
+{
+  // checking the limit and counting the download must be a single step,
+  // or concurrent requests could all see the last free slot
+  while (true)
+  {
+    long active = m_activeFileDownloads;
+    if (m_maxFileDownloads > 0 && active >= (long)m_maxFileDownloads)
+      return false;
+    if (cas(&m_activeFileDownloads, active, active + 1) == active)
+      return true;
+  }
+}
+
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
-  CFile *file = (CFile *)cls;
-  file->Close();
+  HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  if (context == NULL)
+    return;
 
-  delete file;
+  context->file->Close();
+
+  if (context->server != NULL)
+    AtomicDecrement(&context->server->m_activeFileDownloads);
+
+  delete context->file;
+  delete context;
 }
 
-struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
+struct MHD_Daemon* CWebServer::StartMHD(int port)
 {
   // WARNING: when using MHD_USE_THREAD_PER_CONNECTION, set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
   // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
 
-  unsigned int timeout = 60 * 60 * 24;
+  unsigned int timeout = g_advancedSettings.m_webserverConnectionTimeout;
+  unsigned int poolSize = g_advancedSettings.m_webserverThreadPoolSize;
+  const CStdString &eventLoop = g_advancedSettings.m_webserverEventLoop;
+
   // MHD_USE_THREAD_PER_CONNECTION = one thread per connection
   // MHD_USE_SELECT_INTERNALLY = use main thread for each connection, can only handle one request at a time [unless you set the thread pool size]
+  // MHD_USE_POLL/MHD_USE_EPOLL_LINUX_ONLY = like MHD_USE_SELECT_INTERNALLY but without the FD_SETSIZE limit
+  unsigned int flags = MHD_USE_SELECT_INTERNALLY;
+  if (eventLoop == "threadperconnection")
+  {
+    flags = MHD_USE_THREAD_PER_CONNECTION;
+    poolSize = 0;
+  }
+#if (MHD_VERSION >= 0x00093100) && defined(TARGET_LINUX)
+  else if (eventLoop == "epoll")
+    flags |= MHD_USE_EPOLL_LINUX_ONLY;
+#endif
+#if (MHD_VERSION >= 0x00090000)
+  else if (eventLoop == "poll" || eventLoop == "epoll")
+    flags |= MHD_USE_POLL;
+#endif
+  else if (eventLoop != "select")
+    CLog::Log(LOGWARNING, "WebServer: unsupported event loop \"%s\", falling back to select", eventLoop.c_str());
+
+  // by default keep one worker free of file downloads for json-rpc and the web interface
+  if (g_advancedSettings.m_webserverMaxFileDownloads >= 0)
+    m_maxFileDownloads = g_advancedSettings.m_webserverMaxFileDownloads;
+  else
+    m_maxFileDownloads = poolSize > 1 ? poolSize - 1 : (poolSize == 1 ? 1 : 0);
+
+  CLog::Log(LOGDEBUG, "WebServer: using %s event loop with %u worker threads (connection timeout: %us, max. file downloads: %u)",
+            eventLoop.c_str(), poolSize, timeout, m_maxFileDownloads);
+
+  struct MHD_Daemon *daemon = StartMHD(port, flags, poolSize, timeout);
+  if (daemon == NULL && flags != MHD_USE_SELECT_INTERNALLY && flags != MHD_USE_THREAD_PER_CONNECTION)
+  {
+    // some libmicrohttpd releases refuse poll/epoll together with a thread pool
+    CLog::Log(LOGWARNING, "WebServer: failed to start with the %s event loop, falling back to select", eventLoop.c_str());
+    daemon = StartMHD(port, MHD_USE_SELECT_INTERNALLY, poolSize, timeout);
+  }
+
+  return daemon;
+}
+
+struct MHD_Daemon* CWebServer::StartMHD(int port, unsigned int flags, unsigned int poolSize, unsigned int timeout)
+{
+#if (MHD_VERSION >= 0x00040002)
+  if (poolSize > 0)
+    return MHD_start_daemon(flags,
+                            port,
+                            NULL,
+                            NULL,
+                            &CWebServer::AnswerToConnection,
+                            this,
+                            MHD_OPTION_THREAD_POOL_SIZE, poolSize,
+                            MHD_OPTION_CONNECTION_LIMIT, 512,
+                            MHD_OPTION_CONNECTION_TIMEOUT, timeout,
+                            MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
+                            MHD_OPTION_END);
+#endif
 
   return MHD_start_daemon(flags,
                           port,
@@ -494,9 +871,6 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           NULL,
                           &CWebServer::AnswerToConnection,
                           this,
-#if (MHD_VERSION >= 0x00040002)
-                          MHD_OPTION_THREAD_POOL_SIZE, 4,
-#endif
                           MHD_OPTION_CONNECTION_LIMIT, 512,
                           MHD_OPTION_CONNECTION_TIMEOUT, timeout,
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
@@ -508,7 +882,7 @@ bool CWebServer::Start(int port, const string &username, const string &password)
   SetCredentials(username, password);
   if (!m_running)
   {
-    m_daemon = StartMHD(MHD_USE_SELECT_INTERNALLY, port);
+    m_daemon = StartMHD(port);
 
     m_running = m_daemon != NULL;
     if (m_running)
@@ -526,12 +900,47 @@ bool CWebServer::Stop()
     MHD_stop_daemon(m_daemon);
     m_running = false;
     CLog::Log(LOGNOTICE, "WebServer: Stopped the webserver");
+    LogStatistics();
   } else 
     CLog::Log(LOGNOTICE, "WebServer: Stopped failed because its not running");
 
   return !m_running;
 }
 
+void CWebServer::UpdateStatistics(const string &handler, int64_t duration, bool rejected)
+{
+  int64_t durationUs = duration * 1000000 / CurrentHostFrequency();
+
+  CSingleLock lock(m_critSection);
+  map<string, HandlerStatistics>::iterator it = m_statistics.find(handler);
+  if (it == m_statistics.end())
+  {
+    HandlerStatistics statistics = { 0, 0, 0, 0 };
+    it = m_statistics.insert(make_pair(handler, statistics)).first;
+  }
+
+  it->second.requests++;
+  if (rejected)
+    it->second.rejected++;
+  it->second.totalTime += durationUs;
+  if (durationUs > it->second.maxTime)
+    it->second.maxTime = durationUs;
+}
+
+void CWebServer::LogStatistics()
+{
+  CSingleLock lock(m_critSection);
+  for (map<string, HandlerStatistics>::const_iterator it = m_statistics.begin(); it != m_statistics.end(); ++it)
+  {
+    const HandlerStatistics &statistics = it->second;
+    CLog::Log(LOGNOTICE, "WebServer: %s handler: %u requests (%u rejected), avg. latency %.2fms, max. latency %.2fms",
+              it->first.c_str(), statistics.requests, statistics.rejected,
+              statistics.requests > 0 ? (double)statistics.totalTime / statistics.requests / 1000.0 : 0.0,
+              (double)statistics.maxTime / 1000.0);
+  }
+  m_statistics.clear();
+}
+
 bool CWebServer::IsStarted()
 {
   return m_running;
@@ -30,10 +30,16 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <vector>
+#include <map>
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
 #include "httprequesthandler/IHTTPRequestHandler.h"
 
+namespace XFILE
+{
+  class CFile;
+}
+
 class CWebServer : public JSONRPC::ITransportLayer
 {
 public:
@@ -56,12 +62,16 @@ public:
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::map<std::string, std::string> &headerValues);
   static int GetRequestHeaderValues(struct MHD_Connection *connection, enum MHD_ValueKind kind, std::multimap<std::string, std::string> &headerValues);
 private:
-  struct MHD_Daemon* StartMHD(unsigned int flags, int port);
+  struct MHD_Daemon* StartMHD(int port);
+  struct MHD_Daemon* StartMHD(int port, unsigned int flags, unsigned int poolSize, unsigned int timeout);
   static int AskForAuthentication (struct MHD_Connection *connection);
   static bool IsAuthenticated (CWebServer *server, struct MHD_Connection *connection);
 
   static void* UriRequestLogger(void *cls, const char *uri);
 
+  void UpdateStatistics(const std::string &handler, int64_t duration, bool rejected);
+  void LogStatistics();
+
 #if (MHD_VERSION >= 0x00090200)
   static ssize_t ContentReaderCallback (void *cls, uint64_t pos, char *buf, size_t max);
 #elif (MHD_VERSION >= 0x00040001)
@@ -91,8 +101,9 @@ private:
 #endif
   static int HandleRequest(IHTTPRequestHandler *handler, const HTTPRequest &request);
   static void ContentReaderFreeCallback (void *cls);
+  bool ReserveFileDownload();
   static int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response);
-  static int CreateFileDownloadResponse(struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response);
+  static int CreateFileDownloadResponse(CWebServer *server, struct MHD_Connection *connection, const std::string &strURL, HTTPMethod methodType, struct MHD_Response *&response, int &responseCode);
   static int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response);
   static int CreateMemoryDownloadResponse(struct MHD_Connection *connection, void *data, size_t size, bool free, bool copy, struct MHD_Response *&response);
 
@@ -104,16 +115,50 @@ private:
 
   static const char *CreateMimeTypeFromExtension(const char *ext);
 
+  typedef std::vector< std::pair<uint64_t, uint64_t> > HttpRanges;
+  static bool ParseRangeHeader(const std::string &rangeHeader, uint64_t totalLength, HttpRanges &ranges);
+  static bool IsRangeRequestApplicable(struct MHD_Connection *connection, const std::string &etag, const std::string &lastModified);
+
   struct MHD_Daemon *m_daemon;
   bool m_running, m_needcredentials;
   std::string m_Credentials64Encoded;
   CCriticalSection m_critSection;
   static std::vector<IHTTPRequestHandler *> m_requestHandlers;
 
+  volatile long m_activeFileDownloads;
+  unsigned int m_maxFileDownloads;
+
+  typedef struct HandlerStatistics
+  {
+    unsigned int requests;
+    unsigned int rejected;
+    int64_t totalTime;  // in microseconds
+    int64_t maxTime;    // in microseconds
+  } HandlerStatistics;
+  std::map<std::string, HandlerStatistics> m_statistics;
+
   typedef struct ConnectionHandler
   {
     IHTTPRequestHandler *requestHandler;
     struct MHD_PostProcessor *postprocessor;
   } ConnectionHandler;
+
+  // A part of the body of a file download response which is either
+  // static data (e.g. multipart headers) or a byte range of the file
+  typedef struct HttpBodySegment
+  {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t fileOffset;
+    std::string data;
+  } HttpBodySegment;
+
+  typedef struct HttpFileDownloadContext
+  {
+    CWebServer *server;
+    XFILE::CFile *file;
+    std::vector<HttpBodySegment> segments;
+    uint64_t length;
+  } HttpFileDownloadContext;
 };
 #endif
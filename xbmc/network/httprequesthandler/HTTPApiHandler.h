@@ -28,6 +28,7 @@ public:
   CHTTPApiHandler() { };
 
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPApiHandler(); }
+  virtual std::string GetName() const { return "httpapi"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
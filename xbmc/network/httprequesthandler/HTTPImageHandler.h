@@ -30,6 +30,7 @@ public:
   CHTTPImageHandler() { };
 
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPImageHandler(); }
+  virtual std::string GetName() const { return "image"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
@@ -29,6 +29,7 @@ public:
   CHTTPJsonRpcHandler() { };
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPJsonRpcHandler(); }
+  virtual std::string GetName() const { return "jsonrpc"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
@@ -30,6 +30,7 @@ public:
   CHTTPVfsHandler() { };
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPVfsHandler(); }
+  virtual std::string GetName() const { return "vfs"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
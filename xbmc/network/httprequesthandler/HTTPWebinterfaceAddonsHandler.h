@@ -28,6 +28,7 @@ public:
   CHTTPWebinterfaceAddonsHandler() { };
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPWebinterfaceAddonsHandler(); }
+  virtual std::string GetName() const { return "addons"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
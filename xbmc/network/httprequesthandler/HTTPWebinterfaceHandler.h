@@ -29,6 +29,7 @@ public:
   CHTTPWebinterfaceHandler() { };
   
   virtual IHTTPRequestHandler* GetInstance() { return new CHTTPWebinterfaceHandler(); }
+  virtual std::string GetName() const { return "webinterface"; }
   virtual bool CheckHTTPRequest(const HTTPRequest &request);
   virtual int HandleHTTPRequest(const HTTPRequest &request);
 
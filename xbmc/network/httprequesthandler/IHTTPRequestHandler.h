@@ -69,6 +69,7 @@ public:
   virtual ~IHTTPRequestHandler() { }
 
   virtual IHTTPRequestHandler* GetInstance() = 0;
+  virtual std::string GetName() const = 0;
   virtual bool CheckHTTPRequest(const HTTPRequest &request) = 0;
   virtual int HandleHTTPRequest(const HTTPRequest &request) = 0;
   
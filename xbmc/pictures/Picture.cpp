@@ -27,10 +27,12 @@
 #include "DllImageLib.h"
 #include "utils/log.h"
 #include "utils/URIUtils.h"
-#include "DllSwScale.h"
+#include "PictureScaler.h"
 #include "guilib/JpegIO.h"
 #include "guilib/Texture.h"
 
+#include <math.h>
+
 using namespace XFILE;
 
 bool CPicture::CreateThumbnailFromSurface(const unsigned char *buffer, int width, int height, int stride, const CStdString &thumbFile)
@@ -109,8 +111,8 @@ bool CPicture::CacheTexture(uint8_t *pixels, uint32_t width, uint32_t height, ui
     uint32_t *buffer = new uint32_t[dest_width * dest_height];
     if (buffer)
     {
-      if (ScaleImage(pixels, width, height, pitch,
-                     (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
+      if (CPictureScaler::ScaleImage(pixels, width, height, pitch,
+                                     (uint8_t *)buffer, dest_width, dest_height, dest_width * 4))
       {
         if (!orientation || OrientateImage(buffer, dest_width, dest_height, orientation))
         {
@@ -157,8 +159,8 @@ bool CPicture::CreateTiledThumb(const std::vector<std::string> &files, const std
 
       // scale appropriately
       uint32_t *scaled = new uint32_t[width * height];
-      if (ScaleImage(texture.GetPixels(), texture.GetWidth(), texture.GetHeight(), texture.GetPitch(),
-                     (uint8_t *)scaled, width, height, width * 4))
+      if (CPictureScaler::ScaleImage(texture.GetPixels(), texture.GetWidth(), texture.GetHeight(), texture.GetPitch(),
+                                     (uint8_t *)scaled, width, height, width * 4))
       {
         if (!texture.GetOrientation() || OrientateImage(scaled, width, height, texture.GetOrientation()))
         {
@@ -194,29 +196,6 @@ void CPicture::GetScale(unsigned int width, unsigned int height, unsigned int &o
     out_height = (unsigned int)(out_width / aspect + 0.5f);
 }
 
-bool CPicture::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
-                          uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
-{
-  DllSwScale dllSwScale;
-  dllSwScale.Load();
-  struct SwsContext *context = dllSwScale.sws_getContext(in_width, in_height, PIX_FMT_BGRA,
-                                                         out_width, out_height, PIX_FMT_BGRA,
-                                                         SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
-
-  uint8_t *src[] = { in_pixels, 0, 0, 0 };
-  int     srcStride[] = { in_pitch, 0, 0, 0 };
-  uint8_t *dst[] = { out_pixels , 0, 0, 0 };
-  int     dstStride[] = { out_pitch, 0, 0, 0 };
-
-  if (context)
-  {
-    dllSwScale.sws_scale(context, src, srcStride, 0, in_height, dst, dstStride);
-    dllSwScale.sws_freeContext(context);
-    return true;
-  }
-  return false;
-}
-
 bool CPicture::OrientateImage(uint32_t *&pixels, unsigned int &width, unsigned int &height, int orientation)
 {
   // ideas for speeding these functions up: http://cgit.freedesktop.org/pixman/tree/pixman/pixman-fast-path.c
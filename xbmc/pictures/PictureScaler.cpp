@@ -0,0 +1,246 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "PictureScaler.h"
+#include "DllSwScale.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+#include "utils/CPUInfo.h"
+
+#include <algorithm>
+#include <list>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// scaling contexts that aren't in use, most recently used first. Thumbnails mostly come in a
+// handful of sizes, so keeping a few around saves setting up the filters for each image.
+typedef struct SScalerContext
+{
+  unsigned int in_width, in_height, out_width, out_height;
+  struct SwsContext *context;
+} SScalerContext;
+
+static const size_t max_idle_scalers = 8;
+static CCriticalSection s_scalerSection;
+static std::list<SScalerContext> s_idleScalers;
+static DllSwScale *s_dllSwScale = NULL;
+static unsigned int s_busyScalers = 0;   // contexts scaling an image right now
+static bool s_unloadDll = false;         // unload swscale once the busy contexts are back
+
+// sum the 8 bit components of a row into 16 bit totals
+static void BoxSumRow(const uint8_t *row, uint16_t *sums, unsigned int components, bool sse2)
+{
+  unsigned int i = 0;
+#ifdef __SSE2__
+  if (sse2)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= components; i += 16)
+    {
+      __m128i pixels = _mm_loadu_si128((const __m128i *)(row + i));
+      __m128i lo = _mm_loadu_si128((const __m128i *)(sums + i));
+      __m128i hi = _mm_loadu_si128((const __m128i *)(sums + i + 8));
+      _mm_storeu_si128((__m128i *)(sums + i), _mm_add_epi16(lo, _mm_unpacklo_epi8(pixels, zero)));
+      _mm_storeu_si128((__m128i *)(sums + i + 8), _mm_add_epi16(hi, _mm_unpackhi_epi8(pixels, zero)));
+    }
+  }
+#endif
+  for (; i < components; i++)
+    sums[i] += row[i];
+}
+
+// average each run of ratio pixels of the summed rows into an output pixel, both paths
+// round the same way so the results don't depend on the cpu
+static void BoxAverageRow(const uint16_t *sums, unsigned int ratio, float scale, uint8_t *out, unsigned int out_width, bool sse2)
+{
+#ifdef __SSE2__
+  if (sse2)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (unsigned int x = 0; x < out_width; x++, sums += ratio * 4)
+    {
+      __m128i total = _mm_setzero_si128();
+      for (unsigned int i = 0; i < ratio; i++)
+        total = _mm_add_epi32(total, _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)(sums + i * 4)), zero));
+      __m128i pixel = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(total), factor), half));
+      pixel = _mm_packs_epi32(pixel, pixel);
+      *(uint32_t *)(out + x * 4) = _mm_cvtsi128_si32(_mm_packus_epi16(pixel, pixel));
+    }
+    return;
+  }
+#endif
+  for (unsigned int x = 0; x < out_width; x++, sums += ratio * 4)
+  {
+    for (unsigned int c = 0; c < 4; c++)
+    {
+      unsigned int total = 0;
+      for (unsigned int i = 0; i < ratio; i++)
+        total += sums[i * 4 + c];
+      out[x * 4 + c] = (uint8_t)(total * scale + 0.5f);
+    }
+  }
+}
+
+bool CPictureScaler::ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                                uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
+{
+  // large reductions are box filtered by the integer part of the ratio first, which is quicker and
+  // looks better than leaving it all to the bilinear scaler, which skips most of the source pixels
+  unsigned int ratio_x = std::min(in_width / out_width, 256u);
+  unsigned int ratio_y = std::min(in_height / out_height, 128u);
+  if (ratio_x >= 2 && ratio_y >= 2)
+  {
+    unsigned int box_width = in_width / ratio_x;
+    unsigned int box_height = in_height / ratio_y;
+    if (box_width == out_width && box_height == out_height)
+    {
+      BoxScale(in_pixels, in_width, in_height, in_pitch, ratio_x, ratio_y, out_pixels, out_width, out_height, out_pitch);
+      return true;
+    }
+    uint8_t *box = new uint8_t[box_width * box_height * 4];
+    BoxScale(in_pixels, in_width, in_height, in_pitch, ratio_x, ratio_y, box, box_width, box_height, box_width * 4);
+    bool ret = SwScaleImage(box, box_width, box_height, box_width * 4, out_pixels, out_width, out_height, out_pitch);
+    delete[] box;
+    return ret;
+  }
+  return SwScaleImage(in_pixels, in_width, in_height, in_pitch, out_pixels, out_width, out_height, out_pitch);
+}
+
+void CPictureScaler::BoxScale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                              unsigned int ratio_x, unsigned int ratio_y,
+                              uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
+{
+  BoxScale(in_pixels, in_width, in_height, in_pitch, ratio_x, ratio_y, out_pixels, out_width, out_height, out_pitch,
+           (g_cpuInfo.GetCPUFeatures() & CPU_FEATURE_SSE2) != 0);
+}
+
+void CPictureScaler::BoxScale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                              unsigned int ratio_x, unsigned int ratio_y,
+                              uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
+                              bool sse2)
+{
+  // the rows of each block are summed up first (at most 255 * 255 fits the 16 bit totals),
+  // then each run of ratio_x totals gives an output pixel. The last column and row take
+  // in the pixels left over by the division as well, so none of the image is cut off.
+  unsigned int components = in_width * 4;
+  unsigned int last_x = in_width - (out_width - 1) * ratio_x;
+  uint16_t *sums = new uint16_t[components];
+  for (unsigned int y = 0; y < out_height; y++)
+  {
+    unsigned int rows = y + 1 < out_height ? ratio_y : in_height - y * ratio_y;
+    memset(sums, 0, components * sizeof(uint16_t));
+    const uint8_t *row = in_pixels + y * ratio_y * in_pitch;
+    for (unsigned int i = 0; i < rows; i++, row += in_pitch)
+      BoxSumRow(row, sums, components, sse2);
+
+    uint8_t *out = out_pixels + y * out_pitch;
+    BoxAverageRow(sums, ratio_x, 1.0f / (ratio_x * rows), out, out_width - 1, sse2);
+    BoxAverageRow(sums + (out_width - 1) * ratio_x * 4, last_x, 1.0f / (last_x * rows), out + (out_width - 1) * 4, 1, sse2);
+  }
+  delete[] sums;
+}
+
+bool CPictureScaler::SwScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                                  uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch)
+{
+  struct SwsContext *context = NULL;
+  DllSwScale *dll;
+  { // take an idle context of the same size, if we have one
+    CSingleLock lock(s_scalerSection);
+    if (!s_dllSwScale)
+    {
+      s_dllSwScale = new DllSwScale;
+      s_dllSwScale->Load();
+    }
+    dll = s_dllSwScale;
+    s_busyScalers++;
+    for (std::list<SScalerContext>::iterator i = s_idleScalers.begin(); i != s_idleScalers.end(); ++i)
+    {
+      if (i->in_width == in_width && i->in_height == in_height && i->out_width == out_width && i->out_height == out_height)
+      {
+        context = i->context;
+        s_idleScalers.erase(i);
+        break;
+      }
+    }
+  }
+  if (!context)
+    context = dll->sws_getContext(in_width, in_height, PIX_FMT_BGRA,
+                                  out_width, out_height, PIX_FMT_BGRA,
+                                  SWS_FAST_BILINEAR | SwScaleCPUFlags(), NULL, NULL, NULL);
+  if (context)
+  {
+    uint8_t *src[] = { in_pixels, 0, 0, 0 };
+    int     srcStride[] = { in_pitch, 0, 0, 0 };
+    uint8_t *dst[] = { out_pixels , 0, 0, 0 };
+    int     dstStride[] = { out_pitch, 0, 0, 0 };
+    dll->sws_scale(context, src, srcStride, 0, in_height, dst, dstStride);
+  }
+
+  // hand the context back for the next image
+  CSingleLock lock(s_scalerSection);
+  s_busyScalers--;
+  if (context && s_unloadDll)
+    dll->sws_freeContext(context);
+  else if (context)
+  {
+    SScalerContext scaler = { in_width, in_height, out_width, out_height, context };
+    s_idleScalers.push_front(scaler);
+    if (s_idleScalers.size() > max_idle_scalers)
+    {
+      dll->sws_freeContext(s_idleScalers.back().context);
+      s_idleScalers.pop_back();
+    }
+  }
+  if (s_unloadDll && s_busyScalers == 0)
+    UnloadDll();
+  return context != NULL;
+}
+
+void CPictureScaler::FreeScalers()
+{
+  CSingleLock lock(s_scalerSection);
+  if (!s_dllSwScale)
+    return;
+
+  for (std::list<SScalerContext>::iterator i = s_idleScalers.begin(); i != s_idleScalers.end(); ++i)
+    s_dllSwScale->sws_freeContext(i->context);
+  s_idleScalers.clear();
+
+  // images being scaled still need the library, the last of them unloads it
+  if (s_busyScalers == 0)
+    UnloadDll();
+  else
+    s_unloadDll = true;
+}
+
+void CPictureScaler::UnloadDll()
+{
+  s_dllSwScale->Unload();
+  delete s_dllSwScale;
+  s_dllSwScale = NULL;
+  s_unloadDll = false;
+}
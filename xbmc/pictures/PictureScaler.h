@@ -0,0 +1,63 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <stdint.h>
+
+/*! \brief Scaling of 32 bit images for thumbnails and cached textures
+ */
+class CPictureScaler
+{
+public:
+  /*! \brief Scale a 32 bit image, box filtering large reductions before handing the rest to swscale
+   */
+  static bool ScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                         uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
+
+  /*! \brief Scale down a 32 bit image by integer factors, averaging each ratio_x by ratio_y block of pixels
+   The last output column and row also average the pixels left over when the input size isn't a multiple of the ratio.
+   \param ratio_y vertical factor, at most 128
+   \param out_width width of the output, in_width / ratio_x
+   \param out_height height of the output, in_height / ratio_y
+   */
+  static void BoxScale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                       unsigned int ratio_x, unsigned int ratio_y,
+                       uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
+
+  /*! \brief Box filter as above, with the SSE2 code path turned on or off so the two can be checked against each other
+   */
+  static void BoxScale(const uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                       unsigned int ratio_x, unsigned int ratio_y,
+                       uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch,
+                       bool sse2);
+
+  /*! \brief Scale a 32 bit image with swscale, reusing a previous context of the same size where possible
+   */
+  static bool SwScaleImage(uint8_t *in_pixels, unsigned int in_width, unsigned int in_height, unsigned int in_pitch,
+                           uint8_t *out_pixels, unsigned int out_width, unsigned int out_height, unsigned int out_pitch);
+
+  /*! \brief Free the swscale contexts kept for reuse and unload swscale, once no image is being scaled
+   */
+  static void FreeScalers();
+
+private:
+  static void UnloadDll();
+};
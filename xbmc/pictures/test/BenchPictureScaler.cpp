@@ -0,0 +1,221 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * Reports how many images a second CPictureScaler gets through when caching
+ * a corpus of JPEGs, for the box filter followed by swscale as ScaleImage
+ * does it, for swscale alone and for the box filter alone.
+ *
+ * usage: benchScale [-h max height] [-t seconds per method] <jpegs or directories>
+ */
+
+#include "pictures/PictureScaler.h"
+#include "utils/TimeUtils.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <jpeglib.h>
+
+struct SImage
+{
+  std::string          file;
+  unsigned int         width, height;
+  unsigned int         out_width, out_height;
+  std::vector<uint8_t> pixels;
+};
+
+static unsigned int g_maxHeight = 720;
+static double       g_seconds   = 2.0;
+
+static double Now()
+{
+  return (double)CurrentHostCounter() / (double)CurrentHostFrequency();
+}
+
+// decode to 32 bit BGRA, the layout textures hand to the scaler
+static bool LoadJpeg(const std::string &file, SImage &image)
+{
+  FILE *fp = fopen(file.c_str(), "rb");
+  if (!fp)
+    return false;
+
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr);
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, fp);
+  jpeg_read_header(&cinfo, TRUE);
+  cinfo.out_color_space = JCS_RGB;
+  jpeg_start_decompress(&cinfo);
+
+  image.file   = file;
+  image.width  = cinfo.output_width;
+  image.height = cinfo.output_height;
+  image.pixels.resize(image.width * image.height * 4);
+  std::vector<uint8_t> row(image.width * 3);
+  while (cinfo.output_scanline < cinfo.output_height)
+  {
+    uint8_t *dest = &image.pixels[cinfo.output_scanline * image.width * 4];
+    JSAMPROW rows[] = { &row[0] };
+    jpeg_read_scanlines(&cinfo, rows, 1);
+    for (unsigned int x = 0; x < image.width; x++)
+    {
+      dest[x * 4 + 0] = row[x * 3 + 2];
+      dest[x * 4 + 1] = row[x * 3 + 1];
+      dest[x * 4 + 2] = row[x * 3 + 0];
+      dest[x * 4 + 3] = 0xff;
+    }
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  fclose(fp);
+
+  // fit into max height at 16:9 keeping the aspect ratio, as CPicture::CacheTexture does
+  image.out_width  = std::min(image.width, g_maxHeight * 16 / 9);
+  image.out_height = std::min(image.height, g_maxHeight);
+  float aspect = (float)image.width / image.height;
+  if ((unsigned int)(image.out_width / aspect + 0.5f) > image.out_height)
+    image.out_width = (unsigned int)(image.out_height * aspect + 0.5f);
+  else
+    image.out_height = (unsigned int)(image.out_width / aspect + 0.5f);
+  return image.out_width && image.out_height;
+}
+
+static bool IsJpeg(const std::string &file)
+{
+  size_t dot = file.rfind('.');
+  if (dot == std::string::npos)
+    return false;
+  std::string ext = file.substr(dot + 1);
+  return strcasecmp(ext.c_str(), "jpg") == 0 || strcasecmp(ext.c_str(), "jpeg") == 0;
+}
+
+static void AddPath(const std::string &path, std::vector<SImage> &images)
+{
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0)
+    return;
+
+  if (S_ISDIR(info.st_mode))
+  {
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+      return;
+    std::vector<std::string> entries;
+    while (struct dirent *entry = readdir(dir))
+    {
+      if (entry->d_name[0] != '.')
+        entries.push_back(path + "/" + entry->d_name);
+    }
+    closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0; i < entries.size(); i++)
+      AddPath(entries[i], images);
+  }
+  else if (IsJpeg(path))
+  {
+    SImage image;
+    if (LoadJpeg(path, image))
+      images.push_back(image);
+  }
+}
+
+enum EMethod { SCALE_IMAGE, SWSCALE, BOX };
+
+// scale the whole corpus until the time is up, returns images per second
+static double Bench(EMethod method, std::vector<SImage> &images, std::vector<uint8_t> &out)
+{
+  uint64_t count = 0;
+  double   start = Now();
+  double   elapsed;
+  do
+  {
+    for (size_t i = 0; i < images.size(); i++)
+    {
+      SImage &image = images[i];
+      if (method == SCALE_IMAGE)
+        CPictureScaler::ScaleImage(&image.pixels[0], image.width, image.height, image.width * 4,
+                                   &out[0], image.out_width, image.out_height, image.out_width * 4);
+      else if (method == SWSCALE)
+        CPictureScaler::SwScaleImage(&image.pixels[0], image.width, image.height, image.width * 4,
+                                     &out[0], image.out_width, image.out_height, image.out_width * 4);
+      else
+      {
+        unsigned int ratio_x = std::max(std::min(image.width / image.out_width, 256u), 1u);
+        unsigned int ratio_y = std::max(std::min(image.height / image.out_height, 128u), 1u);
+        CPictureScaler::BoxScale(&image.pixels[0], image.width, image.height, image.width * 4, ratio_x, ratio_y,
+                                 &out[0], image.width / ratio_x, image.height / ratio_y, image.width / ratio_x * 4);
+      }
+    }
+    count += images.size();
+    elapsed = Now() - start;
+  } while (elapsed < g_seconds);
+
+  return count / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+  std::vector<SImage> images;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-h") == 0 && i + 1 < argc)
+      g_maxHeight = std::max(1, atoi(argv[++i]));
+    else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+      g_seconds = std::max(0.01, atof(argv[++i]));
+    else
+      AddPath(argv[i], images);
+  }
+
+  if (images.empty())
+  {
+    fprintf(stderr, "usage: %s [-h max height] [-t seconds per method] <jpegs or directories>\n", argv[0]);
+    return 1;
+  }
+
+  size_t   largest = 0;
+  uint64_t pixels  = 0;
+  for (size_t i = 0; i < images.size(); i++)
+  {
+    largest = std::max(largest, images[i].pixels.size());
+    pixels += images[i].width * images[i].height;
+  }
+  std::vector<uint8_t> out(largest);
+
+  printf("%u images, %.1f megapixels on average, scaled to fit %ux%u\n",
+         (unsigned int)images.size(), pixels / 1e6 / images.size(), g_maxHeight * 16 / 9, g_maxHeight);
+  printf("%-16s %12s %14s\n", "method", "images/sec", "megapixels/sec");
+
+  const char *names[] = { "box + swscale", "swscale", "box" };
+  for (int method = SCALE_IMAGE; method <= BOX; method++)
+  {
+    double rate = Bench((EMethod)method, images, out);
+    printf("%-16s %12.1f %14.1f\n", names[method], rate, rate * pixels / images.size() / 1e6);
+  }
+
+  return 0;
+}
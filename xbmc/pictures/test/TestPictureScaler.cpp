@@ -0,0 +1,129 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "pictures/PictureScaler.h"
+
+#include <unittest++/UnitTest++.h>
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+// random pixels in a random size, with ratios that don't always divide it
+struct SBoxImage
+{
+  SBoxImage(unsigned int max_size, unsigned int max_ratio)
+  {
+    width   = 1 + rand() % max_size;
+    height  = 1 + rand() % max_size;
+    ratio_x = std::min(1 + (unsigned int)rand() % max_ratio, width);
+    ratio_y = std::min(1 + (unsigned int)rand() % max_ratio, height);
+    pixels.resize(width * height * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+      pixels[i] = (uint8_t)rand();
+  }
+
+  std::vector<uint8_t> Scale(bool sse2) const
+  {
+    std::vector<uint8_t> out(width / ratio_x * height / ratio_y * 4);
+    CPictureScaler::BoxScale(&pixels[0], width, height, width * 4, ratio_x, ratio_y,
+                             &out[0], width / ratio_x, height / ratio_y, width / ratio_x * 4, sse2);
+    return out;
+  }
+
+  unsigned int width, height, ratio_x, ratio_y;
+  std::vector<uint8_t> pixels;
+};
+
+TEST(BoxScaleSSE2MatchesC)
+{
+  srand(1);
+  for (int i = 0; i < 200; i++)
+  {
+    SBoxImage image(400, 40);
+    CHECK(image.Scale(true) == image.Scale(false));
+  }
+
+  // the largest ratios, where the totals are the largest
+  srand(2);
+  for (int i = 0; i < 5; i++)
+  {
+    SBoxImage image(600, 1);
+    image.ratio_x = std::min(256u, image.width);
+    image.ratio_y = std::min(128u, image.height);
+    CHECK(image.Scale(true) == image.Scale(false));
+  }
+}
+
+TEST(BoxScaleAverages)
+{
+  // every output pixel is the average of its block, the last ones including the leftovers
+  srand(3);
+  for (int i = 0; i < 50; i++)
+  {
+    SBoxImage image(200, 20);
+    std::vector<uint8_t> out = image.Scale(true);
+    unsigned int out_width = image.width / image.ratio_x;
+    unsigned int out_height = image.height / image.ratio_y;
+    unsigned int wrong = 0;
+    for (unsigned int y = 0; y < out_height; y++)
+    {
+      unsigned int y0 = y * image.ratio_y, y1 = y + 1 < out_height ? y0 + image.ratio_y : image.height;
+      for (unsigned int x = 0; x < out_width; x++)
+      {
+        unsigned int x0 = x * image.ratio_x, x1 = x + 1 < out_width ? x0 + image.ratio_x : image.width;
+        for (unsigned int c = 0; c < 4; c++)
+        {
+          double total = 0.0;
+          for (unsigned int by = y0; by < y1; by++)
+            for (unsigned int bx = x0; bx < x1; bx++)
+              total += image.pixels[(by * image.width + bx) * 4 + c];
+          if (fabs(total / ((x1 - x0) * (y1 - y0)) - out[(y * out_width + x) * 4 + c]) > 0.5001)
+            wrong++;
+        }
+      }
+    }
+    CHECK_EQUAL(0u, wrong);
+  }
+}
+
+TEST(BoxScaleKeepsEdges)
+{
+  // 10x7 by 3 gives 3x2, the last column and row average 4 and 4 pixels
+  const unsigned int width = 10, height = 7;
+  std::vector<uint8_t> pixels(width * height * 4, 0);
+  for (unsigned int y = 0; y < height; y++)
+    for (unsigned int c = 0; c < 4; c++)
+      pixels[(y * width + width - 1) * 4 + c] = 255;
+  for (unsigned int c = 0; c < 4; c++)
+    pixels[((height - 1) * width) * 4 + c] = 255;
+
+  uint8_t out[3 * 2 * 4];
+  CPictureScaler::BoxScale(&pixels[0], width, height, width * 4, 3, 3, out, 3, 2, 3 * 4);
+
+  CHECK_EQUAL(0, out[0]);
+  CHECK_EQUAL(0, out[4]);
+  CHECK_EQUAL(64, out[8]);     // 3 of 12 pixels
+  CHECK_EQUAL(21, out[12]);    // 1 of 12 pixels
+  CHECK_EQUAL(0, out[16]);
+  CHECK_EQUAL(64, out[20]);    // 4 of 16 pixels
+}
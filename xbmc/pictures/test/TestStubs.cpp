@@ -0,0 +1,47 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * The picture scaler only needs the swscale loading stubbed on top of the
+ * common stubs in test/TestStubs.cpp
+ */
+
+#include "DynamicDll.h"
+
+// swscale is linked directly, there is never a library to load
+DllDynamic::DllDynamic()
+{
+  m_dll = NULL;
+  m_DelayUnload = true;
+}
+
+DllDynamic::~DllDynamic()
+{
+}
+
+bool DllDynamic::Load()
+{
+  return true;
+}
+
+void DllDynamic::Unload()
+{
+}
@@ -182,6 +182,8 @@ void CAdvancedSettings::Initialize()
   m_fanartRes = 1080;
   m_imageRes = 720;
   m_useDDSFanart = false;
+  m_textureCacheMaxSize = 0;
+  m_textureCacheMaxFiles = 0;
 
   m_sambaclienttimeout = 10;
   m_sambadoscodepage = "";
@@ -242,6 +244,11 @@ void CAdvancedSettings::Initialize()
   m_curlconnecttimeout = 10;
   m_curllowspeedtime = 20;
   m_curlretries = 2;
+  m_curlconnections = 1;         // > 1 fetches seekable http files over several ranged connections
+  m_curlchunksize = 1048576;
+  m_curlbuffersize = 8388608;    // ranges held in memory per file, across all connections
+  m_curlidlesessions = 4;        // idle sessions kept open per host, busy ones are not limited
+  m_curlidletime = 30;
   m_curlDisableIPV6 = false;      //Certain hardware/OS combinations have trouble
                                   //with ipv6.
 
@@ -282,16 +289,26 @@ void CAdvancedSettings::Initialize()
   m_measureRefreshrate = false;
 
   m_cacheMemBufferSize = 1024 * 1024 * 20;
+  m_cacheDiskBufferSize = 0;
+  m_cacheReadAheadTime = 20;
 
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverEventLoop = "select";
+  m_webserverThreadPoolSize = 4;
+  m_webserverConnectionTimeout = 60 * 60 * 24;
+  m_webserverMaxFileDownloads = -1;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 0;
   m_guiDirtyRegionNoFlipTimeout = -1;
+  m_guiTextureUploadBytes = 8 * 1024 * 1024;
+  m_guiTextureUploadTime = 5;
+  m_logAsync = false;
   m_logEnableAirtunes = false;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
@@ -311,6 +328,9 @@ bool CAdvancedSettings::Load()
   for (unsigned int i = 0; i < m_settingsFiles.size(); i++)
     ParseSettingsFile(m_settingsFiles[i]);
   ParseSettingsFile(g_settings.GetUserDataItem("advancedsettings.xml"));
+
+  // also when no file sets it, a profile switch may have to go back to synchronous logging
+  CLog::SetAsync(m_logAsync);
   return true;
 }
 
@@ -660,8 +680,15 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetInt(pElement, "curlclienttimeout", m_curlconnecttimeout, 1, 1000);
     XMLUtils::GetInt(pElement, "curllowspeedtime", m_curllowspeedtime, 1, 1000);
     XMLUtils::GetInt(pElement, "curlretries", m_curlretries, 0, 10);
+    XMLUtils::GetInt(pElement, "curlconnections", m_curlconnections, 1, 16);
+    XMLUtils::GetInt(pElement, "curlchunksize", m_curlchunksize, 65536, 16777216);
+    XMLUtils::GetInt(pElement, "curlbuffersize", m_curlbuffersize, 1048576, 268435456);
+    XMLUtils::GetInt(pElement, "curlidlesessions", m_curlidlesessions, 1, 32);
+    XMLUtils::GetInt(pElement, "curlidletime", m_curlidletime, 1, 3600);
     XMLUtils::GetBoolean(pElement,"disableipv6", m_curlDisableIPV6);
     XMLUtils::GetUInt(pElement, "cachemembuffersize", m_cacheMemBufferSize);
+    XMLUtils::GetUInt(pElement, "cachediskbuffersize", m_cacheDiskBufferSize);
+    XMLUtils::GetUInt(pElement, "cachereadaheadtime", m_cacheReadAheadTime);
   }
 
   pElement = pRootElement->FirstChildElement("jsonrpc");
@@ -671,6 +698,18 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+  {
+    XMLUtils::GetString(pElement, "eventloop", m_webserverEventLoop);
+    m_webserverEventLoop.ToLower();
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webserverThreadPoolSize);
+    if (m_webserverThreadPoolSize < 1)
+      m_webserverThreadPoolSize = 1;
+    XMLUtils::GetUInt(pElement, "connectiontimeout", m_webserverConnectionTimeout);
+    XMLUtils::GetInt(pElement, "maxfiledownloads", m_webserverMaxFileDownloads, -1, 1000);
+  }
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -705,6 +744,9 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     CLog::SetLogLevel(g_advancedSettings.m_logLevel);
   }
 
+  // write the log from a background thread so logging threads don't wait on the disk, applied by Load()
+  XMLUtils::GetBoolean(pRootElement, "asynclogging", m_logAsync);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
 
   //airtunes + airplay
@@ -879,6 +921,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
   XMLUtils::GetInt(pRootElement, "fanartres", m_fanartRes, 0, 1080);
   XMLUtils::GetInt(pRootElement, "imageres", m_imageRes, 0, 1080);
   XMLUtils::GetBoolean(pRootElement, "useddsfanart", m_useDDSFanart);
+  XMLUtils::GetInt(pRootElement, "texturecachesize", m_textureCacheMaxSize, 0, INT_MAX);
+  XMLUtils::GetInt(pRootElement, "texturecachefiles", m_textureCacheMaxFiles, 0, INT_MAX);
 
   XMLUtils::GetBoolean(pRootElement, "playlistasfolders", m_playlistAsFolders);
   XMLUtils::GetBoolean(pRootElement, "detectasudf", m_detectAsUdf);
@@ -973,6 +1017,8 @@ void CAdvancedSettings::ParseSettingsFile(const CStdString &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetInt(pElement, "nofliptimeout",             m_guiDirtyRegionNoFlipTimeout);
+    XMLUtils::GetUInt(pElement, "textureuploadbytes",       m_guiTextureUploadBytes);
+    XMLUtils::GetUInt(pElement, "textureuploadtime",        m_guiTextureUploadTime);
   }
 
   // load in the GUISettings overrides:
@@ -178,6 +178,7 @@ class CAdvancedSettings
     int m_songInfoDuration;
     int m_logLevel;
     int m_logLevelHint;
+    bool m_logAsync;
     CStdString m_cddbAddress;
 
     //airtunes + airplay
@@ -217,6 +218,8 @@ class CAdvancedSettings
      */
     unsigned int GetThumbSize() const { return m_imageRes / 2; };
     bool m_useDDSFanart;
+    int m_textureCacheMaxSize;  ///< \brief the maximal size of the texture cache in MB, 0 for no limit
+    int m_textureCacheMaxFiles; ///< \brief the maximal number of images in the texture cache, 0 for no limit
 
     int m_sambaclienttimeout;
     CStdString m_sambadoscodepage;
@@ -283,6 +286,11 @@ class CAdvancedSettings
     int m_curlconnecttimeout;
     int m_curllowspeedtime;
     int m_curlretries;
+    int m_curlconnections;
+    int m_curlchunksize;
+    int m_curlbuffersize;
+    int m_curlidlesessions;
+    int m_curlidletime;
     bool m_curlDisableIPV6;
 
     bool m_fullScreen;
@@ -327,12 +335,21 @@ class CAdvancedSettings
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     int  m_guiDirtyRegionNoFlipTimeout;
+    unsigned int m_guiTextureUploadBytes; // bytes of large textures to upload to the GPU per frame
+    unsigned int m_guiTextureUploadTime;  // ms to spend uploading large textures per frame
 
     unsigned int m_cacheMemBufferSize;
+    unsigned int m_cacheDiskBufferSize; // spill the memory cache to disk, keeping several ranges of a stream
+    unsigned int m_cacheReadAheadTime;  // seconds of a stream to read ahead, 0 to read as much as the cache holds
 
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    CStdString m_webserverEventLoop; ///< \brief connection handling of the webserver (select, poll, epoll or threadperconnection)
+    unsigned int m_webserverThreadPoolSize; ///< \brief number of worker threads of the webserver (select, poll and epoll)
+    unsigned int m_webserverConnectionTimeout; ///< \brief idle timeout (in seconds) of webserver connections
+    int m_webserverMaxFileDownloads; ///< \brief maximum number of concurrent file downloads (0 = unlimited, -1 = one less than the worker threads)
+
     bool m_enableMultimediaKeys;
     std::vector<CStdString> m_settingsFiles;
     void ParseSettingsFile(const CStdString &file);
@@ -0,0 +1,75 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+/*
+ * The parts of xbmc nearly everything under test calls into: logging, the
+ * clock, the CPU and sleeping. The test directories link these through
+ * testUtils.a and only stub what is particular to the code they test.
+ */
+
+#include "linux/XTimeUtils.h"
+#include "utils/log.h"
+#include "utils/CPUInfo.h"
+#include "utils/TimeUtils.h"
+
+#include <algorithm>
+#include <time.h>
+#include <unistd.h>
+
+void CLog::Log(int loglevel, const char *format, ... )
+{
+}
+
+int64_t CurrentHostCounter(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((int64_t)now.tv_sec * 1000000000L) + now.tv_nsec;
+}
+
+int64_t CurrentHostFrequency(void)
+{
+  return (int64_t)1000000000L;
+}
+
+// the real CPU count, and SSE2 whenever the compiler may use it
+CCPUInfo::CCPUInfo(void)
+{
+  m_fProcStat        = NULL;
+  m_fProcTemperature = NULL;
+  m_fCPUInfo         = NULL;
+  m_cpuCount         = std::max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+  m_cpuFeatures      = 0;
+#if defined(__SSE2__)
+  m_cpuFeatures |= CPU_FEATURE_SSE2;
+#endif
+}
+
+CCPUInfo::~CCPUInfo()
+{
+}
+
+CCPUInfo g_cpuInfo;
+
+void WINAPI Sleep(DWORD dwMilliSeconds)
+{
+  usleep(dwMilliSeconds * 1000);
+}
@@ -0,0 +1,52 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// deterministic pseudo random numbers, so failures can be reproduced
+class CTestRandom
+{
+public:
+  CTestRandom(uint32_t seed = 1) : m_state(seed) {}
+
+  uint32_t Next()
+  {
+    m_state = m_state * 1664525u + 1013904223u;
+    return m_state;
+  }
+
+  // uniform in [min, max]
+  uint32_t NextRange(uint32_t min, uint32_t max)
+  {
+    return min + (Next() >> 8) % (max - min + 1);
+  }
+
+  // uniform in [min, max]
+  float NextFloat(float min, float max)
+  {
+    return min + (max - min) * (float)(Next() >> 8) / (float)0xFFFFFF;
+  }
+
+private:
+  uint32_t m_state;
+};
@@ -0,0 +1,133 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "Atomics.h"
+
+/**
+ * Bounded lock-free ring buffer for a single producer.
+ *
+ * Only one thread may call Push(). Items can be taken from the ring by any
+ * thread: Front() returns a copy of the oldest item together with its
+ * position and Remove() removes it, failing if another thread removed it first.
+ * This lets a consumer inspect an item before taking it while still allowing
+ * another thread to drain the ring (e.g. on a flush).
+ *
+ * T must be copyable without side effects as copies of items may be taken
+ * and thrown away again.
+ */
+template<class T> class CLockFreeRing
+{
+public:
+  explicit CLockFreeRing(unsigned int size) : m_read(0), m_write(0)
+  {
+    m_size = 1;
+    while (m_size < size)
+      m_size <<= 1;
+    m_items = new T[m_size];
+  }
+
+  ~CLockFreeRing()
+  {
+    delete[] m_items;
+  }
+
+  /**
+   * Append an item. Must only be called from the producing thread.
+   * Returns false if the ring is full.
+   */
+  bool Push(const T& item)
+  {
+    long write = m_write;
+    if ((unsigned long)(write - Load(m_read)) >= m_size)
+      return false;
+
+    m_items[write & (m_size - 1)] = item;
+    AtomicIncrement(&m_write); // publishes the item
+    return true;
+  }
+
+  /**
+   * Get a copy of the oldest item and its position without removing it.
+   * Returns false if the ring is empty.
+   */
+  bool Front(T& item, long& position) const
+  {
+    position = Load(m_read);
+    if (position == Load(m_write))
+      return false;
+
+    item = m_items[position & (m_size - 1)];
+    return true;
+  }
+
+  /**
+   * Remove the item at the given position as returned by Front().
+   * Returns false if it has already been removed by another thread,
+   * in which case the copy returned by Front() must be discarded.
+   */
+  bool Remove(long position)
+  {
+    return cas(&m_read, position, position + 1) == position;
+  }
+
+  /**
+   * Remove the oldest item. Returns false if the ring is empty.
+   */
+  bool Pop(T& item)
+  {
+    long position;
+    while (Front(item, position))
+    {
+      if (Remove(position))
+        return true;
+    }
+    return false;
+  }
+
+  bool IsEmpty() const           { return Load(m_read) == Load(m_write); }
+  unsigned int GetCount() const  { return (unsigned int)(Load(m_write) - Load(m_read)); }
+  unsigned int GetSize() const   { return m_size; }
+
+private:
+  CLockFreeRing(const CLockFreeRing&);
+  CLockFreeRing& operator=(const CLockFreeRing&);
+
+  // read an index followed by a memory barrier so the item stored before the
+  // index was published is visible as well. Volatile reads already have
+  // acquire semantics with MSVC.
+  static long Load(const volatile long& value)
+  {
+    long result = value;
+#if defined(__GNUC__)
+    __sync_synchronize();
+#endif
+    return result;
+  }
+
+  T* m_items;
+  unsigned long m_size;
+  // keep the indices on separate cache lines, each is mostly written by one side
+  char m_pad1[64];
+  volatile long m_read;
+  char m_pad2[64];
+  volatile long m_write;
+};
@@ -0,0 +1,154 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "threads/LockFreeRing.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
+
+#include "threads/test/TestHelpers.h"
+
+#define TESTNUM 50000l
+
+//=============================================================================
+// Helper classes
+//=============================================================================
+
+// pushes 1..count, retrying while the ring is full
+class producer
+{
+  CLockFreeRing<long>& ring;
+  long count;
+public:
+  producer(CLockFreeRing<long>& r, long c) : ring(r), count(c) {}
+
+  void operator()()
+  {
+    for (long i = 1; i <= count; i++)
+    {
+      while (!ring.Push(i))
+        XbmcThreads::ThreadSleep(0);
+    }
+  }
+};
+
+// pops until the last value has been seen, counting what it got
+class consumer
+{
+  CLockFreeRing<long>& ring;
+  volatile bool& done;
+public:
+  long& sum;
+  long& received;
+  bool& ordered;
+
+  consumer(CLockFreeRing<long>& r, volatile bool& d, long& s, long& n, bool& o) :
+    ring(r), done(d), sum(s), received(n), ordered(o) {}
+
+  void operator()()
+  {
+    long last = 0;
+    long value;
+    while (!done || !ring.IsEmpty())
+    {
+      if (!ring.Pop(value))
+        continue;
+      if (value <= last)
+        ordered = false;
+      last = value;
+      sum += value;
+      received++;
+    }
+  }
+};
+
+//=============================================================================
+
+TEST(TestLockFreeRingSize)
+{
+  CLockFreeRing<long> ring(3);
+  CHECK_EQUAL(4u, ring.GetSize());
+
+  for (long i = 0; i < 4; i++)
+    CHECK(ring.Push(i));
+  CHECK(!ring.Push(4));
+  CHECK_EQUAL(4u, ring.GetCount());
+
+  long value, position;
+  CHECK(ring.Front(value, position));
+  CHECK_EQUAL(0l, value);
+  CHECK(ring.Remove(position));
+  CHECK(!ring.Remove(position)); // already taken
+
+  for (long i = 1; i < 4; i++)
+  {
+    CHECK(ring.Pop(value));
+    CHECK_EQUAL(i, value);
+  }
+  CHECK(ring.IsEmpty());
+  CHECK(!ring.Pop(value));
+}
+
+TEST(TestLockFreeRingProducerConsumer)
+{
+  CLockFreeRing<long> ring(64);
+  volatile bool done = false;
+  long sum = 0, received = 0;
+  bool ordered = true;
+
+  consumer c(ring, done, sum, received, ordered);
+  thread consumerThread(c);
+  producer p(ring, TESTNUM);
+  thread producerThread(p);
+
+  producerThread.join();
+  done = true;
+  consumerThread.join();
+
+  CHECK_EQUAL(TESTNUM, received);
+  CHECK_EQUAL(TESTNUM * (TESTNUM + 1) / 2, sum);
+  CHECK(ordered);
+}
+
+TEST(TestLockFreeRingConcurrentPop)
+{
+  CLockFreeRing<long> ring(64);
+  volatile bool done = false;
+  long sum1 = 0, sum2 = 0, received1 = 0, received2 = 0;
+  bool ordered1 = true, ordered2 = true;
+
+  consumer c1(ring, done, sum1, received1, ordered1);
+  consumer c2(ring, done, sum2, received2, ordered2);
+  thread consumerThread1(c1);
+  thread consumerThread2(c2);
+  producer p(ring, TESTNUM);
+  thread producerThread(p);
+
+  producerThread.join();
+  done = true;
+  consumerThread1.join();
+  consumerThread2.join();
+
+  // every item is taken exactly once and each consumer still sees them in order
+  CHECK_EQUAL(TESTNUM, received1 + received2);
+  CHECK_EQUAL(TESTNUM * (TESTNUM + 1) / 2, sum1 + sum2);
+  CHECK(ordered1);
+  CHECK(ordered2);
+}
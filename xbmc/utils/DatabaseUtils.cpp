@@ -147,7 +147,13 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldTime) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_RUNTIME);
     else if (field == FieldDirector) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_DIRECTOR);
     else if (field == FieldStudio) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_STUDIOS);
-    else if (field == FieldYear) result.Format("musicvideoview.c%02d",VIDEODB_ID_MUSICVIDEO_YEAR);
+    else if (field == FieldYear)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(musicvideoview.c%02d as DECIMAL(4,0))", VIDEODB_ID_MUSICVIDEO_YEAR);
+      else
+        result.Format("musicvideoview.c%02d",VIDEODB_ID_MUSICVIDEO_YEAR);
+    }
     else if (field == FieldPlot) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_PLOT);
     else if (field == FieldAlbum) result.Format("musicvideoview.c%02d",VIDEODB_ID_MUSICVIDEO_ALBUM);
     else if (field == FieldArtist) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_ARTIST);
@@ -155,7 +161,12 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldTrackNumber) result.Format("musicvideoview.c%02d", VIDEODB_ID_MUSICVIDEO_TRACK);
     else if (field == FieldFilename) return "musicvideoview.strFilename";
     else if (field == FieldPath) return "musicvideoview.strPath";
-    else if (field == FieldPlaycount) return "musicvideoview.playCount";
+    else if (field == FieldPlaycount)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        return "IFNULL(musicvideoview.playCount, 0)";
+      return "musicvideoview.playCount";
+    }
     else if (field == FieldLastPlayed) return "musicvideoview.lastPlayed";
     else if (field == FieldDateAdded) return "musicvideoview.dateAdded";
 
@@ -186,11 +197,23 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
         result.Format("movieview.c%02d", VIDEODB_ID_RATING);
     }
     else if (field == FieldWriter) result.Format("movieview.c%02d", VIDEODB_ID_CREDITS);
-    else if (field == FieldYear) result.Format("movieview.c%02d", VIDEODB_ID_YEAR);
+    else if (field == FieldYear)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(movieview.c%02d as DECIMAL(4,0))", VIDEODB_ID_YEAR);
+      else
+        result.Format("movieview.c%02d", VIDEODB_ID_YEAR);
+    }
     else if (field == FieldSortTitle) result.Format("movieview.c%02d", VIDEODB_ID_SORTTITLE);
     else if (field == FieldTime) result.Format("movieview.c%02d", VIDEODB_ID_RUNTIME);
     else if (field == FieldMPAA) result.Format("movieview.c%02d", VIDEODB_ID_MPAA);
-    else if (field == FieldTop250) result.Format("movieview.c%02d", VIDEODB_ID_TOP250);
+    else if (field == FieldTop250)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(movieview.c%02d as DECIMAL(4,0))", VIDEODB_ID_TOP250);
+      else
+        result.Format("movieview.c%02d", VIDEODB_ID_TOP250);
+    }
     else if (field == FieldSet) return "movieview.strSet";
     else if (field == FieldGenre) result.Format("movieview.c%02d", VIDEODB_ID_GENRE);
     else if (field == FieldDirector) result.Format("movieview.c%02d", VIDEODB_ID_DIRECTOR);
@@ -199,7 +222,12 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldCountry) result.Format("movieview.c%02d", VIDEODB_ID_COUNTRY);
     else if (field == FieldFilename) return "movieview.strFilename";
     else if (field == FieldPath) return "movieview.strPath";
-    else if (field == FieldPlaycount) return "movieview.playCount";
+    else if (field == FieldPlaycount)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        return "IFNULL(movieview.playCount, 0)";
+      return "movieview.playCount";
+    }
     else if (field == FieldLastPlayed) return "movieview.lastPlayed";
     else if (field == FieldDateAdded) return "movieview.dateAdded";
 
@@ -221,8 +249,21 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldPlot) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_PLOT);
     else if (field == FieldTvShowStatus) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_STATUS);
     else if (field == FieldVotes) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_VOTES);
-    else if (field == FieldRating) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_RATING);
-    else if (field == FieldYear) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_PREMIERED);
+    else if (field == FieldRating)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(tvshowview.c%02d as DECIMAL(5,3))", VIDEODB_ID_TV_RATING);
+      else
+        result.Format("tvshowview.c%02d", VIDEODB_ID_TV_RATING);
+    }
+    else if (field == FieldYear)
+    {
+      // only the year part of the premiere date is relevant for sorting
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(tvshowview.c%02d as DECIMAL(4,0))", VIDEODB_ID_TV_PREMIERED);
+      else
+        result.Format("tvshowview.c%02d", VIDEODB_ID_TV_PREMIERED);
+    }
     else if (field == FieldGenre) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_GENRE);
     else if (field == FieldMPAA) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_MPAA);
     else if (field == FieldStudio) result.Format("tvshowview.c%02d", VIDEODB_ID_TV_STUDIOS);
@@ -243,7 +284,13 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldTitle) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_TITLE);
     else if (field == FieldPlot) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_PLOT);
     else if (field == FieldVotes) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_VOTES);
-    else if (field == FieldRating) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_RATING);
+    else if (field == FieldRating)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        result.Format("CAST(episodeview.c%02d as DECIMAL(5,3))", VIDEODB_ID_EPISODE_RATING);
+      else
+        result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_RATING);
+    }
     else if (field == FieldWriter) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_CREDITS);
     else if (field == FieldAirDate) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_AIRED);
     else if (field == FieldTime) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_RUNTIME);
@@ -254,7 +301,12 @@ std::string DatabaseUtils::GetField(Field field, MediaType mediaType, DatabaseQu
     else if (field == FieldSeasonSpecialSort) result.Format("episodeview.c%02d", VIDEODB_ID_EPISODE_SORTSEASON);
     else if (field == FieldFilename) return "episodeview.strFilename";
     else if (field == FieldPath) return "episodeview.strPath";
-    else if (field == FieldPlaycount) return "episodeview.playCount";
+    else if (field == FieldPlaycount)
+    {
+      if (queryPart == DatabaseQueryPartOrderBy)
+        return "IFNULL(episodeview.playCount, 0)";
+      return "episodeview.playCount";
+    }
     else if (field == FieldLastPlayed) return "episodeview.lastPlayed";
     else if (field == FieldDateAdded) return "episodeview.dateAdded";
     else if (field == FieldTvShowTitle) return "episodeview.strTitle";
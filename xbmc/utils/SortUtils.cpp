@@ -692,6 +692,78 @@ bool SortUtils::SortFromDataset(const SortDescription &sortDescription, MediaTyp
   return true;
 }
 
+bool SortUtils::GetDatabaseOrderBy(const SortDescription &sortDescription, MediaType mediaType, std::string &orderBy)
+{
+  orderBy.clear();
+
+  // only sort methods whose sort string is a plain value followed by the label
+  // (or the id) can be expressed in SQL. Everything else relies on natural
+  // string comparison or article stripping and has to be sorted in memory
+  Field field = FieldNone;
+  bool labelTiebreaker = true;
+  switch (sortDescription.sortBy)
+  {
+  case SortByDateAdded:
+    field = FieldDateAdded;
+    labelTiebreaker = false;
+    break;
+
+  case SortByYear:
+    field = FieldYear;
+    break;
+
+  case SortByRating:
+    field = FieldRating;
+    break;
+
+  case SortByTop250:
+    field = FieldTop250;
+    break;
+
+  case SortByPlaycount:
+    field = FieldPlaycount;
+    break;
+
+  case SortByLastPlayed:
+    field = FieldLastPlayed;
+    break;
+
+  default:
+    return false;
+  }
+
+  // episode labels start with their season and episode number, and the
+  // year of an episode is its airdate
+  if (labelTiebreaker && mediaType == MediaTypeEpisode)
+    return false;
+
+  if (labelTiebreaker && (sortDescription.sortAttributes & SortAttributeIgnoreArticle))
+    return false;
+
+  vector<string> order;
+  order.push_back(DatabaseUtils::GetField(field, mediaType, DatabaseQueryPartOrderBy));
+  if (labelTiebreaker)
+    order.push_back(DatabaseUtils::GetField(FieldTitle, mediaType, DatabaseQueryPartSelect));
+  // items with the same label keep a fixed order, so pages neither overlap nor skip items
+  order.push_back(DatabaseUtils::GetField(FieldId, mediaType, DatabaseQueryPartSelect));
+
+  const char *direction = sortDescription.sortOrder == SortOrderDescending ? " DESC" : " ASC";
+  for (vector<string>::const_iterator it = order.begin(); it != order.end(); it++)
+  {
+    if (it->empty())
+    {
+      orderBy.clear();
+      return false;
+    }
+
+    if (!orderBy.empty())
+      orderBy += ", ";
+    orderBy += *it + direction;
+  }
+
+  return true;
+}
+
 const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
 {
   map<SortBy, SortPreparator>::const_iterator it = m_preparators.find(sortBy);
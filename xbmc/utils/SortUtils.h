@@ -111,6 +111,15 @@ public:
   static void Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attributes, SortItems& items, int limitEnd = -1, int limitStart = 0);
   static void Sort(const SortDescription &sortDescription, SortItems& items);
   static bool SortFromDataset(const SortDescription &sortDescription, MediaType mediaType, const std::auto_ptr<dbiplus::Dataset> &dataset, DatabaseResults &results);
+
+  /*!
+   \brief Get an ORDER BY clause sorting a database view like the given sort description
+   \param sortDescription description of the sorting to express in SQL
+   \param mediaType media type of the view being sorted
+   \param orderBy the ORDER BY expression (without the keyword)
+   \return true if the database can do the sorting, false if it has to be done in memory
+   */
+  static bool GetDatabaseOrderBy(const SortDescription &sortDescription, MediaType mediaType, std::string &orderBy);
   
   static const Fields& GetFieldsForSorting(SortBy sortBy);
   static std::string RemoveArticles(const std::string &label);
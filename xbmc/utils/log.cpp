@@ -23,7 +23,10 @@
 #include "log.h"
 #include "stdio_utf8.h"
 #include "stat_utf8.h"
+#include "threads/Atomics.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/LockFreeRing.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StdString.h"
@@ -31,57 +34,132 @@
 #include "android/activity/XBMCApp.h"
 #endif
 
+#include <algorithm>
+#include <vector>
+
 #define critSec XBMC_GLOBAL_USE(CLog::CLogGlobals).critSec
 #define m_file XBMC_GLOBAL_USE(CLog::CLogGlobals).m_file
 #define m_repeatCount XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatCount
 #define m_repeatLogLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLogLevel
 #define m_repeatLine XBMC_GLOBAL_USE(CLog::CLogGlobals).m_repeatLine
 #define m_logLevel XBMC_GLOBAL_USE(CLog::CLogGlobals).m_logLevel
+#define m_writer XBMC_GLOBAL_USE(CLog::CLogGlobals).m_writer
+
+#define LOG_SHARDS         8
+#define LOG_SHARD_SIZE     1024
+#define LOG_WRITE_INTERVAL 100 /* ms */
 
 static char levelNames[][8] =
 {"DEBUG", "INFO", "NOTICE", "WARNING", "ERROR", "SEVERE", "FATAL", "NONE"};
 
-CLog::CLog()
-{}
+struct CLogLine
+{
+  long       sequence;
+  int        level;
+  SYSTEMTIME time;
+  uint64_t   threadId;
+  CStdString text;
+};
 
-CLog::~CLog()
-{}
+static bool SequenceLess(const CLogLine *a, const CLogLine *b)
+{
+  return a->sequence - b->sequence < 0;
+}
 
-void CLog::Close()
+/*
+  Queues lines in one of a few rings picked by thread id, so threads rarely
+  share one. A ring only allows a single producer, threads that do share one
+  serialize on a spin lock held just for the push. The rings are only drained
+  with critSec held, either by the writer thread or when writing synchronously.
+*/
+class CLogWriter : public CThread
 {
-  
-  CSingleLock waitLock(critSec);
-  if (m_file)
+public:
+  CLogWriter() : CThread("LogWriter"), m_sequence(0), m_active(false) {}
+
+  bool IsActive() const { return m_active; }
+
+  void Start()
   {
-    fclose(m_file);
-    m_file = NULL;
+    if (IsRunning())
+      return;
+    m_active = true;
+    Create();
   }
-  m_repeatLine.clear();
-}
 
-void CLog::Log(int loglevel, const char *format, ... )
-{
-  static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
-  CSingleLock waitLock(critSec);
-#if !(defined(_DEBUG) || defined(PROFILE))
-  if (m_logLevel > LOG_LEVEL_NORMAL ||
-     (m_logLevel > LOG_LEVEL_NONE && loglevel >= LOGNOTICE))
-#endif
+  void Stop()
   {
-    if (!m_file)
+    m_active = false;
+    m_bStop  = true;
+    m_wake.Set();
+    StopThread();
+
+    CSingleLock waitLock(critSec);
+    Flush();
+  }
+
+  /* returns false if the line could not be queued and must be written directly */
+  bool Queue(CLogLine *line)
+  {
+    if (!m_active)
+      return false;
+
+    line->sequence = AtomicIncrement(&m_sequence);
+
+    uint64_t hash = line->threadId ^ (line->threadId >> 7) ^ (line->threadId >> 13);
+    Shard &shard = m_shards[hash % LOG_SHARDS];
+    unsigned int count;
+    {
+      CAtomicSpinLock lock(shard.lock);
+      if (!shard.ring.Push(line))
+        return false;
+      count = shard.ring.GetCount();
+    }
+
+    if (!m_active)
+    {
+      /* the writer was stopped meanwhile, don't leave the line behind */
+      CSingleLock waitLock(critSec);
+      Flush();
+    }
+    else if (count >= LOG_SHARD_SIZE / 2 || line->level >= LOGERROR)
+      m_wake.Set();
+
+    return true;
+  }
+
+  /* write out all queued lines, critSec must be held */
+  void Flush()
+  {
+    std::vector<CLogLine*> lines;
+    CLogLine *line;
+    for (int i = 0; i < LOG_SHARDS; i++)
+      while (m_shards[i].ring.Pop(line))
+        lines.push_back(line);
+
+    if (lines.empty())
       return;
 
-    SYSTEMTIME time;
-    GetLocalTime(&time);
+    std::sort(lines.begin(), lines.end(), SequenceLess);
+    for (std::vector<CLogLine*>::iterator it = lines.begin(); it != lines.end(); ++it)
+    {
+      PrintLine((*it)->level, (*it)->time, (*it)->threadId, (*it)->text);
+      delete *it;
+    }
 
-    CStdString strPrefix, strData;
+    if (m_file)
+      fflush(m_file);
+  }
 
-    strData.reserve(16384);
-    va_list va;
-    va_start(va, format);
-    strData.FormatV(format,va);
-    va_end(va);
+  /* write a single line without flushing the file, critSec must be held */
+  static void PrintLine(int loglevel, const SYSTEMTIME& time, uint64_t threadId, CStdString& strData)
+  {
+    static const char* prefixFormat = "%02.2d:%02.2d:%02.2d T:%"PRIu64" %7s: ";
+
+    if (!m_file)
+      return;
 
+    CStdString strPrefix;
     if (m_repeatLogLevel == loglevel && m_repeatLine == strData)
     {
       m_repeatCount++;
@@ -90,15 +168,15 @@ void CLog::Log(int loglevel, const char *format, ... )
     else if (m_repeatCount)
     {
       CStdString strData2;
-      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[m_repeatLogLevel]);
+      strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, threadId, levelNames[m_repeatLogLevel]);
 
       strData2.Format("Previous line repeats %d times." LINE_ENDING, m_repeatCount);
       fputs(strPrefix.c_str(), m_file);
       fputs(strData2.c_str(), m_file);
-      OutputDebugString(strData2);
+      CLog::OutputDebugString(strData2);
       m_repeatCount = 0;
     }
-    
+
     m_repeatLine      = strData;
     m_repeatLogLevel  = loglevel;
 
@@ -113,14 +191,14 @@ void CLog::Log(int loglevel, const char *format, ... )
 
     if (!length)
       return;
-    
-    OutputDebugString(strData);
+
+    CLog::OutputDebugString(strData);
 
     /* fixup newline alignment, number of spaces should equal prefix length */
     strData.Replace("\n", LINE_ENDING"                                            ");
     strData += LINE_ENDING;
 
-    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, (uint64_t)CThread::GetCurrentThreadId(), levelNames[loglevel]);
+    strPrefix.Format(prefixFormat, time.wHour, time.wMinute, time.wSecond, threadId, levelNames[loglevel]);
 
 //print to adb
 #if defined(TARGET_ANDROID) && defined(_DEBUG)
@@ -129,8 +207,117 @@ void CLog::Log(int loglevel, const char *format, ... )
 
     fputs(strPrefix.c_str(), m_file);
     fputs(strData.c_str(), m_file);
+  }
+
+protected:
+  virtual void Process()
+  {
+    while (!m_bStop)
+    {
+      m_wake.WaitMSec(LOG_WRITE_INTERVAL);
+
+      CSingleLock waitLock(critSec);
+      Flush();
+    }
+  }
+
+private:
+  struct Shard
+  {
+    Shard() : lock(0), ring(LOG_SHARD_SIZE) {}
+    long                     lock;
+    CLockFreeRing<CLogLine*> ring;
+  };
+
+  Shard         m_shards[LOG_SHARDS];
+  volatile long m_sequence;
+  volatile bool m_active;
+  CEvent        m_wake;
+};
+
+CLog::CLog()
+{}
+
+CLog::~CLog()
+{}
+
+void CLog::Close()
+{
+  /* only called once everything else has stopped, nothing can be queueing */
+  CLogWriter *writer;
+  {
+    CSingleLock waitLock(critSec);
+    writer   = m_writer;
+    m_writer = NULL;
+  }
+  if (writer)
+  {
+    writer->Stop();
+    delete writer;
+  }
+
+  CSingleLock waitLock(critSec);
+  if (m_file)
+  {
+    fclose(m_file);
+    m_file = NULL;
+  }
+  m_repeatLine.clear();
+}
+
+void CLog::Log(int loglevel, const char *format, ... )
+{
+#if !(defined(_DEBUG) || defined(PROFILE))
+  /* check the level before doing any work */
+  if (m_logLevel <= LOG_LEVEL_NORMAL &&
+     (m_logLevel <= LOG_LEVEL_NONE || loglevel < LOGNOTICE))
+    return;
+#endif
+  if (!m_file)
+    return;
+
+  /* only lines handed to the writer thread need to live on the heap */
+  CLogWriter *writer = m_writer;
+  bool queue = writer && writer->IsActive();
+
+  CLogLine  local;
+  CLogLine *line = queue ? new CLogLine : &local;
+  line->level    = loglevel;
+  line->threadId = (uint64_t)CThread::GetCurrentThreadId();
+  GetLocalTime(&line->time);
+
+  va_list va;
+  va_start(va, format);
+  line->text.FormatV(format,va);
+  va_end(va);
+
+  if (queue && writer->Queue(line))
+    return;
+
+  CSingleLock waitLock(critSec);
+  /* anything still queued goes first to keep the order */
+  if (writer)
+    writer->Flush();
+  CLogWriter::PrintLine(line->level, line->time, line->threadId, line->text);
+  if (m_file)
     fflush(m_file);
+  if (line != &local)
+    delete line;
+}
+
+void CLog::SetAsync(bool async)
+{
+  if (async)
+  {
+    {
+      CSingleLock waitLock(critSec);
+      if (!m_writer)
+        m_writer = new CLogWriter();
+    }
+    m_writer->Start();
   }
+  else if (m_writer)
+    m_writer->Stop();
 }
 
 bool CLog::Init(const char* path)
@@ -34,6 +34,8 @@
 #define ATTRIB_LOG_FORMAT
 #endif
 
+class CLogWriter;
+
 class CLog
 {
 public:
@@ -41,12 +43,13 @@ public:
   class CLogGlobals
   {
   public:
-    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG) {}
+    CLogGlobals() : m_file(NULL), m_repeatCount(0), m_repeatLogLevel(-1), m_logLevel(LOG_LEVEL_DEBUG), m_writer(NULL) {}
     FILE*       m_file;
     int         m_repeatCount;
     int         m_repeatLogLevel;
     std::string m_repeatLine;
     int         m_logLevel;
+    CLogWriter* m_writer;
     CCriticalSection critSec;
   };
 
@@ -58,7 +61,13 @@ public:
   static bool Init(const char* path);
   static void SetLogLevel(int level);
   static int  GetLogLevel();
+  /*! \brief Queue lines and write them from a background thread instead of the calling one.
+   Lines are written in batches, so the last ones may be lost if the process crashes.
+   Disabling it writes out everything still queued.
+   */
+  static void SetAsync(bool async);
 private:
+  friend class CLogWriter;
   static void OutputDebugString(const std::string& line);
 };
 
@@ -166,6 +166,9 @@ bool CVideoDatabase::CreateTables()
     CLog::Log(LOGINFO, "create files table");
     m_pDS->exec("CREATE TABLE files ( idFile integer primary key, idPath integer, strFilename text, playCount integer, lastPlayed text, dateAdded text)");
     m_pDS->exec("CREATE UNIQUE INDEX ix_files ON files ( idPath, strFilename(255) )");
+    m_pDS->exec("CREATE INDEX ix_files_dateAdded ON files ( dateAdded(20) )");
+    m_pDS->exec("CREATE INDEX ix_files_lastPlayed ON files ( lastPlayed(20) )");
+    m_pDS->exec("CREATE INDEX ix_files_playCount ON files ( playCount )");
 
     CLog::Log(LOGINFO, "create tvshow table");
     columns = "CREATE TABLE tvshow ( idShow integer primary key";
@@ -453,8 +456,10 @@ int CVideoDatabase::GetPathId(const CStdString& strPath)
 
     URIUtils::AddSlashAtEnd(strPath1);
 
-    strSQL=PrepareSQL("select idPath from path where strPath='%s'",strPath1.c_str());
-    m_pDS->query(strSQL.c_str());
+    strSQL = "select idPath from path where strPath=?";
+    ParamValues params;
+    params.push_back(strPath1.c_str());
+    m_pDS->query_params(strSQL, params);
     if (!m_pDS->eof())
       idPath = m_pDS->fv("path.idPath").get_asInt();
 
@@ -576,6 +581,33 @@ int CVideoDatabase::RunQuery(const CStdString &sql)
   return rows;
 }
 
+void CVideoDatabase::ApplySortAndLimit(const CStdString &strSQL, MediaType mediaType, const Filter &filter, const SortDescription &sortDescription, CStdString &strSQLExtra, SortDescription &sorting, int &total)
+{
+  sorting = sortDescription;
+  if (!filter.limit.empty())
+    return;
+
+  // unpaged listings are sorted in memory, where ties are compared the natural way
+  if (sortDescription.limitStart <= 0 && sortDescription.limitEnd <= 0)
+    return;
+
+  std::string orderBy;
+  if (sortDescription.sortBy != SortByNone)
+  {
+    // an existing ORDER BY can't be combined with our own
+    if (!filter.order.empty() || !SortUtils::GetDatabaseOrderBy(sortDescription, mediaType, orderBy))
+      return;
+  }
+
+  total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+  if (!orderBy.empty())
+    strSQLExtra += " ORDER BY " + orderBy;
+  strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
+
+  // the database already returns the requested items in the requested order
+  sorting = SortDescription();
+}
+
 bool CVideoDatabase::GetSubPaths(const CStdString &basepath, vector< pair<int,string> >& subpaths)
 {
   CStdString sql;
@@ -621,12 +653,18 @@ int CVideoDatabase::AddPath(const CStdString& strPath, const CStdString &strDate
 
     URIUtils::AddSlashAtEnd(strPath1);
 
+    ParamValues params;
+    params.push_back(strPath1.c_str());
+
     // only set dateadded if we got one
     if (!strDateAdded.empty())
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,'%s','','', '%s')", strPath1.c_str(), strDateAdded.c_str());
+    {
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper, dateAdded) values (NULL,?,'','',?)";
+      params.push_back(strDateAdded.c_str());
+    }
     else
-      strSQL=PrepareSQL("insert into path (idPath, strPath, strContent, strScraper) values (NULL,'%s','','')", strPath1.c_str());
-    m_pDS->exec(strSQL.c_str());
+      strSQL = "insert into path (idPath, strPath, strContent, strScraper) values (NULL,?,'','')";
+    m_pDS->exec_params(strSQL, params);
     idPath = (int)m_pDS->lastinsertid();
     return idPath;
   }
@@ -676,9 +714,12 @@ int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
     if (idPath < 0)
       return -1;
 
-    CStdString strSQL=PrepareSQL("select idFile from files where strFileName='%s' and idPath=%i", strFileName.c_str(),idPath);
+    strSQL = "select idFile from files where strFileName=? and idPath=?";
+    ParamValues params;
+    params.push_back(strFileName.c_str());
+    params.push_back(idPath);
 
-    m_pDS->query(strSQL.c_str());
+    m_pDS->query_params(strSQL, params);
     if (m_pDS->num_rows() > 0)
     {
       idFile = m_pDS->fv("idFile").get_asInt() ;
@@ -687,8 +728,11 @@ int CVideoDatabase::AddFile(const CStdString& strFileNameAndPath)
     }
     m_pDS->close();
 
-    strSQL=PrepareSQL("insert into files (idFile, idPath, strFileName) values(NULL, %i, '%s')", idPath, strFileName.c_str());
-    m_pDS->exec(strSQL.c_str());
+    strSQL = "insert into files (idFile, idPath, strFileName) values(NULL, ?, ?)";
+    params.clear();
+    params.push_back(idPath);
+    params.push_back(strFileName.c_str());
+    m_pDS->exec_params(strSQL, params);
     idFile = (int)m_pDS->lastinsertid();
     return idFile;
   }
@@ -4011,6 +4055,12 @@ bool CVideoDatabase::UpdateOldVersion(int iVersion)
     }
     m_pDS->exec("DROP TABLE IF EXISTS setlinkmovie");
   }
+  if (iVersion < 69)
+  { // indices for the sort methods handled by the database
+    m_pDS->exec("CREATE INDEX ix_files_dateAdded ON files ( dateAdded(20) )");
+    m_pDS->exec("CREATE INDEX ix_files_lastPlayed ON files ( lastPlayed(20) )");
+    m_pDS->exec("CREATE INDEX ix_files_playCount ON files ( playCount )");
+  }
   // always recreate the view after any table change
   CreateViews();
   return true;
@@ -5530,14 +5580,11 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
     if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sortDescription.sortBy == SortByNone &&
-       (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
-    }
+    // Apply the sorting and limiting directly in the database if possible. Sorting
+    // movies merged with sets has to be done in memory
+    SortDescription sorting = sortDescription;
+    if (setItems.Size() == 0 || sortDescription.sortBy == SortByNone)
+      ApplySortAndLimit(strSQL, MediaTypeMovie, extFilter, sortDescription, strSQLExtra, sorting, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -5563,7 +5610,7 @@ bool CVideoDatabase::GetMoviesByWhere(const CStdString& strBaseDir, const Filter
       results.push_back(result);
     }
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+    if (!SortUtils::SortFromDataset(sorting, MediaTypeMovie, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -5650,14 +5697,9 @@ bool CVideoDatabase::GetTvShowsByWhere(const CStdString& strBaseDir, const Filte
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sortDescription.sortBy == SortByNone &&
-       (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
-    }
+    // Apply the sorting and limiting directly in the database if possible
+    SortDescription sorting;
+    ApplySortAndLimit(strSQL, MediaTypeTvShow, extFilter, sortDescription, strSQLExtra, sorting, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -5672,7 +5714,7 @@ bool CVideoDatabase::GetTvShowsByWhere(const CStdString& strBaseDir, const Filte
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeTvShow, m_pDS, results))
+    if (!SortUtils::SortFromDataset(sorting, MediaTypeTvShow, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -5960,14 +6002,9 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sortDescription.sortBy == SortByNone &&
-       (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
-    }
+    // Apply the sorting and limiting directly in the database if possible
+    SortDescription sorting;
+    ApplySortAndLimit(strSQL, MediaTypeEpisode, extFilter, sortDescription, strSQLExtra, sorting, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -5982,7 +6019,7 @@ bool CVideoDatabase::GetEpisodesByWhere(const CStdString& strBaseDir, const Filt
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeEpisode, m_pDS, results))
+    if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
       return false;
     
     // get data from returned rows
@@ -6809,14 +6846,9 @@ bool CVideoDatabase::GetMusicVideosByWhere(const CStdString &baseDir, const Filt
     if (!BuildSQL(baseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sortDescription.sortBy == SortByNone &&
-       (sortDescription.limitStart > 0 || sortDescription.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sortDescription.limitEnd, sortDescription.limitStart);
-    }
+    // Apply the sorting and limiting directly in the database if possible
+    SortDescription sorting;
+    ApplySortAndLimit(strSQL, MediaTypeMusicVideo, extFilter, sortDescription, strSQLExtra, sorting, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -6831,7 +6863,7 @@ bool CVideoDatabase::GetMusicVideosByWhere(const CStdString &baseDir, const Filt
     
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMusicVideo, m_pDS, results))
+    if (!SortUtils::SortFromDataset(sorting, MediaTypeMusicVideo, m_pDS, results))
       return false;
     
     // get data from returned rows
@@ -778,6 +778,20 @@ private:
    */
   int RunQuery(const CStdString &sql);
 
+  /*! \brief Push the sorting and limiting of a listing down into the database
+   Only paged listings are pushed down. The ORDER BY and LIMIT clauses are only added
+   if the database can sort like SortUtils would, otherwise only the limiting for
+   unsorted listings is applied.
+   \param strSQL the select query of the view with a %s placeholder for the fields
+   \param mediaType the media type of the view
+   \param filter the filter the query was built from
+   \param sortDescription the requested sorting and limits
+   \param strSQLExtra the query part following the view name, the clauses are appended to it
+   \param sorting [out] the sorting and limiting still to be done in memory
+   \param total [out] the total number of items if limits were applied, untouched otherwise
+   */
+  void ApplySortAndLimit(const CStdString &strSQL, MediaType mediaType, const Filter &filter, const SortDescription &sortDescription, CStdString &strSQLExtra, SortDescription &sorting, int &total);
+
   /*! \brief Update routine for base path of videos
    Only required for videodb version < 59
    \param table the table to update
@@ -803,7 +817,7 @@ private:
    */
   bool LookupByFolders(const CStdString &path, bool shows = false);
 
-  virtual int GetMinVersion() const { return 68; };
+  virtual int GetMinVersion() const { return 69; };
   virtual int GetExportVersion() const { return 1; };
   const char *GetBaseDBName() const { return "MyVideos"; };
 
@@ -0,0 +1,145 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "VideoDirectoryPrefetcher.h"
+#include "utils/JobManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+
+using namespace std;
+
+namespace VIDEO
+{
+  CVideoDirectoryPrefetcher::CVideoDirectoryPrefetcher(unsigned int jobsAtOnce, unsigned int maxPending)
+    : m_jobsAtOnce(jobsAtOnce), m_maxPending(maxPending)
+  {
+  }
+
+  CVideoDirectoryPrefetcher::~CVideoDirectoryPrefetcher()
+  {
+    Cancel();
+  }
+
+  void CVideoDirectoryPrefetcher::Prefetch(const vector<CVideoPrefetchJob *> &jobs)
+  {
+    CSingleLock lock(m_section);
+    deque<CVideoPrefetchJob *>::iterator pos = m_queued.begin();
+    for (vector<CVideoPrefetchJob *>::const_iterator job = jobs.begin(); job != jobs.end(); ++job)
+    {
+      if (IsPending((*job)->m_path))
+      {
+        delete *job;
+        continue;
+      }
+      pos = m_queued.insert(pos, *job) + 1;
+    }
+    StartJobs();
+  }
+
+  CVideoPrefetchJob *CVideoDirectoryPrefetcher::Get(const CStdString &path)
+  {
+    CSingleLock lock(m_section);
+    for (deque<CVideoPrefetchJob *>::iterator i = m_queued.begin(); i != m_queued.end(); ++i)
+    {
+      if ((*i)->m_path == path)
+      { // not started yet, the caller is quicker doing it directly
+        delete *i;
+        m_queued.erase(i);
+        StartJobs();
+        return NULL;
+      }
+    }
+    map<CStdString, RunningJob>::iterator running = m_running.find(path);
+    if (running != m_running.end())
+    { // set once the job completes or is cancelled
+      boost::shared_ptr<CEvent> done = running->second.done;
+      lock.Leave();
+      done->Wait();
+      lock.Enter();
+    }
+    map<CStdString, CVideoPrefetchJob *>::iterator i = m_done.find(path);
+    if (i == m_done.end())
+      return NULL;
+
+    CVideoPrefetchJob *job = i->second;
+    m_done.erase(i);
+    StartJobs();
+    return job;
+  }
+
+  void CVideoDirectoryPrefetcher::Cancel()
+  {
+    CSingleLock lock(m_section);
+    for (map<CStdString, RunningJob>::iterator i = m_running.begin(); i != m_running.end(); ++i)
+    {
+      CJobManager::GetInstance().CancelJob(i->second.id);
+      i->second.done->Set();
+    }
+    m_running.clear();
+    for (deque<CVideoPrefetchJob *>::iterator i = m_queued.begin(); i != m_queued.end(); ++i)
+      delete *i;
+    m_queued.clear();
+    for (map<CStdString, CVideoPrefetchJob *>::iterator i = m_done.begin(); i != m_done.end(); ++i)
+      delete i->second;
+    m_done.clear();
+  }
+
+  void CVideoDirectoryPrefetcher::OnJobComplete(unsigned int jobID, bool success, CJob *job)
+  {
+    CSingleLock lock(m_section);
+    CVideoPrefetchJob *prefetchJob = (CVideoPrefetchJob *)job;
+    map<CStdString, RunningJob>::iterator i = m_running.find(prefetchJob->m_path);
+    if (i == m_running.end() || i->second.id != jobID)
+      return; // cancelled
+
+    boost::shared_ptr<CEvent> done = i->second.done;
+    m_running.erase(i);
+    if (success && prefetchJob->m_wanted)
+      m_done[prefetchJob->m_path] = prefetchJob->TakeResult();
+    StartJobs();
+    done->Set();
+  }
+
+  bool CVideoDirectoryPrefetcher::IsPending(const CStdString &path) const
+  {
+    if (m_running.find(path) != m_running.end() || m_done.find(path) != m_done.end())
+      return true;
+    for (deque<CVideoPrefetchJob *>::const_iterator i = m_queued.begin(); i != m_queued.end(); ++i)
+    {
+      if ((*i)->m_path == path)
+        return true;
+    }
+    return false;
+  }
+
+  void CVideoDirectoryPrefetcher::StartJobs()
+  {
+    while (!m_queued.empty() && m_running.size() < m_jobsAtOnce &&
+           m_running.size() + m_done.size() < m_maxPending)
+    {
+      CVideoPrefetchJob *job = m_queued.front();
+      m_queued.pop_front();
+      RunningJob &running = m_running[job->m_path];
+      running.done.reset(new CEvent(true));
+      running.id = CJobManager::GetInstance().AddJob(job, this);
+    }
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "utils/Job.h"
+#include "utils/StdString.h"
+#include "threads/CriticalSection.h"
+
+class CEvent;
+
+namespace VIDEO
+{
+  /*! \brief A job run ahead of the scanner by CVideoDirectoryPrefetcher, identified by its path.
+   */
+  class CVideoPrefetchJob : public CJob
+  {
+  public:
+    CVideoPrefetchJob(const CStdString &path) : m_path(path), m_wanted(false) {}
+    virtual ~CVideoPrefetchJob() {}
+
+    /*! \brief Move the results of a completed job into a new job.
+     The job manager deletes the completed job, the returned one is handed to the scanner.
+     */
+    virtual CVideoPrefetchJob *TakeResult()=0;
+
+    CStdString m_path;
+    bool m_wanted;               ///< whether the scanner will ask for the result, unwanted results are dropped
+  };
+
+  /*! \brief Runs folder listings for the scanner ahead of time, a few at once.
+   Only the listing of folders is prefetched, the lookups and database updates stay on the scanner
+   thread. Each batch of folders is put in front of the ones requested earlier, which follows the
+   depth first order of the scanner. A folder the scanner asks for that hasn't been started yet is
+   dropped from the queue and listed by the scanner itself, so the scanner never waits behind
+   listings it doesn't need yet.
+   */
+  class CVideoDirectoryPrefetcher : public IJobCallback
+  {
+  public:
+    /*! \param jobsAtOnce number of folders that are listed at once
+     \param maxPending number of listings that may be running or waiting for the scanner
+     */
+    CVideoDirectoryPrefetcher(unsigned int jobsAtOnce = 4, unsigned int maxPending = 16);
+    virtual ~CVideoDirectoryPrefetcher();
+
+    /*! \brief Queue a batch of jobs, the prefetcher takes ownership of them.
+     Jobs for folders that are already pending are deleted.
+     */
+    void Prefetch(const std::vector<CVideoPrefetchJob *> &jobs);
+
+    /*! \brief Retrieve the result for a folder, waiting for it if its job is running
+     \param path the folder
+     \return the completed job, which the caller deletes, or NULL if the caller should handle the folder itself
+     */
+    CVideoPrefetchJob *Get(const CStdString &path);
+
+    /*! \brief Drop all queued and finished jobs, running jobs are abandoned
+     */
+    void Cancel();
+
+    virtual void OnJobComplete(unsigned int jobID, bool success, CJob *job);
+
+  private:
+    struct RunningJob
+    {
+      unsigned int id;
+      boost::shared_ptr<CEvent> done; ///< shared with a waiting Get(), which may outlive the entry
+    };
+
+    bool IsPending(const CStdString &path) const;
+    void StartJobs();
+
+    unsigned int m_jobsAtOnce;
+    unsigned int m_maxPending;
+    CCriticalSection m_section;
+    std::deque<CVideoPrefetchJob *> m_queued;
+    std::map<CStdString, RunningJob> m_running;
+    std::map<CStdString, CVideoPrefetchJob *> m_done;
+  };
+}
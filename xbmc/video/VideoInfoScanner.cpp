@@ -48,6 +48,10 @@
 #include "ThumbLoader.h"
 #include "TextureCache.h"
 #include "URL.h"
+#include "utils/JobManager.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+#include "VideoDirectoryPrefetcher.h"
 
 using namespace std;
 using namespace XFILE;
@@ -55,6 +59,135 @@ using namespace ADDON;
 
 namespace VIDEO
 {
+  /*! \brief Database lookups for the directory jobs of a scan.
+   The jobs take turns on one connection instead of each opening their own, the lookups are quick
+   compared to listing a folder on a slow source. Jobs hold a reference, so the connection stays
+   open until the last running job of a cancelled scan is done with it.
+   */
+  class CVideoDirectoryLookup
+  {
+  public:
+    ~CVideoDirectoryLookup()
+    {
+      m_database.Close();
+    }
+
+    /*! \brief Look up the scraper settings and the stored hash of a folder
+     \return false if the database couldn't be opened
+     */
+    bool Lookup(const CStdString &path, CONTENT_TYPE &content, SScanSettings &settings, bool &foundDirectly, CStdString &dbHash)
+    {
+      CSingleLock lock(m_section);
+      if (!m_database.IsOpen() && !m_database.Open())
+        return false;
+
+      ScraperPtr info = m_database.GetScraperForPath(path, settings, foundDirectly);
+      content = info ? info->Content() : CONTENT_NONE;
+      if (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS)
+        m_database.GetPathHash(path, dbHash);
+      return true;
+    }
+
+  private:
+    CCriticalSection m_section;
+    CVideoDatabase m_database;
+  };
+
+  /*! \brief Job that lists a folder for the scanner.
+   Folders DoScan() won't list are left alone. For movies and music videos the "fast" hash is
+   computed first, and the folder is only listed if it doesn't match the hash stored in the
+   database.
+   */
+  class CVideoDirectoryJob : public CVideoPrefetchJob
+  {
+  public:
+    CVideoDirectoryJob(const CStdString &path, bool scanAll, const boost::shared_ptr<CVideoDirectoryLookup> &lookup)
+      : CVideoPrefetchJob(path), m_scanAll(scanAll), m_lookup(lookup), m_items(NULL)
+    {
+    }
+
+    virtual ~CVideoDirectoryJob()
+    {
+      delete m_items;
+    }
+
+    virtual const char *GetType() const { return "videodirectory"; }
+
+    virtual bool operator==(const CJob *job) const
+    {
+      if (strcmp(job->GetType(), GetType()) == 0)
+        return m_path == ((const CVideoDirectoryJob *)job)->m_path;
+      return false;
+    }
+
+    virtual bool DoWork()
+    {
+      // mirror the checks in DoScan() so we only list what it will list
+      CONTENT_TYPE content = CONTENT_NONE;
+      SScanSettings settings;
+      bool foundDirectly = false;
+      CStdString dbHash;
+      if (!m_lookup->Lookup(m_path, content, settings, foundDirectly, dbHash))
+        return false;
+      if (content == CONTENT_NONE || (!m_scanAll && settings.noupdate))
+        return true;
+
+      CStdStringArray regexps = content == CONTENT_TVSHOWS ? g_advancedSettings.m_tvshowExcludeFromScanRegExps
+                                                           : g_advancedSettings.m_moviesExcludeFromScanRegExps;
+      if (CUtil::ExcludeFileOrFolder(m_path, regexps))
+        return true;
+
+      if (content == CONTENT_MOVIES || content == CONTENT_MUSICVIDEOS)
+      {
+        m_wanted = true;
+        m_fastHash = CVideoInfoScanner::GetFastHash(m_path);
+        if (!m_fastHash.IsEmpty() && m_fastHash == dbHash)
+          return true; // unchanged, DoScan() won't need the listing
+      }
+      else if (content == CONTENT_TVSHOWS && foundDirectly && !settings.parent_name_root)
+        m_wanted = true;
+      else
+        return true;
+
+      m_items = new CFileItemList;
+      CDirectory::GetDirectory(m_path, *m_items, g_settings.m_videoExtensions);
+      return true;
+    }
+
+    virtual CVideoPrefetchJob *TakeResult()
+    {
+      CVideoDirectoryJob *result = new CVideoDirectoryJob(m_path, m_scanAll, boost::shared_ptr<CVideoDirectoryLookup>());
+      result->m_wanted = m_wanted;
+      result->m_fastHash = m_fastHash;
+      result->m_items = m_items;
+      m_items = NULL;
+      return result;
+    }
+
+    bool m_scanAll;
+    boost::shared_ptr<CVideoDirectoryLookup> m_lookup;
+    CStdString m_fastHash;
+    CFileItemList *m_items;      ///< the listing, NULL if the folder wasn't listed
+  };
+
+  /*! \brief Take the prefetched listing of a folder, waiting for it if it's being listed
+   \param fastHash [out] the fast hash of the folder, if computed
+   \param items [out] the listing of the folder
+   \param listed [out] whether the folder was listed
+   \return true if the folder was prefetched, false if the caller should handle it
+   */
+  static bool GetPrefetched(CVideoDirectoryPrefetcher *prefetcher, const CStdString &path, CStdString &fastHash, CFileItemList &items, bool &listed)
+  {
+    CVideoDirectoryJob *job = (CVideoDirectoryJob *)prefetcher->Get(path);
+    if (!job)
+      return false;
+    fastHash = job->m_fastHash;
+    listed = job->m_items != NULL;
+    if (listed)
+      items.Copy(*job->m_items);
+    delete job;
+    return true;
+  }
 
   CVideoInfoScanner::CVideoInfoScanner() : CThread("CVideoInfoScanner")
   {
@@ -65,10 +198,15 @@ namespace VIDEO
     m_itemCount = 0;
     m_bClean = false;
     m_scanAll = false;
+    m_prefetcher = new CVideoDirectoryPrefetcher;
+    m_dirsScanned = 0;
+    m_dirsSkipped = 0;
+    m_itemsScanned = 0;
   }
 
   CVideoInfoScanner::~CVideoInfoScanner()
   {
+    delete m_prefetcher;
   }
 
   void CVideoInfoScanner::Process()
@@ -89,6 +227,9 @@ namespace VIDEO
       // Reset progress vars
       m_currentItem = 0;
       m_itemCount = -1;
+      m_dirsScanned = 0;
+      m_dirsSkipped = 0;
+      m_itemsScanned = 0;
 
       SetPriority(GetMinPriority());
 
@@ -97,6 +238,9 @@ namespace VIDEO
       // result in unexpected behaviour.
       m_bCanInterrupt = false;
 
+      // start listing the sources while we work through them one by one
+      PrefetchDirectories(vector<CStdString>(m_pathsToScan.begin(), m_pathsToScan.end()));
+
       bool bCancelled = false;
       while (!bCancelled && m_pathsToScan.size())
       {
@@ -110,6 +254,8 @@ namespace VIDEO
         if (!DoScan(directory))
           bCancelled = true;
       }
+      m_prefetcher->Cancel();
+      m_prefetchLookup.reset();
 
       if (!bCancelled)
       {
@@ -127,6 +273,8 @@ namespace VIDEO
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+      CLog::Log(LOGNOTICE, "VideoInfoScanner: Scanned %u folders (%u unchanged) with %u items, %.1f items/minute",
+                m_dirsScanned, m_dirsSkipped, m_itemsScanned, m_itemsScanned * 60000.0 / std::max(tick, 1u));
       ANNOUNCEMENT::CAnnouncementManager::Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanFinished");
       
       m_bRunning = false;
@@ -174,6 +322,7 @@ namespace VIDEO
     if (m_bCanInterrupt)
       m_database.Interupt();
 
+    m_prefetcher->Cancel();
     StopThread();
   }
 
@@ -234,7 +383,10 @@ namespace VIDEO
       if (m_pObserver)
         m_pObserver->OnStateChanged(content == CONTENT_MOVIES ? FETCHING_MOVIE_INFO : FETCHING_MUSICVIDEO_INFO);
 
-      CStdString fastHash = GetFastHash(strDirectory);
+      CStdString fastHash;
+      bool listed = false;
+      if (!GetPrefetched(m_prefetcher, strDirectory, fastHash, items, listed))
+        fastHash = GetFastHash(strDirectory);
       if (m_database.GetPathHash(strDirectory, dbHash) && !fastHash.IsEmpty() && fastHash == dbHash)
       { // fast hashes match - no need to process anything
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (fasthash)", strDirectory.c_str());
@@ -243,7 +395,8 @@ namespace VIDEO
       }
       if (!bSkip)
       { // need to fetch the folder
-        CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
+        if (!listed)
+          CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
         items.Stack();
         // compute hash
         GetPathHash(items, hash);
@@ -279,7 +432,10 @@ namespace VIDEO
 
       if (foundDirectly && !settings.parent_name_root)
       {
-        CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
+        CStdString fastHash;
+        bool listed = false;
+        if (!GetPrefetched(m_prefetcher, strDirectory, fastHash, items, listed) || !listed)
+          CDirectory::GetDirectory(strDirectory, items, g_settings.m_videoExtensions);
         items.SetPath(strDirectory);
         GetPathHash(items, hash);
         bSkip = true;
@@ -301,6 +457,25 @@ namespace VIDEO
       }
     }
 
+    m_dirsScanned++;
+    if (bSkip)
+      m_dirsSkipped++;
+    else
+      m_itemsScanned += items.Size();
+
+    // list the subfolders we'll recurse into while this folder is being looked up
+    if (settings.recurse > 0 && content != CONTENT_TVSHOWS)
+    {
+      vector<CStdString> folders;
+      for (int i = 0; i < items.Size(); ++i)
+      {
+        CFileItemPtr pItem = items[i];
+        if (pItem->m_bIsFolder && !pItem->IsParentFolder() && !pItem->IsPlayList())
+          folders.push_back(pItem->GetPath());
+      }
+      PrefetchDirectories(folders);
+    }
+
     if (!bSkip)
     {
       if (RetrieveVideoInfo(items, settings.parent_name_root, content))
@@ -346,6 +521,17 @@ namespace VIDEO
     return !m_bStop;
   }
 
+  void CVideoInfoScanner::PrefetchDirectories(const vector<CStdString>& directories)
+  {
+    // the jobs look the folders up themselves, this runs on the scanner thread
+    if (!m_prefetchLookup)
+      m_prefetchLookup.reset(new CVideoDirectoryLookup);
+    vector<CVideoPrefetchJob *> jobs;
+    for (vector<CStdString>::const_iterator it = directories.begin(); it != directories.end(); ++it)
+      jobs.push_back(new CVideoDirectoryJob(*it, m_scanAll, m_prefetchLookup));
+    m_prefetcher->Prefetch(jobs);
+  }
+
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
   {
     if (pDlgProgress)
@@ -1552,7 +1738,7 @@ namespace VIDEO
     return items.GetFolderCount() == 0;
   }
 
-  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory) const
+  CStdString CVideoInfoScanner::GetFastHash(const CStdString &directory)
   {
     struct __stat64 buffer;
     if (XFILE::CFile::Stat(directory, &buffer) == 0)
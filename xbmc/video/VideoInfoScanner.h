@@ -29,6 +29,9 @@ class CRegExp;
 
 namespace VIDEO
 {
+  class CVideoDirectoryPrefetcher;
+  class CVideoDirectoryLookup;
+
   typedef struct SScanSettings
   {
     SScanSettings() { parent_name = parent_name_root = noupdate = exclude = false; recurse = 1;}
@@ -138,6 +141,15 @@ namespace VIDEO
     virtual void Process();
     bool DoScan(const CStdString& strDirectory);
 
+    /*! \brief Queue the listing of folders that are about to be scanned on background jobs
+     The jobs look up the scraper settings and hashes on a database connection they share and only
+     list what DoScan() would list, so that slow (network) sources can be enumerated while the scanner
+     is busy looking up the items of the previous folder. Scraping and database updates are not
+     prefetched, they stay on the scanner thread.
+     \param directories folders to prefetch, in the order they will be scanned
+     */
+    void PrefetchDirectories(const std::vector<CStdString>& directories);
+
     INFO_RET RetrieveInfoForTvShow(CFileItemPtr pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItemPtr pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMusicVideo(CFileItemPtr pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -202,7 +214,7 @@ namespace VIDEO
      \param directory folder to hash
      \return the hash of the folder of the form "fast<datetime>"
      */
-    CStdString GetFastHash(const CStdString &directory) const;
+    static CStdString GetFastHash(const CStdString &directory);
 
     /*! \brief Decide whether a folder listing could use the "fast" hash
      Fast hashing can be done whenever the folder contains no scannable subfolders, as the
@@ -252,6 +264,13 @@ namespace VIDEO
     std::set<CStdString> m_pathsToCount;
     std::set<int> m_pathsToClean;
     CNfoFile m_nfoReader;
+    CVideoDirectoryPrefetcher *m_prefetcher;
+    boost::shared_ptr<CVideoDirectoryLookup> m_prefetchLookup;
+    unsigned int m_dirsScanned;
+    unsigned int m_dirsSkipped;
+    unsigned int m_itemsScanned;
+
+    friend class CVideoDirectoryJob;
   };
 }
 
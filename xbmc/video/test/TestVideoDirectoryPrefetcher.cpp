@@ -0,0 +1,243 @@
+/*
+ *      Copyright (C) 2005-2012 Team XBMC
+ *      http://www.xbmc.org
+ *
+ *  This Program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2, or (at your option)
+ *  any later version.
+ *
+ *  This Program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with XBMC; see the file COPYING.  If not, write to
+ *  the Free Software Foundation, 675 Mass Ave, Cambridge, MA 02139, USA.
+ *  http://www.gnu.org/copyleft/gpl.html
+ *
+ */
+
+#include "video/VideoDirectoryPrefetcher.h"
+#include "threads/Atomics.h"
+#include "threads/Event.h"
+#include "threads/SingleLock.h"
+
+#include <unittest++/UnitTest++.h>
+
+#include <vector>
+
+using namespace VIDEO;
+
+namespace
+{
+  // what the jobs of a test did, and the gate a job can be held at
+  struct CPrefetchState
+  {
+    CPrefetchState() : release(true), live(0) {}
+
+    std::vector<CStdString> Started()
+    {
+      CSingleLock lock(section);
+      return started;
+    }
+
+    // wait for the jobs to get somewhere, rather than for a fixed time
+    bool WaitFor(size_t count)
+    {
+      for (int i = 0; i < 500 && Started().size() < count; i++)
+        changed.WaitMSec(10);
+      return Started().size() >= count;
+    }
+
+    bool WaitForNoJobs()
+    {
+      for (int i = 0; i < 500 && live > 0; i++)
+        changed.WaitMSec(10);
+      return live == 0;
+    }
+
+    CCriticalSection section;
+    std::vector<CStdString> started;
+    CStdString holdAt;           ///< the job for this path waits for release
+    CEvent release;
+    CEvent changed;
+    volatile long live;          ///< jobs not deleted yet
+  };
+
+  class CTestPrefetchJob : public CVideoPrefetchJob
+  {
+  public:
+    CTestPrefetchJob(const CStdString &path, CPrefetchState &state, bool wanted = true)
+      : CVideoPrefetchJob(path), m_state(state), m_wants(wanted)
+    {
+      AtomicIncrement(&m_state.live);
+    }
+
+    virtual ~CTestPrefetchJob()
+    {
+      AtomicDecrement(&m_state.live);
+      m_state.changed.Set();
+    }
+
+    virtual bool DoWork()
+    {
+      {
+        CSingleLock lock(m_state.section);
+        m_state.started.push_back(m_path);
+      }
+      m_state.changed.Set();
+      if (m_path == m_state.holdAt)
+        m_state.release.Wait();
+      m_wanted = m_wants;
+      return true;
+    }
+
+    virtual CVideoPrefetchJob *TakeResult()
+    {
+      CTestPrefetchJob *result = new CTestPrefetchJob(m_path, m_state, m_wants);
+      result->m_wanted = m_wanted;
+      return result;
+    }
+
+  private:
+    CPrefetchState &m_state;
+    bool m_wants;
+  };
+
+  std::vector<CVideoPrefetchJob *> Jobs(CPrefetchState &state, const char *paths)
+  {
+    std::vector<CVideoPrefetchJob *> jobs;
+    for (const char *path = paths; *path; path++)
+      jobs.push_back(new CTestPrefetchJob(CStdString(1, *path), state));
+    return jobs;
+  }
+
+  // takes the result for a path, false if there is none
+  bool Take(CVideoDirectoryPrefetcher &prefetcher, const char *path)
+  {
+    CVideoPrefetchJob *job = prefetcher.Get(path);
+    delete job;
+    return job != NULL;
+  }
+
+  CStdString Order(const std::vector<CStdString> &paths)
+  {
+    CStdString order;
+    for (std::vector<CStdString>::const_iterator i = paths.begin(); i != paths.end(); ++i)
+      order += *i;
+    return order;
+  }
+}
+
+TEST(PrefetchRunsLaterBatchesFirst)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(1, 16);
+    state.holdAt = "a";
+    prefetcher.Prefetch(Jobs(state, "abc"));
+    CHECK(state.WaitFor(1));
+
+    // the subfolders of a come before its siblings, in their own order
+    prefetcher.Prefetch(Jobs(state, "de"));
+    state.release.Set();
+    CHECK(Take(prefetcher, "a"));
+    CHECK(Take(prefetcher, "d"));
+    CHECK(Take(prefetcher, "e"));
+    CHECK(Take(prefetcher, "b"));
+    CHECK(Take(prefetcher, "c"));
+    CHECK_EQUAL("adebc", Order(state.Started()));
+  }
+  CHECK(state.WaitForNoJobs());
+}
+
+TEST(PrefetchIgnoresPendingPaths)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(1, 16);
+    state.holdAt = "a";
+    prefetcher.Prefetch(Jobs(state, "ab"));
+    CHECK(state.WaitFor(1));
+    prefetcher.Prefetch(Jobs(state, "ba"));
+    state.release.Set();
+    CHECK(Take(prefetcher, "a"));
+    CHECK(Take(prefetcher, "b"));
+    CHECK(!Take(prefetcher, "a"));
+    CHECK_EQUAL("ab", Order(state.Started()));
+  }
+  CHECK(state.WaitForNoJobs());
+}
+
+TEST(PrefetchGetDropsQueuedPath)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(1, 16);
+    state.holdAt = "a";
+    prefetcher.Prefetch(Jobs(state, "abc"));
+    CHECK(state.WaitFor(1));
+
+    // b hasn't started, so the caller lists it and it is never run
+    CHECK(!Take(prefetcher, "b"));
+    state.release.Set();
+    CHECK(Take(prefetcher, "a"));
+    CHECK(Take(prefetcher, "c"));
+    CHECK_EQUAL("ac", Order(state.Started()));
+  }
+  CHECK(state.WaitForNoJobs());
+}
+
+TEST(PrefetchDropsUnwantedResults)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(1, 16);
+    std::vector<CVideoPrefetchJob *> jobs;
+    jobs.push_back(new CTestPrefetchJob("a", state, false));
+    prefetcher.Prefetch(jobs);
+    CHECK(!Take(prefetcher, "a"));
+    CHECK_EQUAL("a", Order(state.Started()));
+  }
+  CHECK(state.WaitForNoJobs());
+}
+
+TEST(PrefetchLimitsPendingResults)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(4, 2);
+    prefetcher.Prefetch(Jobs(state, "abc"));
+    CHECK(state.WaitFor(2));
+
+    // c waits until a result has been taken
+    state.changed.WaitMSec(50);
+    CHECK_EQUAL("ab", Order(state.Started()));
+    CHECK(Take(prefetcher, "a"));
+    CHECK(Take(prefetcher, "c"));
+    CHECK(Take(prefetcher, "b"));
+  }
+  CHECK(state.WaitForNoJobs());
+}
+
+TEST(PrefetchCancelDropsEverything)
+{
+  CPrefetchState state;
+  {
+    CVideoDirectoryPrefetcher prefetcher(1, 16);
+    state.holdAt = "a";
+    prefetcher.Prefetch(Jobs(state, "abc"));
+    CHECK(state.WaitFor(1));
+
+    // the running job is abandoned, Get() doesn't wait for it
+    prefetcher.Cancel();
+    CHECK(!Take(prefetcher, "a"));
+    CHECK(!Take(prefetcher, "b"));
+    state.release.Set();
+    CHECK(state.WaitForNoJobs());
+    CHECK(!Take(prefetcher, "a"));
+    CHECK_EQUAL("a", Order(state.Started()));
+  }
+}
@@ -32,7 +32,11 @@
 #include "guilib/GUITextLayout.h"
 #include "guilib/GUIWindowManager.h"
 #include "guilib/GUIControlProfiler.h"
+#include "guilib/Texture.h"
+#include "guilib/GUITexture.h"
 #include "GUIInfoManager.h"
+#include "TextureCache.h"
+#include "GUILargeTextureManager.h"
 #include "utils/Variant.h"
 
 #include <climits>
@@ -112,6 +116,20 @@ void CGUIWindowDebugInfo::Process(unsigned int currentTime, CDirtyRegionList &di
     info.Format("LOG: %sxbmc.log\nMEM: %"PRIu64"/%"PRIu64" KB - FPS: %2.1f fps\nCPU: %s (CPU-XBMC %4.2f%%%s)", g_settings.m_logFolder.c_str(),
                 stat.ullAvailPhys/1024, stat.ullTotalPhys/1024, g_infoManager.GetFPS(), strCores.c_str(), dCPU, profiling.c_str());
 #endif
+    unsigned int hits, misses, entries;
+    CTextureCache::Get().GetIndexStats(hits, misses, entries);
+    info.AppendFormat("\nTEX: %u cached lookups - %u hits, %u misses", entries, hits, misses);
+    unsigned int images, decodeTime;
+    float decodedShare;
+    CBaseTexture::GetDecodeStats(images, decodeTime, decodedShare);
+    info.AppendFormat("\nIMG: %u decoded - %u ms avg, %.0f%% of source pixels", images, images ? decodeTime / images : 0, decodedShare * 100);
+    unsigned int uploads, maxUploadTime, deferredFrames, pendingUploads;
+    uint64_t uploadBytes;
+    g_largeTextureManager.GetUploadStats(uploads, uploadBytes, maxUploadTime, deferredFrames, pendingUploads);
+    unsigned int drawCalls, quads;
+    CGUITexture::GetDrawStats(drawCalls, quads);
+    info.AppendFormat("\nGPU: %u texture draw calls, %u quads per frame", drawCalls, quads);
+    info.AppendFormat("\nUPL: %u uploaded - %"PRIu64" MB, %u ms max/frame, %u frames deferred, %u pending", uploads, uploadBytes / (1024 * 1024), maxUploadTime, deferredFrames, pendingUploads);
   }
 
   // render the skin debug info